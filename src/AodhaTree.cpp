@@ -3,11 +3,19 @@
 
 #include "AodhaTree.h"
 
+#include "BestFirstTree.h"
 #include "CompareUtils.h"
 #include "ErrorUtils.h"
+#include "HardwareCounters.h"
+#include "LevelWiseTree.h"
 #include "Logger.h"
+#include "NodeStats.h"
+#include "ParallelSplitSearch.h"
+#include "Profiler.h"
+#include "WorkCounters.h"
 #include "ExtrasTreeNode.h"
 
+#include <limits>
 #include <string>
 
 
@@ -18,30 +26,64 @@ AodhaTree::AodhaTree():
 
 std::shared_ptr<DecisionTreeNode> AodhaTree::createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) {
   ErrorUtils::enforce(ds.getTotClasses() == 2, "Error! Number of classes must be 2.");
+  std::shared_ptr<ConfigAodha> config = std::static_pointer_cast<ConfigAodha>(c);
+  if (config->levelWise) {
+    return LevelWiseTree().createTree(ds, c);
+  }
 
   calcNormVars(ds);
-
-  std::shared_ptr<ConfigAodha> config = std::static_pointer_cast<ConfigAodha>(c);
+  nominalAttribs_.clear();
+  allAttribs_.clear();
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    if (ds.getAttributeType(i) == AttributeType::STRING) {
+      nominalAttribs_.push_back(i);
+    }
+    allAttribs_.push_back(i);
+  }
+  threads_ = config->threads;
+  parallelRows_ = config->parallelRows;
+
+  if (config->maxLeaves > 0 || config->maxSeconds > 0) {
+    return BestFirstTree(config->maxLeaves, config->maxSeconds).createTree(ds, config->height,
+      [&](DataSet& nodeDS, int64_t height) {
+        return createTreeRec(nodeDS, height, config->minLeaf, config->minGain,
+                             config->useNominalBinary, config->useNominalOrdered);
+      });
+  }
   return createTreeRec(ds, config->height, config->minLeaf, config->minGain,
-                       config->useNominalBinary);
+                       config->useNominalBinary, config->useNominalOrdered);
 }
 
 
 std::shared_ptr<DecisionTreeNode> AodhaTree::createTreeRec(DataSet& ds, int64_t height,
                                                            int64_t minLeaf, long double minGain,
-                                                           bool useNominalBinary) {
+                                                           bool useNominalBinary, bool useNominalOrdered) {
   ErrorUtils::enforce(ds.getTotClasses() > 0, "Invalid data set.");
-  if (height == 0 || (minLeaf > 0 && ds.samples_.size() <= minLeaf)
-      || isAllSameClass(ds)) {
-    return createLeaf(ds);
+  if (height == 0 || (minLeaf > 0 && ds.getTotWeight() <= minLeaf)) {
+    return createLeaf(ds.getBestClass().first);
+  }
+  std::unique_ptr<NodeStats> stats;
+  {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    if (threads_ != 1 && ds.samples_.size() >= parallelRows_) {
+      stats = ParallelSplitSearch(threads_).createStats(ds, allAttribs_, minValue_, maxValue_);
+    } else {
+      stats.reset(new NodeStats(ds, nominalAttribs_, minValue_, maxValue_));
+    }
+  }
+  int64_t bestClass = stats->getBestClass().first;
+  int64_t totWeight = stats->getTotWeight();
+  if (stats->isAllSameClass()) {
+    return createLeaf(bestClass);
   }
 
-  long double impurity = calcImpurity(ds);
+  long double impurity = calcImpurity(stats->getDiffSums());
   int64_t bestAttrib = -1;
   long double bestGain = 0;
   int64_t bestSeparator = -1;
   for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
-    AttribResult result = calcAttribGain(ds, i, impurity, useNominalBinary);
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, i);
+    AttribResult result = calcAttribGain(ds, *stats, i, impurity, useNominalBinary, useNominalOrdered);
 
     if (CompareUtils::compare(result.gain, bestGain) > 0) {
       bestAttrib = i;
@@ -50,8 +92,21 @@ std::shared_ptr<DecisionTreeNode> AodhaTree::createTreeRec(DataSet& ds, int64_t
     }
   }
 
+  // Values going to the first child of a nominal split in two
+  std::vector<int64_t> leftValues;
+  if (bestAttrib != -1 && bestSeparator != -1 && ds.getAttributeType(bestAttrib) == AttributeType::STRING) {
+    if (useNominalOrdered) {
+      std::vector<int64_t> order = stats->getValueOrder(bestAttrib);
+      leftValues.assign(order.begin(), order.begin() + bestSeparator + 1);
+      std::sort(leftValues.begin(), leftValues.end());
+    } else {
+      leftValues.push_back(bestSeparator);
+    }
+  }
+  // The children get their own statistics
+  stats.reset();
   if (bestAttrib == -1 || CompareUtils::compare(bestGain, minGain) < 0) {
-    return createLeaf(ds);
+    return createLeaf(bestClass);
   }
   
   // Nominal attribute
@@ -61,47 +116,59 @@ std::shared_ptr<DecisionTreeNode> AodhaTree::createTreeRec(DataSet& ds, int64_t
     for (int64_t i = 0; i < bestAttribSize; i++) {
       allDS[i].initAllAttributes(ds);
     }
-    for (const auto& s : ds.samples_) {
-      allDS[s->inxValue_[bestAttrib]].addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        allDS[s->inxValue_[bestAttrib]].addSample(s);
+      }
     }
 
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL,
       bestAttrib);
     node->setAlpha(1 - bestGain);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(totWeight);
+    node->setLeafValue(bestClass);
 
     for (int64_t j = 0; j < bestAttribSize; j++) {
-      node->addChild(createTreeRec(allDS[j], height - 1, minLeaf, minGain, useNominalBinary), { j });
+      node->addChild(createTreeRec(allDS[j], height - 1, minLeaf, minGain, useNominalBinary, useNominalOrdered), { j });
     }
 
     return node;
 
-  // Nominal attribute separating one value from the rest
+  // Nominal attribute separating leftValues from the rest
   } else if (bestSeparator != -1 && ds.getAttributeType(bestAttrib) == AttributeType::STRING) {
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, bestAttrib);
     node->setAlpha(1 - bestGain);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(totWeight);
+    node->setLeafValue(bestClass);
 
+    std::vector<bool> isLeft(ds.getAttributeSize(bestAttrib), false);
+    for (auto j : leftValues) {
+      isLeft[j] = true;
+    }
     DataSet leftDS, rightDS;
     leftDS.initAllAttributes(ds);
     rightDS.initAllAttributes(ds);
-    for (const auto& s : ds.samples_) {
-      if (s->inxValue_[bestAttrib] == bestSeparator) {
-        leftDS.addSample(s);
-      }
-      else {
-        rightDS.addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        if (isLeft[s->inxValue_[bestAttrib]]) {
+          leftDS.addSample(s);
+        }
+        else {
+          rightDS.addSample(s);
+        }
       }
     }
 
-    node->addChild(createTreeRec(leftDS, height - 1, minLeaf, minGain, useNominalBinary), { bestSeparator });
+    node->addChild(createTreeRec(leftDS, height - 1, minLeaf, minGain, useNominalBinary, useNominalOrdered), leftValues);
     std::vector<int64_t> rightInxs;
     for (int64_t i = 0; i < ds.getAttributeSize(bestAttrib); i++) {
-      if (i != bestSeparator) rightInxs.push_back(i);
+      if (!isLeft[i]) rightInxs.push_back(i);
     }
-    node->addChild(createTreeRec(rightDS, height - 1, minLeaf, minGain, useNominalBinary), rightInxs);
+    node->addChild(createTreeRec(rightDS, height - 1, minLeaf, minGain, useNominalBinary, useNominalOrdered), rightInxs);
 
     return node;
 
@@ -110,102 +177,72 @@ std::shared_ptr<DecisionTreeNode> AodhaTree::createTreeRec(DataSet& ds, int64_t
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_ORDERED,
                                                                             bestAttrib, bestSeparator);
     node->setAlpha(1 - bestGain);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(totWeight);
+    node->setLeafValue(bestClass);
 
     DataSet leftDS, rightDS;
     leftDS.initAllAttributes(ds);
     rightDS.initAllAttributes(ds);
-    for (const auto& s : ds.samples_) {
-      if (s->inxValue_[bestAttrib] <= bestSeparator) {
-        leftDS.addSample(s);
-      }
-      else {
-        rightDS.addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        if (s->inxValue_[bestAttrib] <= bestSeparator) {
+          leftDS.addSample(s);
+        }
+        else {
+          rightDS.addSample(s);
+        }
       }
     }
-    node->addLeftChild(createTreeRec(leftDS, height - 1, minLeaf, minGain, useNominalBinary));
-    node->addRightChild(createTreeRec(rightDS, height - 1, minLeaf, minGain, useNominalBinary));
+    node->addLeftChild(createTreeRec(leftDS, height - 1, minLeaf, minGain, useNominalBinary, useNominalOrdered));
+    node->addRightChild(createTreeRec(rightDS, height - 1, minLeaf, minGain, useNominalBinary, useNominalOrdered));
     return node;
   }
 }
 
 
-bool AodhaTree::isAllSameClass(DataSet& ds) {
-  int64_t tot0 = 0;
-  int64_t tot1 = 0;
-  for (auto s : ds.samples_) {
-    if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) >= 0) {
-      tot0++;
-    }
-    else {
-      tot1++;
-    }
-    if (tot0 > 0 && tot1 > 0) return false;
-  }
-  return tot0 == 0 || tot1 == 0;
-}
-
-
-AodhaTree::AttribResult AodhaTree::calcAttribGain(DataSet& ds, int64_t attribInx,
+AodhaTree::AttribResult AodhaTree::calcAttribGain(DataSet& ds, NodeStats& stats, int64_t attribInx,
                                                   long double parentImp,
-                                                  bool useNominalBinary) {
-  if (ds.getAttributeType(attribInx) == AttributeType::STRING) {
-    return calcNominalGain(ds, attribInx, parentImp, useNominalBinary);
+                                                  bool useNominalBinary, bool useNominalOrdered) {
+  if (ds.getAttributeType(attribInx) == AttributeType::STRING && useNominalOrdered) {
+    return calcNominalOrderedGain(stats, attribInx, parentImp);
+  } else if (ds.getAttributeType(attribInx) == AttributeType::STRING) {
+    return calcNominalGain(ds, stats, attribInx, parentImp, useNominalBinary);
+  } else if (stats.isCollected(attribInx)) {
+    return calcHistogramGain(ds, stats, attribInx, parentImp);
   } else {
-    return calcNumericGain(ds, attribInx, parentImp);
+    return calcNumericGain(ds, stats, attribInx, parentImp);
   }
 }
 
 
-AodhaTree::AttribResult AodhaTree::calcNominalGain(DataSet& ds, int64_t attribInx,
+AodhaTree::AttribResult AodhaTree::calcNominalGain(DataSet& ds, NodeStats& stats, int64_t attribInx,
                                                    long double parentImp, bool useNominalBinary) {
   AttribResult ans;
 
   if (useNominalBinary) {
-    ImpSums allSums;
-    std::vector<ImpSums> subSums(ds.getAttributeSize(attribInx));
-    std::vector<int64_t> totSamples(ds.getAttributeSize(attribInx), 0);
-
-    for (auto s : ds.samples_) {
-      totSamples[s->inxValue_[attribInx]]++;
-
-      long double benefit0 = normalizedValue(s->benefit_[0]);
-      long double benefit1 = normalizedValue(s->benefit_[1]);
-
-      subSums[s->inxValue_[attribInx]].sumS += std::abs(benefit0 - benefit1);
-      allSums.sumS += std::abs(benefit0 - benefit1);
-
-      if (CompareUtils::compare(benefit0, benefit1) > 0) {
-        subSums[s->inxValue_[attribInx]].sumS0 += benefit0 - benefit1;
-        subSums[s->inxValue_[attribInx]].sumSqS0 += (benefit0 - benefit1) * (benefit0 - benefit1);
-        allSums.sumS0 += benefit0 - benefit1;
-        allSums.sumSqS0 += (benefit0 - benefit1) * (benefit0 - benefit1);
-      }
-      else {
-        subSums[s->inxValue_[attribInx]].sumS1 += benefit1 - benefit0;
-        subSums[s->inxValue_[attribInx]].sumSqS1 += (benefit1 - benefit0) * (benefit1 - benefit0);
-        allSums.sumS1 += benefit1 - benefit0;
-        allSums.sumSqS1 += (benefit1 - benefit0) * (benefit1 - benefit0);
-      }
-    }
+    NodeStats::DiffSums allSums = stats.getDiffSums();
+    WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, ds.getAttributeSize(attribInx));
 
     ans.impurity = parentImp;
     ans.gain = 0;
     ans.separator = -1;
     for (int64_t j = 0; j < ds.getAttributeSize(attribInx); j++) {
-      long double impLeft = applyFormula(subSums[j].sumS,
-                                         subSums[j].sumS0,
-                                         subSums[j].sumS1,
-                                         subSums[j].sumSqS0,
-                                         subSums[j].sumSqS1);
-      long double impRight = applyFormula(allSums.sumS - subSums[j].sumS,
-                                          allSums.sumS0 - subSums[j].sumS0,
-                                          allSums.sumS1 - subSums[j].sumS1,
-                                          allSums.sumSqS0 - subSums[j].sumSqS0,
-                                          allSums.sumSqS1 - subSums[j].sumSqS1);
-      long double impurity = impLeft * (totSamples[j] / ((long double)ds.samples_.size()))
-                             + impRight * ((ds.samples_.size() - totSamples[j]) / ((long double)ds.samples_.size()));
+      NodeStats::DiffSums subSums = stats.getDiffSums(attribInx, j);
+      int64_t valueWeight = stats.getTotWeight(attribInx, j);
+      long double impLeft = applyFormula(subSums.sumS,
+                                         subSums.sumS0,
+                                         subSums.sumS1,
+                                         subSums.sumSqS0,
+                                         subSums.sumSqS1);
+      long double impRight = applyFormula(allSums.sumS - subSums.sumS,
+                                          allSums.sumS0 - subSums.sumS0,
+                                          allSums.sumS1 - subSums.sumS1,
+                                          allSums.sumSqS0 - subSums.sumSqS0,
+                                          allSums.sumSqS1 - subSums.sumSqS1);
+      long double impurity = impLeft * (valueWeight / ((long double)stats.getTotWeight()))
+                             + impRight * ((stats.getTotWeight() - valueWeight) / ((long double)stats.getTotWeight()));
       if (ans.separator == -1 || CompareUtils::compare(ans.impurity, impurity) > 0) {
         ans.impurity = impurity;
         ans.gain = parentImp - impurity;
@@ -214,11 +251,12 @@ AodhaTree::AttribResult AodhaTree::calcNominalGain(DataSet& ds, int64_t attribIn
     }
   }
   else {
+    WorkCounters::add(WorkCounters::SPLIT_CANDIDATES);
     long double impurity = 0;
-    if (ds.samples_.size() > 0) {
+    if (stats.getTotWeight() > 0) {
       for (int i = 0; i < ds.getAttributeSize(attribInx); i++) {
-        auto subDS = ds.getSubDataSet(attribInx, i);
-        impurity += (subDS.samples_.size() / ((long double)ds.samples_.size())) * calcImpurity(subDS);
+        impurity += (stats.getTotWeight(attribInx, i) / ((long double)stats.getTotWeight()))
+                    * calcImpurity(stats.getDiffSums(attribInx, i));
       }
     }
     ans.impurity = impurity;
@@ -229,13 +267,61 @@ AodhaTree::AttribResult AodhaTree::calcNominalGain(DataSet& ds, int64_t attribIn
 }
 
 
-AodhaTree::AttribResult AodhaTree::calcNumericGain(DataSet& ds, int64_t attribInx, long double parentImp) {
+// The values sorted by NodeStats::getValueOrder are swept as calcNumericGain
+// sweeps an ordered attribute, a value at a time. The separator is the last
+// position of the order going to the left.
+AodhaTree::AttribResult AodhaTree::calcNominalOrderedGain(NodeStats& stats, int64_t attribInx,
+                                                          long double parentImp) {
+  std::vector<int64_t> order = stats.getValueOrder(attribInx);
+  NodeStats::DiffSums leftSums;
+  NodeStats::DiffSums rightSums = stats.getDiffSums();
+  int64_t leftWeight = 0;
+  int64_t totWeight = stats.getTotWeight();
+
+  AttribResult ans;
+  ans.impurity = parentImp;
+  ans.gain = 0;
+  ans.separator = -1;
+  int64_t totCandidates = 0;
+  // Values without samples are last and don't move the sums
+  for (int64_t p = 0; p + 1 < order.size() && stats.getTotWeight(attribInx, order[p + 1]) > 0; p++) {
+    totCandidates++;
+    NodeStats::DiffSums valueSums = stats.getDiffSums(attribInx, order[p]);
+    leftSums.sumS += valueSums.sumS;
+    leftSums.sumS0 += valueSums.sumS0;
+    leftSums.sumS1 += valueSums.sumS1;
+    leftSums.sumSqS0 += valueSums.sumSqS0;
+    leftSums.sumSqS1 += valueSums.sumSqS1;
+    rightSums.sumS -= valueSums.sumS;
+    rightSums.sumS0 -= valueSums.sumS0;
+    rightSums.sumS1 -= valueSums.sumS1;
+    rightSums.sumSqS0 -= valueSums.sumSqS0;
+    rightSums.sumSqS1 -= valueSums.sumSqS1;
+    leftWeight += stats.getTotWeight(attribInx, order[p]);
+
+    long double impurity = (leftWeight/((long double)totWeight)) * calcImpurity(leftSums)
+                           + ((totWeight - leftWeight)/((long double)totWeight)) * calcImpurity(rightSums);
+    if (CompareUtils::compare(impurity, ans.impurity) < 0) {
+      ans.impurity = impurity;
+      ans.gain = parentImp - impurity;
+      ans.separator = p;
+    }
+  }
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
+  return ans;
+}
+
+
+AodhaTree::AttribResult AodhaTree::calcNumericGain(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                   long double parentImp) {
   // Order attributes in asceding order according to this attribute
   struct Order {
     int64_t attribValue;
     std::shared_ptr<Sample> ptr;
   };
   std::vector<Order> ord(ds.samples_.size());
+  WorkCounters::addRows(attribInx, ds.samples_.size());
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, ord.size() * sizeof(Order));
   int64_t count = 0;
   for (auto s : ds.samples_) {
     ord[count].attribValue = s->inxValue_[attribInx];
@@ -245,64 +331,57 @@ AodhaTree::AttribResult AodhaTree::calcNumericGain(DataSet& ds, int64_t attribIn
   std::sort(ord.begin(), ord.end(),
     [](const Order& a, const Order& b) { return a.attribValue < b.attribValue; });
 
-  // Calculate the sums for left and right children
-  ImpSums leftSums;
-  ImpSums rightSums;
-  for (auto s : ds.samples_) {
-    long double benefit0 = normalizedValue(s->benefit_[0]);
-    long double benefit1 = normalizedValue(s->benefit_[1]);
-
-    rightSums.sumS += std::abs(benefit0 - benefit1);
-
-    if (CompareUtils::compare(benefit0, benefit1) > 0) {
-      rightSums.sumS0 += benefit0 - benefit1;
-      rightSums.sumSqS0 += (benefit0 - benefit1) * (benefit0 - benefit1);
-    }
-    else {
-      rightSums.sumS1 += benefit1 - benefit0;
-      rightSums.sumSqS1 += (benefit1 - benefit0) * (benefit1 - benefit0);
-    }
-  }
+  // Sums for left and right children, all samples start to the right
+  NodeStats::DiffSums leftSums;
+  NodeStats::DiffSums rightSums = stats.getDiffSums();
+  int64_t leftWeight = 0;
+  int64_t totWeight = stats.getTotWeight();
 
   // Tries all possible splitting parameters
   long double bestImpurity = parentImp;
   int64_t bestSeparator = -1;
   int64_t i = 0;
+  int64_t totCandidates = 0;
   while (i < ord.size()) {
+    totCandidates++;
     long double leftImp = applyFormula(leftSums.sumS, leftSums.sumS0,
                                        leftSums.sumS1, leftSums.sumSqS0,
                                        leftSums.sumSqS1);
     long double rightImp = applyFormula(rightSums.sumS, rightSums.sumS0,
                                         rightSums.sumS1, rightSums.sumSqS0,
                                         rightSums.sumSqS1);
-    long double impurity = (i/((long double)ord.size())) * leftImp
-                           + ((ord.size() - i)/((long double)ord.size())) * rightImp;
+    long double impurity = (leftWeight/((long double)totWeight)) * leftImp
+                           + ((totWeight - leftWeight)/((long double)totWeight)) * rightImp;
     if (CompareUtils::compare(impurity, bestImpurity) < 0) {
       bestImpurity = impurity;
       bestSeparator = ord[i-1].attribValue;
     }
     int64_t start = i;
     while (i < ord.size() && ord[i].attribValue == ord[start].attribValue) {
-      // Decrease rightSums and add leftSums
-      long double benefit0 = normalizedValue(ord[i].ptr->benefit_[0]);
-      long double benefit1 = normalizedValue(ord[i].ptr->benefit_[1]);
-
-      rightSums.sumS -= std::abs(benefit0 - benefit1);
-      leftSums.sumS += std::abs(benefit0 - benefit1);
+      // Decrease rightSums and add leftSums, a sample of weight w is w rows
+      // with its mean benefits
+      long double weight = ord[i].ptr->weight_;
+      long double benefit0 = normalizedValue(ord[i].ptr->benefit_[0] / ord[i].ptr->weight_);
+      long double benefit1 = normalizedValue(ord[i].ptr->benefit_[1] / ord[i].ptr->weight_);
+
+      rightSums.sumS -= weight * std::abs(benefit0 - benefit1);
+      leftSums.sumS += weight * std::abs(benefit0 - benefit1);
       if (CompareUtils::compare(benefit0, benefit1) > 0) {
-        rightSums.sumS0 -= benefit0 - benefit1;
-        rightSums.sumSqS0 -= (benefit0 - benefit1) * (benefit0 - benefit1);
-        leftSums.sumS0 += benefit0 - benefit1;
-        leftSums.sumSqS0 += (benefit0 - benefit1) * (benefit0 - benefit1);
+        rightSums.sumS0 -= weight * (benefit0 - benefit1);
+        rightSums.sumSqS0 -= weight * ((benefit0 - benefit1) * (benefit0 - benefit1));
+        leftSums.sumS0 += weight * (benefit0 - benefit1);
+        leftSums.sumSqS0 += weight * ((benefit0 - benefit1) * (benefit0 - benefit1));
       } else {
-        rightSums.sumS1 -= benefit1 - benefit0;
-        rightSums.sumSqS1 -= (benefit1 - benefit0) * (benefit1 - benefit0);
-        leftSums.sumS1 += benefit1 - benefit0;
-        leftSums.sumSqS1 += (benefit1 - benefit0) * (benefit1 - benefit0);
+        rightSums.sumS1 -= weight * (benefit1 - benefit0);
+        rightSums.sumSqS1 -= weight * ((benefit1 - benefit0) * (benefit1 - benefit0));
+        leftSums.sumS1 += weight * (benefit1 - benefit0);
+        leftSums.sumSqS1 += weight * ((benefit1 - benefit0) * (benefit1 - benefit0));
       }
+      leftWeight += ord[i].ptr->weight_;
       i++;
     }
   }
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
 
   AttribResult ans;
   ans.impurity = bestImpurity;
@@ -312,45 +391,69 @@ AodhaTree::AttribResult AodhaTree::calcNumericGain(DataSet& ds, int64_t attribIn
 }
 
 
-std::shared_ptr<DecisionTreeNode> AodhaTree::createLeaf(DataSet& ds) {
-  auto best = ds.getBestClass();
+std::shared_ptr<DecisionTreeNode> AodhaTree::createLeaf(int64_t leafValue) {
+  Profiler::ScopedTimer timer(Profiler::LEAF_CREATION);
 
   std::shared_ptr<DecisionTreeNode> leaf = std::make_shared<DecisionTreeNode>(DecisionTreeNode::NodeType::LEAF);
-  leaf->setName("LEAF " + std::to_string(best.first));
-  leaf->setLeafValue(best.first);
+  leaf->setName("LEAF " + std::to_string(leafValue));
+  leaf->setLeafValue(leafValue);
 
   return leaf;
 }
 
 
-long double AodhaTree::calcImpurity(DataSet& ds) {
-  if (ds.samples_.size() == 0) {
-    return 0;
-  }
+// Same candidates as calcNumericGain, a value of the histogram
+// standing for its samples
+AodhaTree::AttribResult AodhaTree::calcHistogramGain(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                     long double parentImp) {
+  NodeStats::DiffSums leftSums;
+  NodeStats::DiffSums rightSums = stats.getDiffSums();
+  int64_t leftWeight = 0;
+  int64_t totWeight = stats.getTotWeight();
 
-  long double sumS = 0;
-  long double sumS0 = 0;
-  long double sumS1 = 0;
-  long double sumSqS0 = 0;
-  long double sumSqS1 = 0;
-
-  for (auto s : ds.samples_) {
-    long double benefit0 = normalizedValue(s->benefit_[0]);
-    long double benefit1 = normalizedValue(s->benefit_[1]);
-
-    sumS += std::abs(benefit0 - benefit1);
-
-    if (CompareUtils::compare(benefit0, benefit1) > 0) {
-      sumS0 += benefit0 - benefit1;
-      sumSqS0 += (benefit0 - benefit1) * (benefit0 - benefit1);
+  long double bestImpurity = parentImp;
+  int64_t bestSeparator = -1;
+  // Last value with samples to the left
+  int64_t lastLeft = -1;
+  int64_t totCandidates = 0;
+  for (int64_t j = 0; j < ds.getAttributeSize(attribInx); j++) {
+    int64_t valueWeight = stats.getTotWeight(attribInx, j);
+    if (valueWeight == 0) {
+      continue;
     }
-    else {
-      sumS1 += benefit1 - benefit0;
-      sumSqS1 += (benefit1 - benefit0) * (benefit1 - benefit0);
+    totCandidates++;
+    long double impurity = (leftWeight/((long double)totWeight)) * calcImpurity(leftSums)
+                           + ((totWeight - leftWeight)/((long double)totWeight)) * calcImpurity(rightSums);
+    if (CompareUtils::compare(impurity, bestImpurity) < 0) {
+      bestImpurity = impurity;
+      bestSeparator = lastLeft;
     }
+    NodeStats::DiffSums valueSums = stats.getDiffSums(attribInx, j);
+    leftSums.sumS += valueSums.sumS;
+    leftSums.sumS0 += valueSums.sumS0;
+    leftSums.sumS1 += valueSums.sumS1;
+    leftSums.sumSqS0 += valueSums.sumSqS0;
+    leftSums.sumSqS1 += valueSums.sumSqS1;
+    rightSums.sumS -= valueSums.sumS;
+    rightSums.sumS0 -= valueSums.sumS0;
+    rightSums.sumS1 -= valueSums.sumS1;
+    rightSums.sumSqS0 -= valueSums.sumSqS0;
+    rightSums.sumSqS1 -= valueSums.sumSqS1;
+    leftWeight += valueWeight;
+    lastLeft = j;
   }
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
+
+  AodhaTree::AttribResult ans;
+  ans.impurity = bestImpurity;
+  ans.gain = parentImp - bestImpurity;
+  ans.separator = bestSeparator;
+  return ans;
+}
+
 
-  return applyFormula(sumS, sumS0, sumS1, sumSqS0, sumSqS1);
+long double AodhaTree::calcImpurity(const NodeStats::DiffSums& sums) {
+  return applyFormula(sums.sumS, sums.sumS0, sums.sumS1, sums.sumSqS0, sums.sumSqS1);
 }
 
 
@@ -366,8 +469,8 @@ void AodhaTree::calcNormVars(DataSet& ds) {
   minValue_ = std::numeric_limits<long double>::max();
   maxValue_ = std::numeric_limits<long double>::min();
   for (auto s : ds.samples_) {
-    minValue_ = std::min(minValue_, (long double)std::min(s->benefit_[0], s->benefit_[1]));
-    maxValue_ = std::max(maxValue_, (long double)std::max(s->benefit_[0], s->benefit_[1]));
+    minValue_ = std::min(minValue_, (long double)std::min(s->benefit_[0], s->benefit_[1]) / s->weight_);
+    maxValue_ = std::max(maxValue_, (long double)std::max(s->benefit_[0], s->benefit_[1]) / s->weight_);
   }
 }
 
@@ -5,6 +5,7 @@
 #include "ConfigTree.h"
 #include "DataSet.h"
 #include "DecisionTreeNode.h"
+#include "NodeStats.h"
 #include "Tree.h"
 
 #include <vector>
@@ -14,6 +15,20 @@ public:
   int64_t minLeaf;
   double minGain;
   bool useNominalBinary;
+  // Splits nominal attributes in two by the order of NodeStats::getValueOrder,
+  // instead of one value against the rest
+  bool useNominalOrdered = false;
+  // Grows the tree a level at a time with LevelWiseTree instead of a node at a time
+  bool levelWise = false;
+  // Threads streaming the attribute columns of a level when level-wise, or
+  // collecting the statistics of a node of at least parallelRows samples by
+  // ranges of rows (ParallelSplitSearch). 0 uses every hardware thread.
+  int64_t threads = 1;
+  int64_t parallelRows = 1000000;
+  // Grows the tree best first with BestFirstTree until it has maxLeaves leaves
+  // or maxSeconds have passed, 0 for no limit on either
+  int64_t maxLeaves = 0;
+  double maxSeconds = 0;
   std::vector<long double> alphas;
   std::vector<int64_t> minSamples;
 };
@@ -24,30 +39,28 @@ public:
   std::shared_ptr<DecisionTreeNode> createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) override;
 
 private:
+  // Scores nodes from statistics gathered over column files
+  friend class LevelWiseTree;
+
   struct AttribResult {
     long double impurity;
     long double gain;
     int64_t separator;
   };
-  struct ImpSums {
-    long double sumS = 0;
-    long double sumS0 = 0;
-    long double sumS1 = 0;
-    long double sumSqS0 = 0;
-    long double sumSqS1 = 0;
-  };
-  
+
   std::shared_ptr<DecisionTreeNode> createTreeRec(DataSet& ds, int64_t height,
                                                   int64_t minLeaf, long double minGain,
-                                                  bool useNominalBinary);
-  bool isAllSameClass(DataSet& ds);
-  AttribResult calcAttribGain(DataSet& ds, int64_t attribInx, long double parentImp,
-                              bool useNominalBinary);
-  AttribResult calcNominalGain(DataSet& ds, int64_t attribInx, long double parentImp,
+                                                  bool useNominalBinary, bool useNominalOrdered);
+  AttribResult calcAttribGain(DataSet& ds, NodeStats& stats, int64_t attribInx, long double parentImp,
+                              bool useNominalBinary, bool useNominalOrdered);
+  AttribResult calcNominalGain(DataSet& ds, NodeStats& stats, int64_t attribInx, long double parentImp,
                                bool useNominalBinary);
-  AttribResult calcNumericGain(DataSet& ds, int64_t attribInx, long double parentImp);
-  std::shared_ptr<DecisionTreeNode> createLeaf(DataSet& ds);
-  long double calcImpurity(DataSet& ds);
+  AttribResult calcNominalOrderedGain(NodeStats& stats, int64_t attribInx, long double parentImp);
+  AttribResult calcNumericGain(DataSet& ds, NodeStats& stats, int64_t attribInx, long double parentImp);
+  // Sweeps the values of attribInx collected by stats instead of sorted samples
+  AttribResult calcHistogramGain(DataSet& ds, NodeStats& stats, int64_t attribInx, long double parentImp);
+  std::shared_ptr<DecisionTreeNode> createLeaf(int64_t leafValue);
+  long double calcImpurity(const NodeStats::DiffSums& sums);
   long double applyFormula(long double sumS, long double sumS0,
                            long double sumS1, long double sumSqS0,
                            long double sumSqS1);
@@ -56,4 +69,10 @@ private:
 
   long double minValue_;
   long double maxValue_;
+  // Attributes scored by value, collected by NodeStats
+  std::vector<int64_t> nominalAttribs_;
+  // Huge nodes collect every attribute and sweep ordered ones by value
+  std::vector<int64_t> allAttribs_;
+  int64_t threads_ = 1;
+  int64_t parallelRows_ = 0;
 };
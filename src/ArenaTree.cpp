@@ -0,0 +1,322 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "ArenaTree.h"
+
+#include "CompareUtils.h"
+#include "ErrorUtils.h"
+
+#include <algorithm>
+
+
+ArenaTree::NodeView::NodeView(ArenaTree* tree, int64_t inx) : tree_(tree), inx_(inx) {}
+
+
+DecisionTreeNode::NodeType ArenaTree::NodeView::getType() {
+  return tree_->nodes_[inx_].type;
+}
+
+
+int64_t ArenaTree::NodeView::getAttribCol() {
+  return tree_->nodes_[inx_].attribCol;
+}
+
+
+int64_t ArenaTree::NodeView::getLeafValue() {
+  return tree_->nodes_[inx_].leafValue;
+}
+
+
+int64_t ArenaTree::NodeView::getSeparator() {
+  return tree_->nodes_[inx_].separator;
+}
+
+
+long double ArenaTree::NodeView::getAlpha() {
+  return tree_->nodes_[inx_].alpha;
+}
+
+
+int64_t ArenaTree::NodeView::getNumSamples() {
+  return tree_->nodes_[inx_].numSamples;
+}
+
+
+bool ArenaTree::NodeView::isLeaf() {
+  return tree_->nodes_[inx_].type == DecisionTreeNode::NodeType::LEAF;
+}
+
+
+ArenaTree::NodeView ArenaTree::NodeView::getLeftChild() {
+  ErrorUtils::enforce(getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED,
+                      "Node must be REGULAR_ORDERED type.");
+  return getChild(getSeparator());
+}
+
+
+ArenaTree::NodeView ArenaTree::NodeView::getRightChild() {
+  ErrorUtils::enforce(getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED,
+                      "Node must be REGULAR_ORDERED type.");
+  return getChild(getSeparator() + 1);
+}
+
+
+ArenaTree::NodeView ArenaTree::NodeView::getChild(int64_t inxValue) {
+  return NodeView(tree_, tree_->findChild(inx_, inxValue));
+}
+
+
+int64_t ArenaTree::NodeView::getTotChildren() {
+  return tree_->nodes_[inx_].totChildren;
+}
+
+
+int64_t ArenaTree::NodeView::getChildKey(int64_t pos) {
+  ErrorUtils::enforce(pos >= 0 && pos < getTotChildren(), "Out of bounds");
+  return tree_->children_[tree_->nodes_[inx_].firstChild + pos].key;
+}
+
+
+ArenaTree::NodeView ArenaTree::NodeView::getChildAt(int64_t pos) {
+  ErrorUtils::enforce(pos >= 0 && pos < getTotChildren(), "Out of bounds");
+  return NodeView(tree_, tree_->children_[tree_->nodes_[inx_].firstChild + pos].node);
+}
+
+
+int64_t ArenaTree::NodeView::getSize() {
+  return tree_->getSizeRec(inx_);
+}
+
+
+int64_t ArenaTree::NodeView::classify(std::shared_ptr<Sample> s) {
+  int64_t inx = inx_;
+  while (inx >= 0 && tree_->nodes_[inx].type != DecisionTreeNode::NodeType::LEAF) {
+    ErrorUtils::enforce(tree_->nodes_[inx].attribCol < s->inxValue_.size(),
+                        "Sample doesn't have the required column");
+    inx = tree_->findChild(inx, s->inxValue_[tree_->nodes_[inx].attribCol]);
+  }
+  return inx < 0 ? -1 : tree_->nodes_[inx].leafValue;
+}
+
+
+bool ArenaTree::NodeView::isValid() {
+  return inx_ >= 0;
+}
+
+
+int64_t ArenaTree::NodeView::getIndex() {
+  return inx_;
+}
+
+
+ArenaTree::ArenaTree() {}
+
+
+ArenaTree::ArenaTree(std::shared_ptr<ExtrasTreeNode> tree) {
+  ErrorUtils::enforce(tree != nullptr, "ArenaTree: empty tree.");
+  std::map<DecisionTreeNode*, int64_t> nodeInx;
+  addNode(tree.get(), true, nodeInx);
+}
+
+
+ArenaTree::ArenaTree(std::shared_ptr<DecisionTreeNode> tree) {
+  ErrorUtils::enforce(tree != nullptr, "ArenaTree: empty tree.");
+  std::map<DecisionTreeNode*, int64_t> nodeInx;
+  addNode(tree.get(), false, nodeInx);
+}
+
+
+ArenaTree ArenaTree::getTree(long double targetAlpha, int64_t minSamples) {
+  ArenaTree pruned;
+  if (nodes_.empty()) {
+    return pruned;
+  }
+  pruned.nodes_.reserve(nodes_.size());
+  pruned.children_.reserve(children_.size());
+  std::vector<int64_t> newInx(nodes_.size(), -1);
+  addPruned(pruned, 0, targetAlpha, minSamples, newInx);
+  return pruned;
+}
+
+
+std::shared_ptr<ExtrasTreeNode> ArenaTree::toTree() {
+  if (nodes_.empty()) {
+    return nullptr;
+  }
+  std::vector<std::shared_ptr<ExtrasTreeNode>> done(nodes_.size());
+  return toTreeRec(0, done);
+}
+
+
+ArenaTree::NodeView ArenaTree::getRoot() {
+  return NodeView(this, nodes_.empty() ? -1 : 0);
+}
+
+
+int64_t ArenaTree::classify(std::shared_ptr<Sample> s) {
+  return getRoot().classify(s);
+}
+
+
+int64_t ArenaTree::classify(std::shared_ptr<Sample> s, int64_t& pathLength) {
+  int64_t inx = 0;
+  while (true) {
+    pathLength++;
+    const Node& node = nodes_[inx];
+    if (node.type == DecisionTreeNode::NodeType::LEAF) {
+      return node.leafValue;
+    }
+    ErrorUtils::enforce(node.attribCol < s->inxValue_.size(), "Sample doesn't have the required column");
+    inx = findChild(inx, s->inxValue_[node.attribCol]);
+    if (inx < 0) {
+      return -1;
+    }
+  }
+}
+
+
+int64_t ArenaTree::getSize() {
+  return nodes_.empty() ? 0 : getSizeRec(0);
+}
+
+
+int64_t ArenaTree::getTotNodes() {
+  return nodes_.size();
+}
+
+
+int64_t ArenaTree::getMemoryUsage() {
+  return sizeof(ArenaTree) + nodes_.capacity() * sizeof(Node) + children_.capacity() * sizeof(Child);
+}
+
+
+int64_t ArenaTree::addNode(DecisionTreeNode* node, bool extras,
+                           std::map<DecisionTreeNode*, int64_t>& nodeInx) {
+  auto it = nodeInx.find(node);
+  if (it != nodeInx.end()) {
+    return it->second;
+  }
+  int64_t inx = nodes_.size();
+  nodeInx[node] = inx;
+  nodes_.push_back(Node());
+
+  Node info;
+  info.type = node->getType();
+  info.attribCol = node->getAttribCol();
+  info.separator = node->getSeparator();
+  info.leafValue = node->getLeafValue();
+  info.alpha = extras ? static_cast<ExtrasTreeNode*>(node)->getAlpha() : 1;
+  info.numSamples = extras ? static_cast<int64_t>(static_cast<ExtrasTreeNode*>(node)->getNumSamples()) : 0;
+  std::vector<Child> children;
+  for (const auto& child : node->children_) {
+    if (child.second) {
+      children.push_back({child.first, addNode(child.second.get(), extras, nodeInx)});
+    }
+  }
+  // Appended after the recursion so the children of a node stay contiguous
+  info.firstChild = children_.size();
+  info.totChildren = children.size();
+  children_.insert(children_.end(), children.begin(), children.end());
+  nodes_[inx] = info;
+  return inx;
+}
+
+
+int64_t ArenaTree::addPruned(ArenaTree& to, int64_t inx, long double targetAlpha, int64_t minSamples,
+                             std::vector<int64_t>& newInx) {
+  if (newInx[inx] >= 0) {
+    return newInx[inx];
+  }
+  int64_t ans = to.nodes_.size();
+  newInx[inx] = ans;
+  Node info = nodes_[inx];
+  int64_t firstChild = info.firstChild;
+  info.firstChild = to.children_.size();
+  if (info.type == DecisionTreeNode::NodeType::LEAF || CompareUtils::compare(info.alpha, targetAlpha) > 0
+      || info.numSamples <= minSamples) {
+    info.type = DecisionTreeNode::NodeType::LEAF;
+    info.attribCol = -1;
+    info.separator = -1;
+    info.totChildren = 0;
+  }
+  to.nodes_.push_back(info);
+
+  // The children slots are taken before the recursion so they stay contiguous
+  to.children_.resize(to.children_.size() + info.totChildren);
+  for (int64_t c = 0; c < info.totChildren; c++) {
+    const Child& child = children_[firstChild + c];
+    int64_t node = addPruned(to, child.node, targetAlpha, minSamples, newInx);
+    to.children_[info.firstChild + c] = {child.key, node};
+  }
+  return ans;
+}
+
+
+std::shared_ptr<ExtrasTreeNode> ArenaTree::toTreeRec(int64_t inx,
+                                                     std::vector<std::shared_ptr<ExtrasTreeNode>>& done) {
+  if (done[inx]) {
+    return done[inx];
+  }
+  const Node info = nodes_[inx];
+  auto node = std::make_shared<ExtrasTreeNode>(info.type, info.attribCol, info.separator);
+  node->setLeafValue(info.leafValue);
+  node->setAlpha(info.alpha);
+  node->setNumSamples(info.numSamples);
+  done[inx] = node;
+  for (int64_t c = info.firstChild; c < info.firstChild + info.totChildren; c++) {
+    auto child = toTreeRec(children_[c].node, done);
+    if (info.type == DecisionTreeNode::NodeType::REGULAR_NOMINAL) {
+      node->addChild(child, { children_[c].key });
+    } else if (children_[c].key == 0) {
+      node->addLeftChild(child);
+    } else {
+      node->addRightChild(child);
+    }
+  }
+  return node;
+}
+
+
+int64_t ArenaTree::findChild(int64_t inx, int64_t inxValue) {
+  const Node& node = nodes_[inx];
+  ErrorUtils::enforce(node.type != DecisionTreeNode::NodeType::LEAF, "Can't find a child on a LEAF node.");
+  int64_t key = inxValue;
+  if (node.type == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+    key = inxValue <= node.separator ? 0 : 1;
+  }
+  const Child* first = children_.data() + node.firstChild;
+  const Child* last = first + node.totChildren;
+  auto it = std::lower_bound(first, last, key,
+    [](const Child& c, int64_t k) { return c.key < k; });
+  if (it == last || it->key != key) {
+    return -1;
+  }
+  return it->node;
+}
+
+
+// Children shared by several keys of a node are counted once
+int64_t ArenaTree::getSizeRec(int64_t inx) {
+  const Node& node = nodes_[inx];
+  const Child* first = children_.data() + node.firstChild;
+  if (node.totChildren <= 2) {
+    int64_t size = 1;
+    for (int64_t c = 0; c < node.totChildren; c++) {
+      if (c == 0 || first[c].node != first[0].node) {
+        size += getSizeRec(first[c].node);
+      }
+    }
+    return size;
+  }
+  std::vector<int64_t> unique;
+  for (int64_t c = 0; c < node.totChildren; c++) {
+    unique.push_back(first[c].node);
+  }
+  std::sort(unique.begin(), unique.end());
+  unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+  int64_t size = 1;
+  for (auto child : unique) {
+    size += getSizeRec(child);
+  }
+  return size;
+}
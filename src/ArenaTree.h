@@ -0,0 +1,112 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements a tree whose nodes live in a single array, with
+// children linked by index, so a tree is copied, pruned and freed as a whole
+// instead of node by node. NodeView gives the DecisionTreeNode accessors over
+// a node of the array, and toTree converts back to linked nodes.
+//
+
+#pragma once
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+#include "Sample.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+class ArenaTree {
+public:
+  class NodeView {
+  public:
+    NodeView(ArenaTree* tree, int64_t inx);
+
+    DecisionTreeNode::NodeType getType();
+    int64_t getAttribCol();
+    int64_t getLeafValue();
+    int64_t getSeparator();
+    long double getAlpha();
+    int64_t getNumSamples();
+    bool isLeaf();
+
+    // Only for REGULAR_ORDERED nodes, an invalid view if the child is missing
+    NodeView getLeftChild();
+    NodeView getRightChild();
+
+    // The child a value index goes to, as DecisionTreeNode::findChild
+    NodeView getChild(int64_t inxValue);
+
+    // Children in increasing key order, keys sharing a child repeat it
+    int64_t getTotChildren();
+    int64_t getChildKey(int64_t pos);
+    NodeView getChildAt(int64_t pos);
+
+    int64_t getSize();
+    int64_t classify(std::shared_ptr<Sample> s);
+
+    bool isValid();
+    int64_t getIndex();
+
+  private:
+    ArenaTree* tree_;
+    int64_t inx_;
+  };
+
+  ArenaTree();
+
+  // Alpha and number of samples are kept from ExtrasTreeNode trees,
+  // DecisionTreeNode ones get the ExtrasTreeNode defaults
+  ArenaTree(std::shared_ptr<ExtrasTreeNode> tree);
+
+  ArenaTree(std::shared_ptr<DecisionTreeNode> tree);
+
+  // Same pruning as ExtrasTreeNode::getTree, without allocating a node per node
+  ArenaTree getTree(long double targetAlpha, int64_t minSamples);
+
+  std::shared_ptr<ExtrasTreeNode> toTree();
+
+  NodeView getRoot();
+
+  // Same results as DecisionTreeNode::classify, -1 if a child is missing
+  int64_t classify(std::shared_ptr<Sample> s);
+
+  int64_t classify(std::shared_ptr<Sample> s, int64_t& pathLength);
+
+  // Counts the nodes as DecisionTreeNode::getSize
+  int64_t getSize();
+
+  int64_t getTotNodes();
+
+  int64_t getMemoryUsage();
+
+private:
+  struct Node {
+    DecisionTreeNode::NodeType type;
+    int64_t attribCol;
+    int64_t separator;
+    int64_t leafValue;
+    long double alpha;
+    int64_t numSamples;
+    int64_t firstChild;
+    int64_t totChildren;
+  };
+
+  // Sorted by key in each node, as the children_ maps
+  struct Child {
+    int64_t key;
+    int64_t node;
+  };
+
+  int64_t addNode(DecisionTreeNode* node, bool extras, std::map<DecisionTreeNode*, int64_t>& nodeInx);
+  int64_t addPruned(ArenaTree& to, int64_t inx, long double targetAlpha, int64_t minSamples,
+                    std::vector<int64_t>& newInx);
+  std::shared_ptr<ExtrasTreeNode> toTreeRec(int64_t inx, std::vector<std::shared_ptr<ExtrasTreeNode>>& done);
+  int64_t findChild(int64_t inx, int64_t inxValue);
+  int64_t getSizeRec(int64_t inx);
+
+  // The root is node 0
+  std::vector<Node> nodes_;
+  std::vector<Child> children_;
+};
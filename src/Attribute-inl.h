@@ -3,8 +3,10 @@
 
 #pragma once
 #include "ErrorUtils.h"
+#include "MemoryUsage.h"
 
 #include <algorithm>
+#include <iostream>
 
 template <typename T>
 Attribute<T>::Attribute(AttributeType attType)
@@ -23,6 +25,19 @@ void Attribute<T>::addValue(T value) {
   }
 }
 
+template <typename T>
+void Attribute<T>::addValue(T value, int64_t count) {
+  auto pos = valueInx_.find(value);
+  if (pos == valueInx_.end()) {
+    valueInx_.insert(std::pair<T, int64_t>(value, lastInx_++));
+    inxValue_.push_back(value);
+    frequency_.push_back(count);
+  }
+  else {
+    frequency_[pos->second] += count;
+  }
+}
+
 template <typename T>
 int64_t Attribute<T>::getInx(T value) {
   auto ans = valueInx_.find(value);
@@ -97,3 +112,17 @@ void Attribute<T>::print() {
     std::cout << i << " " << frequency_[i] << std::endl;
   }
 }
+
+template <typename T>
+int64_t Attribute<T>::getMemoryUsage() {
+  int64_t ans = sizeof(*this);
+  for (const auto& it : valueInx_) {
+    ans += MemoryUsage::mapNodeBytes(sizeof(std::pair<const T, int64_t>)) + heapBytes(it.first);
+  }
+  ans += inxValue_.capacity() * sizeof(T);
+  for (const auto& value : inxValue_) {
+    ans += heapBytes(value);
+  }
+  ans += frequency_.capacity() * sizeof(int64_t);
+  return ans;
+}
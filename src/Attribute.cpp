@@ -17,4 +17,24 @@ bool Attribute<double>::lessThan(const double& a, const double& b) {
 template <>
 bool Attribute<std::string>::lessThan(const std::string& a, const std::string& b) {
   return (a.compare(b) < 0);
-}
\ No newline at end of file
+}
+
+template <>
+int64_t Attribute<int64_t>::heapBytes(const int64_t& value) {
+  return 0;
+}
+
+template <>
+int64_t Attribute<double>::heapBytes(const double& value) {
+  return 0;
+}
+
+template <>
+int64_t Attribute<std::string>::heapBytes(const std::string& value) {
+  // Short strings are stored inside the object
+  const char* data = value.data();
+  if (data >= (const char*)&value && data < (const char*)(&value + 1)) {
+    return 0;
+  }
+  return value.capacity() + 1;
+}
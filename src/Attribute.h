@@ -5,6 +5,7 @@
 //
 
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <map>
 #include <string>
@@ -17,6 +18,8 @@ public:
 	Attribute(AttributeType attType);
 
 	void addValue(T value);
+  // Same as adding value count times
+  void addValue(T value, int64_t count);
   int64_t getInx(T value);
 	T getValue(int64_t index);
   void setName(std::string name);
@@ -26,9 +29,13 @@ public:
   std::string getName();
   void sortIndexes();
   void print();
+  // Estimated bytes held by the dictionaries
+  int64_t getMemoryUsage();
 	
 private:
   static bool lessThan(const T& a, const T& b);
+  // Bytes a value holds outside the object itself
+  static int64_t heapBytes(const T& value);
 
   const AttributeType type_;
   std::map<T, int64_t> valueInx_;
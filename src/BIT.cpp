@@ -3,12 +3,31 @@
 
 #include "BIT.h"
 
+#include "MemoryUsage.h"
+#include "WorkCounters.h"
 
-BIT::BIT(int64_t N) : N_(N+1), tree_(N+1, 0) {}
+
+BIT::BIT(int64_t N) : N_(N+1), tree_(N+1, 0), ops_(0) {
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, tree_.size() * sizeof(double));
+  MemoryUsage::allocate(MemoryUsage::BIT_ARRAYS, tree_.size() * sizeof(double));
+}
+
+
+BIT::BIT(const BIT& other) : N_(other.N_), tree_(other.tree_), ops_(0) {
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, tree_.size() * sizeof(double));
+  MemoryUsage::allocate(MemoryUsage::BIT_ARRAYS, tree_.size() * sizeof(double));
+}
+
+
+BIT::~BIT() {
+  WorkCounters::add(WorkCounters::BIT_OPERATIONS, ops_);
+  MemoryUsage::release(MemoryUsage::BIT_ARRAYS, tree_.size() * sizeof(double));
+}
 
 
 void BIT::update(int64_t inx, double value) {
   //inx++;
+  ops_++;
   while (inx < N_) {
     tree_[inx] += value;
     inx += (inx & -inx);
@@ -17,6 +36,7 @@ void BIT::update(int64_t inx, double value) {
 
 
 double BIT::get(int64_t inx) {
+  ops_++;
   double sum = 0;
   while (inx > 0) {
     sum += tree_[inx];
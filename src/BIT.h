@@ -2,16 +2,22 @@
 // License: BSD 3 clause
 
 #pragma once
+#include <cstdint>
 #include <vector>
 
 
 class BIT {
 public:
   BIT(int64_t N);
+  BIT(const BIT& other);
+  ~BIT();
   void update(int64_t inx, double value);
   double get(int64_t inx);
 
 private:
   int64_t N_;
   std::vector<double> tree_;
+  // Flushed to WorkCounters on destruction, keeps update/get free of
+  // thread local accesses
+  int64_t ops_;
 };
@@ -0,0 +1,173 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "BatchScorer.h"
+
+#include "Converter.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "ReadCSV.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <ostream>
+#include <thread>
+
+
+BatchScorer::BatchScorer(std::string modelFileName, int64_t threads, int64_t chunkRows)
+  : model_(modelFileName), threads_(threads), chunkRows_(chunkRows),
+    labelColumn_(-1), hasBenefit_(false) {
+  if (threads_ <= 0) {
+    threads_ = std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+  ErrorUtils::enforce(chunkRows_ > 0, "BatchScorer: chunk size must be positive.");
+  for (int64_t c = 0; c < model_.getTotClasses(); c++) {
+    classNames_.push_back(model_.getClassValue(c));
+  }
+}
+
+
+void BatchScorer::setLabelColumn(std::string column) {
+  labelName_ = column;
+}
+
+
+int64_t BatchScorer::score(std::string inputFileName, std::string outputFileName) {
+  Logger::log() << "Started scoring file " << inputFileName << " with " << threads_ << " threads";
+  int64_t start = Profiler::now();
+  ReadCSV reader;
+  reader.open(inputFileName);
+  std::vector<std::vector<std::string>> chunk;
+  ErrorUtils::enforce(reader.readChunk(chunk, 1), "Empty file " + inputFileName);
+  mapColumns(chunk[0]);
+
+  std::ofstream ofs(outputFileName, std::ofstream::out);
+  ErrorUtils::enforce(ofs.is_open(), "BatchScorer: can't create " + outputFileName);
+  ofs << (hasBenefit_ ? "row,class,benefit\n" : "row,class\n");
+
+  std::vector<std::vector<std::string>> next;
+  std::vector<Prediction> predictions;
+  bool hasRows = reader.readChunk(chunk, chunkRows_);
+  int64_t totRows = 0;
+  std::string line;
+  char buffer[32];
+  while (hasRows) {
+    // Reads the next chunk while this one is scored
+    auto pending = std::async(std::launch::async, [&]() {
+      return reader.readChunk(next, chunkRows_);
+    });
+    scoreChunk(chunk, predictions);
+    for (const auto& p : predictions) {
+      line = std::to_string(totRows++) + ",";
+      if (p.classInx >= 0) {
+        line += classNames_[p.classInx];
+      }
+      if (hasBenefit_) {
+        line += ",";
+        if (!std::isnan(p.benefit)) {
+          snprintf(buffer, sizeof(buffer), "%.6f", p.benefit);
+          line += buffer;
+        }
+      }
+      line += '\n';
+      ofs << line;
+    }
+    hasRows = pending.get();
+    chunk.swap(next);
+  }
+  ofs.close();
+
+  double seconds = (Profiler::now() - start) / 1e9;
+  Logger::log() << "Finished scoring " << totRows << " rows in " << seconds << " s ("
+                << (seconds > 0 ? totRows / seconds : 0) << " rows/s)";
+  return totRows;
+}
+
+
+void BatchScorer::mapColumns(const std::vector<std::string>& header) {
+  auto findColumn = [&header](const std::string& name) -> int64_t {
+    auto it = std::find(header.begin(), header.end(), name);
+    return it == header.end() ? -1 : it - header.begin();
+  };
+
+  attribColumn_.assign(model_.getTotAttributes(), -1);
+  for (int64_t a = 0; a < model_.getTotAttributes(); a++) {
+    attribColumn_[a] = findColumn(model_.getAttributeName(a));
+    if (attribColumn_[a] < 0) {
+      Logger::log() << "Column " << model_.getAttributeName(a)
+                    << " not found, its splits use the node majority class";
+    }
+  }
+
+  // Same layouts used for training: one cost column per class, or a label
+  costColumn_.assign(model_.getTotClasses(), -1);
+  bool hasCosts = true;
+  for (int64_t c = 0; c < model_.getTotClasses(); c++) {
+    costColumn_[c] = findColumn(classNames_[c]);
+    hasCosts = hasCosts && costColumn_[c] >= 0;
+  }
+  if (!hasCosts) {
+    costColumn_.clear();
+  }
+  labelColumn_ = -1;
+  if (!hasCosts && labelName_ != "") {
+    labelColumn_ = findColumn(labelName_);
+    ErrorUtils::enforce(labelColumn_ >= 0, "BatchScorer: label column " + labelName_ + " not found.");
+  }
+  hasBenefit_ = hasCosts || labelColumn_ >= 0;
+}
+
+
+void BatchScorer::scoreChunk(const std::vector<std::vector<std::string>>& rows,
+                             std::vector<Prediction>& predictions) {
+  predictions.resize(rows.size());
+  int64_t totThreads = std::min<int64_t>(threads_, (rows.size() + 1023) / 1024);
+  if (totThreads <= 1) {
+    scoreRange(rows, 0, rows.size(), predictions);
+    return;
+  }
+  std::vector<std::thread> workers;
+  int64_t step = (rows.size() + totThreads - 1) / totThreads;
+  for (int64_t t = 0; t < totThreads; t++) {
+    int64_t begin = t * step;
+    int64_t end = std::min<int64_t>(rows.size(), begin + step);
+    workers.emplace_back(&BatchScorer::scoreRange, this, std::cref(rows), begin, end,
+                         std::ref(predictions));
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+
+void BatchScorer::scoreRange(const std::vector<std::vector<std::string>>& rows,
+                             int64_t begin, int64_t end, std::vector<Prediction>& predictions) {
+  static const std::string EMPTY = "";
+  std::vector<int64_t> inxValues(model_.getTotAttributes());
+  for (int64_t r = begin; r < end; r++) {
+    const auto& row = rows[r];
+    for (int64_t a = 0; a < inxValues.size(); a++) {
+      int64_t col = attribColumn_[a];
+      inxValues[a] = model_.encode(a, (col >= 0 && col < row.size()) ? row[col] : EMPTY);
+    }
+    Prediction& p = predictions[r];
+    p.classInx = model_.classify(inxValues.data());
+    p.benefit = std::numeric_limits<double>::quiet_NaN();
+    if (p.classInx < 0) {
+      continue;
+    }
+    if (!costColumn_.empty()) {
+      int64_t col = costColumn_[p.classInx];
+      if (col < row.size() && Converter::isDouble(row[col])) {
+        p.benefit = 0 - Converter::fromString<double>(row[col]);
+      }
+    } else if (labelColumn_ >= 0 && labelColumn_ < row.size()) {
+      p.benefit = (row[labelColumn_] == classNames_[p.classInx]) ? -1 : 0;
+    }
+  }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module scores raw CSV files with a saved model. The file is streamed
+// in chunks, each chunk is encoded with the model dictionaries and classified
+// on all threads while the next chunk is read.
+//
+
+#pragma once
+#include "MappedModel.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BatchScorer {
+public:
+  // threads = 0 uses every hardware thread
+  BatchScorer(std::string modelFileName, int64_t threads = 0, int64_t chunkRows = 65536);
+
+  // Column with the true class, used for the benefit when the input has no
+  // cost column per class: -1 for the true class and 0 for the others, as the
+  // benefits of a labeled training set
+  void setLabelColumn(std::string column);
+
+  // Writes "row,class[,benefit]" per input row and returns the number of rows
+  int64_t score(std::string inputFileName, std::string outputFileName);
+
+private:
+  struct Prediction {
+    int64_t classInx;
+    double benefit;
+  };
+
+  void mapColumns(const std::vector<std::string>& header);
+  void scoreChunk(const std::vector<std::vector<std::string>>& rows,
+                  std::vector<Prediction>& predictions);
+  void scoreRange(const std::vector<std::vector<std::string>>& rows,
+                  int64_t begin, int64_t end, std::vector<Prediction>& predictions);
+
+  MappedModel model_;
+  int64_t threads_;
+  int64_t chunkRows_;
+  std::string labelName_;
+  std::vector<std::string> classNames_;
+  // Input column of each model attribute and of each class cost, -1 if missing
+  std::vector<int64_t> attribColumn_;
+  std::vector<int64_t> costColumn_;
+  int64_t labelColumn_;
+  bool hasBenefit_;
+};
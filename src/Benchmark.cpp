@@ -0,0 +1,100 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "Benchmark.h"
+
+#include "ErrorUtils.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+
+Benchmark::Benchmark(int64_t repetitions, int64_t warmup)
+  : repetitions_(repetitions), warmup_(warmup) {
+  ErrorUtils::enforce(repetitions_ > 0, "Benchmark: repetitions must be positive.");
+}
+
+
+void Benchmark::run(std::string name, Params params, std::function<void()> body,
+                    std::function<void()> setup) {
+  Result result;
+  result.name = name;
+  result.params = params;
+
+  for (int64_t i = 0; i < warmup_ + repetitions_; i++) {
+    if (setup != nullptr) {
+      setup();
+    }
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    if (i >= warmup_) {
+      result.nanoseconds.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+  }
+
+  std::vector<int64_t> sorted = result.nanoseconds;
+  std::sort(sorted.begin(), sorted.end());
+  auto& log = Logger::log() << "Benchmark " << name;
+  for (const auto& p : params) {
+    log << " " << p.first << "=" << p.second;
+  }
+  log << " median " << sorted[sorted.size() / 2] << " ns";
+
+  results_.push_back(result);
+}
+
+
+void Benchmark::saveJSON(std::string fileName) {
+  std::ofstream ofs(fileName, std::ofstream::out);
+  ErrorUtils::enforce(ofs.is_open(), "Benchmark: can't open " + fileName);
+
+  JsonWriter json(ofs);
+  json.beginObject();
+  json.field("clock", "steady_clock");
+  json.field("unit", "ns");
+  json.field("repetitions", repetitions_);
+  json.field("warmup", warmup_);
+  json.key("results");
+  json.beginArray();
+  for (const auto& result : results_) {
+    std::vector<int64_t> sorted = result.nanoseconds;
+    std::sort(sorted.begin(), sorted.end());
+    long double mean = 0;
+    for (auto ns : sorted) {
+      mean += ns;
+    }
+    mean /= sorted.size();
+
+    json.beginObject();
+    json.field("name", result.name);
+    json.key("params");
+    json.beginObject();
+    for (const auto& p : result.params) {
+      json.field(p.first, p.second);
+    }
+    json.endObject();
+    json.field("min", sorted.front());
+    json.field("median", sorted[sorted.size() / 2]);
+    json.field("mean", mean);
+    json.field("max", sorted.back());
+    json.key("samples");
+    json.beginArray();
+    for (auto ns : result.nanoseconds) {
+      json.value(ns);
+    }
+    json.endArray();
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+  ofs.close();
+}
+
+
+const std::vector<Benchmark::Result>& Benchmark::getResults() {
+  return results_;
+}
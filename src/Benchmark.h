@@ -0,0 +1,41 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements a small benchmark harness. Each case is timed with
+// std::chrono::steady_clock over a number of repetitions and all the raw
+// timings are saved as JSON.
+//
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Benchmark {
+public:
+  typedef std::vector<std::pair<std::string, int64_t>> Params;
+
+  struct Result {
+    std::string name;
+    Params params;
+    std::vector<int64_t> nanoseconds;
+  };
+
+  Benchmark(int64_t repetitions, int64_t warmup);
+
+  // Runs 'body' warmup_ + repetitions_ times, timing only the last
+  // repetitions_ calls. 'setup' runs untimed before every call.
+  void run(std::string name, Params params, std::function<void()> body,
+           std::function<void()> setup = nullptr);
+
+  void saveJSON(std::string fileName);
+
+  const std::vector<Result>& getResults();
+
+private:
+  int64_t repetitions_;
+  int64_t warmup_;
+  std::vector<Result> results_;
+};
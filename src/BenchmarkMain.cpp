@@ -0,0 +1,58 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// Benchmark entry point.
+// Usage: PairTreeBench [-sizes 1000,10000] [-reps 5] [-warmup 1]
+//                      [-filter build/pair] [-work folder] [-out bench.json]
+//
+
+#include "Benchmark.h"
+#include "BenchmarkSuite.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+  std::vector<int64_t> sizes = { 1000, 10000, 100000 };
+  int64_t repetitions = 5;
+  int64_t warmup = 1;
+  std::string filter = "";
+  std::string workFolder = "";
+  std::string outputFile = "bench.json";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    ErrorUtils::enforce(i + 1 < argc, "Missing value for " + arg);
+    std::string value = argv[++i];
+    if (arg == "-sizes") {
+      sizes.clear();
+      std::stringstream ss(value);
+      std::string size;
+      while (std::getline(ss, size, ',')) {
+        sizes.push_back(std::stoll(size));
+      }
+    } else if (arg == "-reps") {
+      repetitions = std::stoll(value);
+    } else if (arg == "-warmup") {
+      warmup = std::stoll(value);
+    } else if (arg == "-filter") {
+      filter = value;
+    } else if (arg == "-work") {
+      workFolder = value;
+    } else if (arg == "-out") {
+      outputFile = value;
+    } else {
+      ErrorUtils::enforce(false, "Unknown option " + arg);
+    }
+  }
+
+  Benchmark bench(repetitions, warmup);
+  BenchmarkSuite suite(bench, workFolder, filter);
+  suite.run(sizes);
+  bench.saveJSON(outputFile);
+  Logger::log() << "Saved benchmark results to " << outputFile << std::endl;
+  return 0;
+}
@@ -0,0 +1,376 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "BenchmarkSuite.h"
+
+#include "AodhaTree.h"
+#include "ArenaTree.h"
+#include "BIT.h"
+#include "ExtrasTreeNode.h"
+#include "DataSetBuilder.h"
+#include "DataSetGenerator.h"
+#include "GreedyBBTree.h"
+#include "GreedyDrawTree.h"
+#include "GreedyTree.h"
+#include "Logger.h"
+#include "PairTree.h"
+#include "RawTree.h"
+#include "Tester.h"
+
+#include <algorithm>
+#include <random>
+
+BenchmarkSuite::BenchmarkSuite(Benchmark& bench, std::string workFolder, std::string filter)
+  : bench_(bench), workFolder_(workFolder), filter_(filter) {}
+
+
+void BenchmarkSuite::run(const std::vector<int64_t>& sizes) {
+  for (auto rows : sizes) {
+    Logger::log() << "Benchmarking data set with " << rows << " rows";
+    std::shared_ptr<ConfigGenerator> config = std::make_shared<ConfigGenerator>();
+    config->rows = rows;
+    DataSetGenerator generator(config);
+
+    if (isSelected("load/buildFromFile")) {
+      std::string fileName = workFolder_ + "bench_" + std::to_string(rows) + ".csv";
+      generator.writeCSV(fileName);
+      benchLoad(rows, fileName, generator.getClassColStart());
+    }
+
+    DataSet ds = generator.build();
+    benchBuilders(rows, ds);
+    benchKernels(rows, ds);
+    benchBIT(rows);
+    benchTester(rows, ds);
+    benchInference(rows, ds);
+    benchPruning(rows, ds);
+  }
+}
+
+
+void BenchmarkSuite::benchLoad(int64_t rows, const std::string& fileName,
+                               int64_t classColStart) {
+  bench_.run("load/buildFromFile", { { "rows", rows } }, [&]() {
+    DataSetBuilder builder;
+    DataSet ds = builder.buildFromFile(fileName, classColStart);
+  });
+}
+
+
+void BenchmarkSuite::benchBuilders(int64_t rows, DataSet& ds) {
+  if (isSelected("build/pair")) {
+    auto config = std::make_shared<ConfigPairTree>();
+    config->height = 6;
+    config->maxBound = 1;
+    config->minLeaf = 30;
+    config->useScore = false;
+    config->useNominalBinary = false;
+    config->boundOption = "DIFF";
+    bench_.run("build/pair", { { "rows", rows }, { "height", config->height } }, [&]() {
+      PairTree tree;
+      tree.createTree(ds, config);
+    });
+  }
+
+  if (isSelected("build/greedy")) {
+    auto config = std::make_shared<ConfigGreedy>();
+    config->height = 6;
+    config->minLeaf = 30;
+    config->percentiles = 100;
+    config->minGain = 0;
+    config->useNominalBinary = false;
+    bench_.run("build/greedy", { { "rows", rows }, { "height", config->height } }, [&]() {
+      GreedyTree tree;
+      tree.createTree(ds, config);
+    });
+  }
+
+  if (isSelected("build/aodha")) {
+    auto config = std::make_shared<ConfigAodha>();
+    config->height = 6;
+    config->minLeaf = 30;
+    config->minGain = 0;
+    config->useNominalBinary = false;
+    bench_.run("build/aodha", { { "rows", rows }, { "height", config->height } }, [&]() {
+      AodhaTree tree;
+      tree.createTree(ds, config);
+    });
+  }
+
+  if (isSelected("build/greedyDraw")) {
+    auto config = std::make_shared<ConfigGreedyDraw>();
+    config->height = 2;
+    config->totDraws = 5;
+    config->minLeaf = 30;
+    bench_.run("build/greedyDraw", { { "rows", rows }, { "height", config->height } }, [&]() {
+      GreedyDrawTree tree;
+      tree.createTree(ds, config);
+    });
+  }
+
+  // The backbone search is exponential on the height, keep it shallow
+  if (isSelected("build/greedyBB")) {
+    auto config = std::make_shared<ConfigGreedyBB>();
+    config->height = 1;
+    bench_.run("build/greedyBB", { { "rows", rows }, { "height", config->height } }, [&]() {
+      GreedyBBTree tree;
+      tree.createTree(ds, config);
+    });
+  }
+}
+
+
+void BenchmarkSuite::benchKernels(int64_t rows, DataSet& ds) {
+  PairTree pairTree;
+  std::vector<PairTree::SampleInfo> samplesInfo;
+  pairTree.initSampleInfo(ds, samplesInfo);
+
+  if (isSelected("kernel/testNumeric")) {
+    for (int64_t attrib = 0; attrib < ds.getTotAttributes(); attrib++) {
+      if (ds.getAttributeType(attrib) == AttributeType::STRING) continue;
+      bench_.run("kernel/testNumeric",
+                 { { "rows", rows }, { "attrib", attrib }, { "cardinality", ds.getAttributeSize(attrib) } },
+                 [&]() {
+        pairTree.testNumeric(ds, attrib, samplesInfo, PairTree::BoundType::DIFF_BOUND);
+      });
+    }
+  }
+
+  if (isSelected("kernel/calcNominalScore")) {
+    for (int64_t attrib = 0; attrib < ds.getTotAttributes(); attrib++) {
+      if (ds.getAttributeType(attrib) != AttributeType::STRING) continue;
+      int64_t attribSize = ds.getAttributeSize(attrib);
+      std::function<int64_t(int64_t)> valueBox = [](int64_t inxValue) { return inxValue; };
+      bench_.run("kernel/calcNominalScore",
+                 { { "rows", rows }, { "attrib", attrib }, { "cardinality", attribSize } },
+                 [&]() {
+        pairTree.calcNominalScore(ds, attrib, valueBox, attribSize, samplesInfo);
+      });
+    }
+  }
+
+  if (isSelected("kernel/testNominalOrdered")) {
+    std::vector<int64_t> nominalAttribs;
+    for (int64_t attrib = 0; attrib < ds.getTotAttributes(); attrib++) {
+      if (ds.getAttributeType(attrib) == AttributeType::STRING) nominalAttribs.push_back(attrib);
+    }
+    NodeStats stats(ds, nominalAttribs);
+    for (auto attrib : nominalAttribs) {
+      bench_.run("kernel/testNominalOrdered",
+                 { { "rows", rows }, { "attrib", attrib }, { "cardinality", ds.getAttributeSize(attrib) } },
+                 [&]() {
+        pairTree.testNominalOrdered(ds, stats, attrib, samplesInfo, PairTree::BoundType::DIFF_BOUND);
+      });
+    }
+  }
+
+  if (isSelected("kernel/calcMatchingSums")) {
+    // Same inputs calcConstTSq builds for the T bound
+    std::vector<long double> s0;
+    std::vector<long double> s1;
+    pairTree.createTwoDiffs(ds, s0, s1);
+    if (s0.size() > 0 && s1.size() > 0) {
+      if (s0.size() < s1.size()) {
+        std::sort(s0.begin(), s0.end(), std::greater<long double>());
+        std::sort(s1.begin(), s1.end(), std::less<long double>());
+      } else {
+        std::sort(s0.begin(), s0.end(), std::less<long double>());
+        std::sort(s1.begin(), s1.end(), std::greater<long double>());
+        std::swap(s0, s1);
+      }
+      bench_.run("kernel/calcMatchingSums", { { "rows", rows } }, [&]() {
+        pairTree.calcMatchingSums(s0, s1);
+      });
+    }
+  }
+}
+
+
+void BenchmarkSuite::benchBIT(int64_t rows) {
+  if (!isSelected("kernel/BIT")) return;
+  std::mt19937_64 gen(rows);
+  std::vector<int64_t> positions(rows);
+  for (int64_t i = 0; i < rows; i++) {
+    positions[i] = 1 + gen() % rows;
+  }
+  bench_.run("kernel/BIT", { { "rows", rows } }, [&]() {
+    BIT bit(rows);
+    double sum = 0;
+    for (int64_t i = 0; i < rows; i++) {
+      bit.update(positions[i], 1.0);
+      sum += bit.get(positions[rows - i - 1]);
+    }
+    if (sum < 0) Logger::log() << sum;
+  });
+}
+
+
+void BenchmarkSuite::benchTester(int64_t rows, DataSet& ds) {
+  if (isSelected("test/Tester")) {
+    auto config = std::make_shared<ConfigGreedy>();
+    config->height = 10;
+    config->minLeaf = 1;
+    config->percentiles = 1000;
+    config->minGain = 0;
+    config->useNominalBinary = false;
+    GreedyTree greedy;
+    auto tree = greedy.createTree(ds, config);
+
+    bench_.run("test/Tester", { { "rows", rows }, { "treeSize", tree->getSize() } }, [&]() {
+      Tester tester;
+      tester.test(tree, ds);
+    });
+  }
+
+  if (!isAnySelected({ "test/pruned", "test/prunedQuickScorer" })) return;
+  // Pruned variants of one tree, as in Trainer::runAlphaSamplesTrees
+  auto pairConfig = std::make_shared<ConfigPairTree>();
+  pairConfig->height = 8;
+  pairConfig->maxBound = 1;
+  pairConfig->minLeaf = 1;
+  pairConfig->useScore = false;
+  pairConfig->useNominalBinary = false;
+  pairConfig->boundOption = "DIFF";
+  PairTree pair;
+  auto fullTree = std::static_pointer_cast<ExtrasTreeNode>(pair.createTree(ds, pairConfig));
+  std::vector<std::shared_ptr<DecisionTreeNode>> trees;
+  for (long double alpha : { 0.0L, 0.001L, 0.01L, 0.1L, 1.0L }) {
+    for (int64_t minSamples : { 0, 1, 5, 10, 50, 100 }) {
+      trees.push_back(fullTree->getTree(alpha, minSamples));
+    }
+  }
+  Benchmark::Params params = {
+    { "rows", rows }, { "trees", (int64_t)trees.size() }, { "treeSize", fullTree->getSize() } };
+
+  if (isSelected("test/pruned")) {
+    bench_.run("test/pruned", params, [&]() {
+      Tester tester;
+      for (const auto& tree : trees) {
+        tester.test(tree, ds);
+      }
+    });
+  }
+
+  if (isSelected("test/prunedQuickScorer")) {
+    bench_.run("test/prunedQuickScorer", params, [&]() {
+      Tester tester;
+      tester.testMany(trees, ds);
+    });
+  }
+}
+
+
+// Scores raw records one at a time, through the Attribute dictionaries and
+// through RawTree
+void BenchmarkSuite::benchInference(int64_t rows, DataSet& ds) {
+  if (!isAnySelected({ "predict/dictionary", "predict/RawTree" })) return;
+  auto config = std::make_shared<ConfigGreedy>();
+  config->height = 10;
+  config->minLeaf = 1;
+  config->percentiles = 1000;
+  config->minGain = 0;
+  config->useNominalBinary = false;
+  GreedyTree greedy;
+  auto tree = greedy.createTree(ds, config);
+
+  int64_t totAttrib = ds.getTotAttributes();
+  std::vector<double> numbers;
+  std::vector<std::string> texts;
+  for (const auto& s : ds.samples_) {
+    for (int64_t a = 0; a < totAttrib; a++) {
+      AttributeType type = ds.getAttributeType(a);
+      numbers.push_back(type == AttributeType::INTEGER ? ds.getValue<int64_t>(a, s->inxValue_[a])
+                        : type == AttributeType::DOUBLE ? ds.getValue<double>(a, s->inxValue_[a]) : 0);
+      texts.push_back(type == AttributeType::STRING ? ds.getValue<std::string>(a, s->inxValue_[a]) : "");
+    }
+  }
+  int64_t totRows = ds.samples_.size();
+  int64_t checksum = 0;
+
+  if (isSelected("predict/dictionary")) {
+    bench_.run("predict/dictionary", { { "rows", rows }, { "treeSize", tree->getSize() } }, [&]() {
+      auto s = std::make_shared<Sample>(totAttrib, ds.getTotClasses());
+      for (int64_t r = 0; r < totRows; r++) {
+        for (int64_t a = 0; a < totAttrib; a++) {
+          int64_t i = r * totAttrib + a;
+          AttributeType type = ds.getAttributeType(a);
+          s->inxValue_[a] = type == AttributeType::INTEGER ? ds.getValueInx(a, (int64_t)numbers[i])
+                            : type == AttributeType::DOUBLE ? ds.getValueInx(a, numbers[i])
+                            : ds.getValueInx(a, texts[i]);
+        }
+        checksum += tree->classify(s);
+      }
+    });
+  }
+
+  if (isSelected("predict/RawTree")) {
+    RawTree raw(tree, ds);
+    bench_.run("predict/RawTree", { { "rows", rows }, { "treeSize", tree->getSize() } }, [&]() {
+      for (int64_t r = 0; r < totRows; r++) {
+        checksum += raw.classify(&numbers[r * totAttrib], &texts[r * totAttrib]);
+      }
+    });
+  }
+  Logger::log() << "Inference checksum " << checksum;
+}
+
+
+void BenchmarkSuite::benchPruning(int64_t rows, DataSet& ds) {
+  if (!isAnySelected({ "prune/getTree", "prune/arena", "prune/flatten" })) return;
+  auto config = std::make_shared<ConfigPairTree>();
+  config->height = 10;
+  config->maxBound = 1;
+  config->minLeaf = 1;
+  config->useScore = false;
+  config->useNominalBinary = false;
+  config->boundOption = "DIFF";
+  PairTree pair;
+  auto tree = std::static_pointer_cast<ExtrasTreeNode>(pair.createTree(ds, config));
+  ArenaTree arena(tree);
+  Benchmark::Params params = { { "rows", rows }, { "treeSize", tree->getSize() } };
+  int64_t checksum = 0;
+
+  // Every grid point of Trainer::runAlphaSamplesTrees, each tree freed right away
+  if (isSelected("prune/getTree")) {
+    bench_.run("prune/getTree", params, [&]() {
+      for (long double alpha : { 0.0L, 0.001L, 0.01L, 0.1L, 1.0L }) {
+        for (int64_t minSamples : { 0, 1, 5, 10, 50, 100 }) {
+          checksum += tree->getTree(alpha, minSamples)->getLeafValue();
+        }
+      }
+    });
+  }
+
+  if (isSelected("prune/arena")) {
+    bench_.run("prune/arena", params, [&]() {
+      for (long double alpha : { 0.0L, 0.001L, 0.01L, 0.1L, 1.0L }) {
+        for (int64_t minSamples : { 0, 1, 5, 10, 50, 100 }) {
+          checksum += arena.getTree(alpha, minSamples).getRoot().getLeafValue();
+        }
+      }
+    });
+  }
+
+  if (isSelected("prune/flatten")) {
+    bench_.run("prune/flatten", params, [&]() {
+      ArenaTree flat(tree);
+      checksum += flat.getTotNodes();
+    });
+  }
+  Logger::log() << "Pruning checksum " << checksum;
+}
+
+
+bool BenchmarkSuite::isSelected(const std::string& name) {
+  return filter_.empty() || name.find(filter_) != std::string::npos;
+}
+
+
+bool BenchmarkSuite::isAnySelected(const std::vector<std::string>& names) {
+  for (const auto& name : names) {
+    if (isSelected(name)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module defines the benchmark cases: tree builders, PairTree hot
+// kernels, the BIT, CSV loading, testing, raw value inference and pruning, over
+// synthetic data sets of parametrized sizes produced by DataSetGenerator.
+//
+
+#pragma once
+#include "Benchmark.h"
+#include "DataSet.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BenchmarkSuite {
+public:
+  BenchmarkSuite(Benchmark& bench, std::string workFolder, std::string filter);
+
+  void run(const std::vector<int64_t>& sizes);
+
+private:
+  void benchLoad(int64_t rows, const std::string& fileName, int64_t classColStart);
+  void benchBuilders(int64_t rows, DataSet& ds);
+  void benchKernels(int64_t rows, DataSet& ds);
+  void benchBIT(int64_t rows);
+  void benchTester(int64_t rows, DataSet& ds);
+  void benchInference(int64_t rows, DataSet& ds);
+  void benchPruning(int64_t rows, DataSet& ds);
+
+  bool isSelected(const std::string& name);
+  // Gates the shared setup of a group of cases
+  bool isAnySelected(const std::vector<std::string>& names);
+
+  Benchmark& bench_;
+  std::string workFolder_;
+  std::string filter_;
+};
@@ -0,0 +1,144 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "BestFirstTree.h"
+
+#include "CompareUtils.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <map>
+
+namespace {
+// Heap order: the top is the lowest alpha, the oldest candidate on ties
+template<typename T>
+bool isWorse(const T& a, const T& b) {
+  int cmp = CompareUtils::compare(a.split->getAlpha(), b.split->getAlpha());
+  if (cmp != 0) {
+    return cmp > 0;
+  }
+  return a.order > b.order;
+}
+}
+
+
+BestFirstTree::BestFirstTree(int64_t maxLeaves, double maxSeconds)
+  : maxLeaves_(maxLeaves), deadline_(0), height_(0), totCandidates_(0), totLeaves_(0), timedOut_(false) {
+  if (maxSeconds > 0) {
+    deadline_ = Profiler::now() + (int64_t)(maxSeconds * 1e9);
+  }
+}
+
+
+std::shared_ptr<DecisionTreeNode> BestFirstTree::createTree(DataSet& ds, int64_t height, SplitFunction split) {
+  height_ = height;
+  split_ = split;
+  queue_.clear();
+  totCandidates_ = 0;
+  root_ = split_(ds, 0);
+  totLeaves_ = 1;
+  addCandidate(nullptr, root_, ds, 0);
+
+  while (!queue_.empty() && !outOfTime()) {
+    std::pop_heap(queue_.begin(), queue_.end(), isWorse<Candidate>);
+    Candidate cand = std::move(queue_.back());
+    queue_.pop_back();
+    int64_t newLeaves = getDistinctChildren(cand.split).size() - 1;
+    if (maxLeaves_ > 0 && totLeaves_ + newLeaves > maxLeaves_) {
+      continue;
+    }
+    totLeaves_ += newLeaves;
+    expand(cand);
+  }
+  if (timedOut_) {
+    Logger::log() << "Best-first growth stopped at the time limit with " << totLeaves_ << " leaves" << std::endl;
+  }
+  queue_.clear();
+  return root_;
+}
+
+
+void BestFirstTree::addCandidate(std::shared_ptr<DecisionTreeNode> parent, std::shared_ptr<DecisionTreeNode> leaf,
+                                 DataSet& ds, int64_t depth) {
+  if (depth >= height_ || outOfTime()) {
+    return;
+  }
+  std::shared_ptr<DecisionTreeNode> node = split_(ds, 1);
+  if (node->isLeaf()) {
+    return;
+  }
+  Candidate cand;
+  cand.parent = parent;
+  cand.leaf = leaf;
+  cand.split = std::static_pointer_cast<ExtrasTreeNode>(node);
+  cand.ds = ds;
+  cand.depth = depth;
+  cand.order = totCandidates_++;
+  queue_.push_back(std::move(cand));
+  std::push_heap(queue_.begin(), queue_.end(), isWorse<Candidate>);
+}
+
+
+void BestFirstTree::expand(Candidate& cand) {
+  if (!cand.parent) {
+    root_ = cand.split;
+  } else {
+    // A nominal subset split reaches the same leaf from several values
+    for (auto& child : cand.parent->children_) {
+      if (child.second == cand.leaf) {
+        child.second = cand.split;
+      }
+    }
+  }
+
+  // Samples are partitioned in list order, so every child sees them in the
+  // order of the depth-first builders
+  auto children = getDistinctChildren(cand.split);
+  std::map<DecisionTreeNode*, int64_t> childPos;
+  std::vector<DataSet> childDS(children.size());
+  for (int64_t i = 0; i < children.size(); i++) {
+    childPos[children[i].get()] = i;
+    childDS[i].initAllAttributes(cand.ds);
+  }
+  int64_t attrib = cand.split->getAttribCol();
+  bool ordered = cand.split->getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED;
+  for (const auto& s : cand.ds.samples_) {
+    int64_t inxValue = s->inxValue_[attrib];
+    std::shared_ptr<DecisionTreeNode> child;
+    if (ordered) {
+      child = inxValue <= cand.split->getSeparator() ? cand.split->getLeftChild() : cand.split->getRightChild();
+    } else {
+      auto it = cand.split->children_.find(inxValue);
+      if (it == cand.split->children_.end()) {
+        continue;
+      }
+      child = it->second;
+    }
+    childDS[childPos[child.get()]].addSample(s);
+  }
+
+  for (int64_t i = 0; i < children.size(); i++) {
+    addCandidate(cand.split, children[i], childDS[i], cand.depth + 1);
+  }
+}
+
+
+std::vector<std::shared_ptr<DecisionTreeNode>> BestFirstTree::getDistinctChildren(std::shared_ptr<DecisionTreeNode> node) {
+  std::vector<std::shared_ptr<DecisionTreeNode>> children;
+  for (const auto& child : node->children_) {
+    if (std::find(children.begin(), children.end(), child.second) == children.end()) {
+      children.push_back(child.second);
+    }
+  }
+  return children;
+}
+
+
+bool BestFirstTree::outOfTime() {
+  if (deadline_ > 0 && !timedOut_ && Profiler::now() >= deadline_) {
+    timedOut_ = true;
+  }
+  return timedOut_;
+}
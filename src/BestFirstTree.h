@@ -0,0 +1,60 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module grows a tree best first under a budget: the expandable leaves
+// are kept in a priority queue by the alpha of their best split (the bound of
+// PairTree, 1 - gain for GreedyTree and AodhaTree), and the best one is split
+// next until the tree reaches maxLeaves leaves or maxSeconds have passed. Every
+// leaf of the queue already holds its best class, so stopping at any point
+// leaves a valid tree. Without a budget the tree is the depth-first one.
+//
+
+#pragma once
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class BestFirstTree {
+public:
+  // The builder's createTreeRec with height 0 or 1: a leaf, or an
+  // ExtrasTreeNode whose children are leaves
+  typedef std::function<std::shared_ptr<DecisionTreeNode>(DataSet&, int64_t)> SplitFunction;
+
+  // 0 means no limit
+  BestFirstTree(int64_t maxLeaves, double maxSeconds);
+
+  std::shared_ptr<DecisionTreeNode> createTree(DataSet& ds, int64_t height, SplitFunction split);
+
+private:
+  // A leaf of the tree with the split it would take
+  struct Candidate {
+    // Null for the root
+    std::shared_ptr<DecisionTreeNode> parent;
+    std::shared_ptr<DecisionTreeNode> leaf;
+    std::shared_ptr<ExtrasTreeNode> split;
+    DataSet ds;
+    int64_t depth;
+    // Insertion order, breaks ties between equal alphas
+    int64_t order;
+  };
+
+  void addCandidate(std::shared_ptr<DecisionTreeNode> parent, std::shared_ptr<DecisionTreeNode> leaf,
+                    DataSet& ds, int64_t depth);
+  void expand(Candidate& cand);
+  std::vector<std::shared_ptr<DecisionTreeNode>> getDistinctChildren(std::shared_ptr<DecisionTreeNode> node);
+  bool outOfTime();
+
+  int64_t maxLeaves_;
+  int64_t deadline_;
+  int64_t height_;
+  SplitFunction split_;
+  std::shared_ptr<DecisionTreeNode> root_;
+  std::vector<Candidate> queue_;
+  int64_t totCandidates_;
+  int64_t totLeaves_;
+  bool timedOut_;
+};
@@ -0,0 +1,169 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "BitmapIndex.h"
+
+#include "CompareUtils.h"
+#include "ErrorUtils.h"
+#include "WorkCounters.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+const int64_t WORD_BITS = 64;
+
+int64_t popCount(uint64_t word) {
+#ifdef _MSC_VER
+  return __popcnt64(word);
+#else
+  return __builtin_popcountll(word);
+#endif
+}
+
+int64_t lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+  unsigned long bit;
+  _BitScanForward64(&bit, word);
+  return bit;
+#else
+  return __builtin_ctzll(word);
+#endif
+}
+}
+
+
+BitmapIndex::BitmapIndex(DataSet& ds, const std::vector<int64_t>& attribs) {
+  totRows_ = ds.samples_.size();
+  totWords_ = (totRows_ + WORD_BITS - 1) / WORD_BITS;
+  totClasses_ = ds.getTotClasses();
+
+  firstPos_.assign(ds.getTotAttributes(), -1);
+  attribSize_.assign(ds.getTotAttributes(), 0);
+  int64_t totPos = 0;
+  for (auto a : attribs) {
+    ErrorUtils::enforce(a >= 0 && a < ds.getTotAttributes(), "Out of bounds");
+    firstPos_[a] = totPos;
+    attribSize_[a] = ds.getAttributeSize(a);
+    totPos += attribSize_[a];
+    WorkCounters::addRows(a, totRows_);
+  }
+  valueBits_.assign(totPos * totWords_, 0);
+  classBits_.assign(totClasses_ * totWords_, 0);
+  benefit_.resize(totRows_ * totClasses_);
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, getMemoryUsage());
+
+  int64_t row = 0;
+  for (const auto& s : ds.samples_) {
+    int64_t word = row / WORD_BITS;
+    uint64_t bit = uint64_t(1) << (row % WORD_BITS);
+    for (auto a : attribs) {
+      valueBits_[(firstPos_[a] + s->inxValue_[a]) * totWords_ + word] |= bit;
+    }
+    int64_t bestClass = 0;
+    for (int64_t k = 0; k < totClasses_; k++) {
+      benefit_[row * totClasses_ + k] = s->benefit_[k];
+      if (CompareUtils::compare(s->benefit_[k], s->benefit_[bestClass]) > 0) {
+        bestClass = k;
+      }
+    }
+    if (totClasses_ > 0) {
+      classBits_[bestClass * totWords_ + word] |= bit;
+    }
+    row++;
+  }
+}
+
+
+int64_t BitmapIndex::getTotRows() {
+  return totRows_;
+}
+
+
+BitmapIndex::Bits BitmapIndex::getAllRows() {
+  Bits node(totWords_, ~uint64_t(0));
+  if (totRows_ % WORD_BITS != 0) {
+    node.back() = (uint64_t(1) << (totRows_ % WORD_BITS)) - 1;
+  }
+  return node;
+}
+
+
+BitmapIndex::Bits BitmapIndex::getSubRows(const Bits& node, int64_t attribInx, int64_t valueInx) {
+  const uint64_t* value = getValueBits(attribInx, valueInx);
+  Bits sub(totWords_);
+  for (int64_t w = 0; w < totWords_; w++) {
+    sub[w] = node[w] & value[w];
+  }
+  return sub;
+}
+
+
+int64_t BitmapIndex::count(const Bits& node) {
+  int64_t ans = 0;
+  for (int64_t w = 0; w < totWords_; w++) {
+    ans += popCount(node[w]);
+  }
+  return ans;
+}
+
+
+int64_t BitmapIndex::count(const Bits& node, int64_t attribInx, int64_t valueInx) {
+  const uint64_t* value = getValueBits(attribInx, valueInx);
+  int64_t ans = 0;
+  for (int64_t w = 0; w < totWords_; w++) {
+    ans += popCount(node[w] & value[w]);
+  }
+  return ans;
+}
+
+
+int64_t BitmapIndex::countClass(const Bits& node, int64_t attribInx, int64_t valueInx, int64_t classInx) {
+  ErrorUtils::enforce(classInx >= 0 && classInx < totClasses_, "Out of bounds");
+  const uint64_t* value = getValueBits(attribInx, valueInx);
+  const uint64_t* bestClass = &classBits_[classInx * totWords_];
+  int64_t ans = 0;
+  for (int64_t w = 0; w < totWords_; w++) {
+    ans += popCount(node[w] & value[w] & bestClass[w]);
+  }
+  return ans;
+}
+
+
+// Rows are visited in increasing order, which is the order of the samples, so
+// the sums are the ones NodeStats gets
+std::pair<int64_t, double> BitmapIndex::getBestClass(const Bits& node, int64_t attribInx, int64_t valueInx) {
+  const uint64_t* value = getValueBits(attribInx, valueInx);
+  std::vector<double> benefit(totClasses_, 0);
+  for (int64_t w = 0; w < totWords_; w++) {
+    uint64_t bits = node[w] & value[w];
+    while (bits != 0) {
+      const double* rowBenefit = &benefit_[(w * WORD_BITS + lowestBit(bits)) * totClasses_];
+      for (int64_t k = 0; k < totClasses_; k++) {
+        benefit[k] += rowBenefit[k];
+      }
+      bits &= bits - 1;
+    }
+  }
+  int64_t bestInx = 0;
+  for (int64_t k = 1; k < totClasses_; k++) {
+    if (CompareUtils::compare(benefit[k], benefit[bestInx]) > 0) {
+      bestInx = k;
+    }
+  }
+  return std::pair<int64_t, double>(bestInx, benefit[bestInx]);
+}
+
+
+int64_t BitmapIndex::getMemoryUsage() {
+  return (valueBits_.size() + classBits_.size()) * sizeof(uint64_t) + benefit_.size() * sizeof(double);
+}
+
+
+const uint64_t* BitmapIndex::getValueBits(int64_t attribInx, int64_t valueInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < firstPos_.size() && firstPos_[attribInx] >= 0,
+                      "BitmapIndex: attribute wasn't indexed.");
+  ErrorUtils::enforce(valueInx >= 0 && valueInx < attribSize_[attribInx], "Out of bounds");
+  return &valueBits_[(firstPos_[attribInx] + valueInx) * totWords_];
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module indexes the rows of a DataSet with one bitset per attribute
+// value and one per best class, over the dense value indexes of the samples.
+// A node is the bitset of its rows, so restricting it to a value is a word-wise
+// AND, and per-value row and class counts are popcounts of the ANDed words.
+// Meant for attributes of small cardinality, as it takes a bit per row and value.
+//
+
+#pragma once
+#include "DataSet.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class BitmapIndex {
+public:
+  typedef std::vector<uint64_t> Bits;
+
+  // Row r is the r-th sample of ds.samples_
+  BitmapIndex(DataSet& ds, const std::vector<int64_t>& attribs);
+
+  int64_t getTotRows();
+
+  // The node holding every row
+  Bits getAllRows();
+
+  // The rows of node with valueInx in attribInx
+  Bits getSubRows(const Bits& node, int64_t attribInx, int64_t valueInx);
+
+  int64_t count(const Bits& node);
+  int64_t count(const Bits& node, int64_t attribInx, int64_t valueInx);
+
+  // Rows of node with valueInx in attribInx whose best class is classInx,
+  // the first one on ties
+  int64_t countClass(const Bits& node, int64_t attribInx, int64_t valueInx, int64_t classInx);
+
+  // Same sums and ties as NodeStats::getBestClass(attribInx, valueInx) over
+  // the samples of node
+  std::pair<int64_t, double> getBestClass(const Bits& node, int64_t attribInx, int64_t valueInx);
+
+  int64_t getMemoryUsage();
+
+private:
+  const uint64_t* getValueBits(int64_t attribInx, int64_t valueInx);
+
+  int64_t totRows_;
+  int64_t totWords_;
+  int64_t totClasses_;
+  // The values of attribute a are positions firstPos_[a] onwards, -1 if not indexed
+  std::vector<int64_t> firstPos_;
+  std::vector<int64_t> attribSize_;
+  // totWords_ words per position, and per class
+  std::vector<uint64_t> valueBits_;
+  std::vector<uint64_t> classBits_;
+  // totClasses_ benefits per row
+  std::vector<double> benefit_;
+};
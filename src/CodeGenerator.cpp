@@ -0,0 +1,168 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "CodeGenerator.h"
+
+#include "ErrorUtils.h"
+#include "Logger.h"
+
+#include <fstream>
+#include <map>
+#include <vector>
+
+
+void CodeGenerator::writeSource(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds,
+                                std::string fileName, std::string functionName) {
+  ErrorUtils::enforce(tree != nullptr, "CodeGenerator: empty tree.");
+  std::ofstream ofs(fileName, std::ofstream::out);
+  ErrorUtils::enforce(ofs.is_open(), "CodeGenerator: can't create " + fileName);
+
+  ofs << "// Generated by PairTree, " << tree->getSize() << " nodes." << std::endl;
+  ofs << "// row holds the value index of each attribute:" << std::endl;
+  for (int64_t a = 0; a < ds.getTotAttributes(); a++) {
+    ofs << "//   row[" << a << "] " << describe(ds, a, -1) << ", "
+        << ds.getAttributeSize(a) << " values" << std::endl;
+  }
+  ofs << "// Returns the class index, or -1 for a value without a child:" << std::endl;
+  for (int64_t c = 0; c < ds.getTotClasses(); c++) {
+    ofs << "//   " << c << " " << describe(ds, -1, c) << std::endl;
+  }
+  ofs << std::endl << "#include <cstdint>" << std::endl << std::endl;
+  ofs << "int " << functionName << "(const int64_t* row) {" << std::endl;
+  writeNode(ofs, tree.get(), ds, 1);
+  ofs << "}" << std::endl;
+  ofs.close();
+  Logger::log() << "Generated " << fileName;
+}
+
+
+void CodeGenerator::writeHarness(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds,
+                                 std::string fileName, std::string functionName,
+                                 int64_t maxSamples) {
+  std::ofstream ofs(fileName, std::ofstream::out);
+  ErrorUtils::enforce(ofs.is_open(), "CodeGenerator: can't create " + fileName);
+  int64_t totAttrib = ds.getTotAttributes();
+
+  ofs << "// Generated by PairTree. Checks " << functionName
+      << " against DecisionTreeNode::classify." << std::endl << std::endl;
+  ofs << "#include <cstdint>" << std::endl << "#include <cstdio>" << std::endl << std::endl;
+  ofs << "int " << functionName << "(const int64_t* row);" << std::endl << std::endl;
+
+  // Both arrays end with a padding value so they are never empty
+  int64_t totSamples = 0;
+  std::vector<int64_t> expected;
+  ofs << "static const int64_t ROWS[] = {" << std::endl;
+  for (const auto& s : ds.samples_) {
+    if (totSamples == maxSamples) {
+      break;
+    }
+    ofs << " ";
+    for (int64_t a = 0; a < totAttrib; a++) {
+      ofs << " " << s->inxValue_[a] << ",";
+    }
+    ofs << std::endl;
+    expected.push_back(tree->classify(s));
+    totSamples++;
+  }
+  ofs << "  0 };" << std::endl << std::endl;
+  ofs << "static const int EXPECTED[] = {";
+  for (int64_t i = 0; i < expected.size(); i++) {
+    ofs << (i % 20 == 0 ? "\n  " : " ") << expected[i] << ",";
+  }
+  ofs << std::endl << "  0 };" << std::endl << std::endl;
+
+  ofs << "int main() {" << std::endl;
+  ofs << "  const int64_t totSamples = " << totSamples << ";" << std::endl;
+  ofs << "  const int64_t totAttributes = " << totAttrib << ";" << std::endl;
+  ofs << "  int64_t mismatches = 0;" << std::endl;
+  ofs << "  for (int64_t i = 0; i < totSamples; i++) {" << std::endl;
+  ofs << "    if (" << functionName << "(ROWS + i * totAttributes) != EXPECTED[i]) {" << std::endl;
+  ofs << "      mismatches++;" << std::endl;
+  ofs << "    }" << std::endl;
+  ofs << "  }" << std::endl;
+  ofs << "  printf(\"%lld of %lld samples differ\\n\", (long long)mismatches, (long long)totSamples);"
+      << std::endl;
+  ofs << "  return mismatches == 0 ? 0 : 1;" << std::endl;
+  ofs << "}" << std::endl;
+  ofs.close();
+  Logger::log() << "Generated " << fileName;
+}
+
+
+void CodeGenerator::writeNode(std::ostream& out, DecisionTreeNode* node, DataSet& ds, int64_t depth) {
+  std::string tab = indent(depth);
+  if (node->isLeaf()) {
+    out << tab << "return " << node->getLeafValue() << ";" << std::endl;
+    return;
+  }
+
+  int64_t attrib = node->getAttribCol();
+  if (node->getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+    out << tab << "if (row[" << attrib << "] <= " << node->getSeparator() << ") {  // "
+        << describe(ds, attrib, -1) << " <= " << describe(ds, attrib, node->getSeparator()) << std::endl;
+    auto left = node->children_.find(0);
+    if (left != node->children_.end() && left->second) {
+      writeNode(out, left->second.get(), ds, depth + 1);
+    } else {
+      out << indent(depth + 1) << "return -1;" << std::endl;
+    }
+    out << tab << "} else {" << std::endl;
+    auto right = node->children_.find(1);
+    if (right != node->children_.end() && right->second) {
+      writeNode(out, right->second.get(), ds, depth + 1);
+    } else {
+      out << indent(depth + 1) << "return -1;" << std::endl;
+    }
+    out << tab << "}" << std::endl;
+    return;
+  }
+
+  // Values sharing a child, as in one value versus the rest, share its code
+  std::map<DecisionTreeNode*, std::vector<int64_t>> values;
+  std::vector<DecisionTreeNode*> order;
+  for (const auto& child : node->children_) {
+    if (!child.second) {
+      continue;
+    }
+    if (values.find(child.second.get()) == values.end()) {
+      order.push_back(child.second.get());
+    }
+    values[child.second.get()].push_back(child.first);
+  }
+  out << tab << "switch (row[" << attrib << "]) {  // " << describe(ds, attrib, -1) << std::endl;
+  for (auto child : order) {
+    for (auto value : values[child]) {
+      out << tab << "case " << value << ":  // " << describe(ds, attrib, value) << std::endl;
+    }
+    writeNode(out, child, ds, depth + 1);
+  }
+  out << tab << "default:" << std::endl;
+  out << indent(depth + 1) << "return -1;" << std::endl;
+  out << tab << "}" << std::endl;
+}
+
+
+std::string CodeGenerator::indent(int64_t depth) {
+  return std::string(2 * depth, ' ');
+}
+
+
+// Attribute name, attribute value or class name, kept on a single line
+std::string CodeGenerator::describe(DataSet& ds, int64_t attribInx, int64_t valueInx) {
+  std::string ans;
+  if (attribInx < 0) {
+    ans = ds.getClassValue(valueInx);
+  } else if (valueInx < 0) {
+    ans = ds.getAttributeName(attribInx);
+  } else if (valueInx < ds.getAttributeSize(attribInx)) {
+    ans = ds.getAttributeStringValue(attribInx, valueInx);
+  } else {
+    ans = "index " + std::to_string(valueInx);
+  }
+  for (auto& c : ans) {
+    if (c == '\n' || c == '\r' || c == '\\') {
+      c = ' ';
+    }
+  }
+  return ans;
+}
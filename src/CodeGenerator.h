@@ -0,0 +1,36 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module exports a tree as a self-contained C++ source file with a
+// function "int classify(const int64_t* row)", where row holds the value
+// index of each attribute as in Sample::inxValue_. Ordered nodes become if
+// statements and nominal nodes become switch statements.
+//
+
+#pragma once
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+class CodeGenerator {
+public:
+  // Returns the same class as DecisionTreeNode::classify, -1 included
+  void writeSource(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds,
+                   std::string fileName, std::string functionName = "classify");
+
+  // Writes a main() that checks the generated function against the classes
+  // DecisionTreeNode::classify gives to the first maxSamples samples of ds.
+  // Build it together with the generated source, it returns 1 on a mismatch.
+  void writeHarness(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds,
+                    std::string fileName, std::string functionName = "classify",
+                    int64_t maxSamples = 10000);
+
+private:
+  void writeNode(std::ostream& out, DecisionTreeNode* node, DataSet& ds, int64_t depth);
+  std::string indent(int64_t depth);
+  std::string describe(DataSet& ds, int64_t attribInx, int64_t valueInx);
+};
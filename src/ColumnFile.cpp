@@ -0,0 +1,254 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "ColumnFile.h"
+
+#include "Converter.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+#include "ModelFormat.h"
+#include "Profiler.h"
+#include "ReadCSV.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+void ColumnFile::write(std::string fileName, std::string csvFileName, int64_t classColStart,
+                       DataSet& ds, int64_t blockRows) {
+  ErrorUtils::enforce(blockRows > 0, "ColumnFile: blockRows must be positive.");
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, magic(), sizeof(header.magic));
+  header.version = VERSION;
+  header.headerSize = sizeof(Header);
+  header.totAttributes = ds.getTotAttributes();
+  header.totClasses = ds.getTotClasses();
+  header.blockRows = blockRows;
+  for (int64_t a = 0; a < ds.getTotAttributes(); a++) {
+    ErrorUtils::enforce(ds.getAttributeSize(a) <= std::numeric_limits<int32_t>::max(),
+                        "ColumnFile: too many values in " + ds.getAttributeName(a));
+  }
+
+  std::ofstream ofs(fileName, std::ofstream::out | std::ofstream::binary);
+  ErrorUtils::enforce(ofs.good(), "ColumnFile: can't write " + fileName);
+  // Rewritten once the rows are counted
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  int64_t totAttrib = ds.getTotAttributes();
+  ReadCSV csvReader;
+  csvReader.open(csvFileName);
+  std::vector<std::vector<std::string>> rows;
+  std::vector<char> block;
+  int64_t first = 1;
+  while (csvReader.readChunk(rows, blockRows + first)) {
+    int64_t totRows = rows.size() - first;
+    if (totRows == 0) {
+      break;
+    }
+    Profiler::ScopedTimer timer(Profiler::SAMPLE_ENCODING);
+    block.assign(getBlockSize(header, totRows), 0);
+    int32_t* values = reinterpret_cast<int32_t*>(block.data());
+    double* benefits = reinterpret_cast<double*>(block.data() + ModelFormat::align(totAttrib * totRows * sizeof(int32_t)));
+    for (int64_t r = 0; r < totRows; r++) {
+      const auto& row = rows[first + r];
+      for (int64_t j = 0; j < totAttrib; j++) {
+        int64_t inx = -1;
+        if (ds.getAttributeType(j) == AttributeType::INTEGER) {
+          inx = ds.getValueInx(j, Converter::fromString<int64_t>(row[j]));
+        } else if (ds.getAttributeType(j) == AttributeType::DOUBLE) {
+          inx = ds.getValueInx(j, Converter::fromString<double>(row[j]));
+        } else {
+          inx = ds.getValueInx(j, row[j]);
+        }
+        ErrorUtils::enforce(inx >= 0, "ColumnFile: value " + row[j] + " isn't in the dictionary.");
+        values[j * totRows + r] = inx;
+      }
+      if (classColStart <= 0) {
+        benefits[ds.getClassInx(row[totAttrib]) * totRows + r] = -1;
+      } else {
+        for (int64_t k = classColStart; k < row.size(); k++) {
+          benefits[(k - classColStart) * totRows + r] = -Converter::fromString<double>(row[k]);
+        }
+      }
+    }
+    ofs.write(block.data(), block.size());
+    header.totRows += totRows;
+    header.totBlocks++;
+    first = 0;
+  }
+  header.fileSize = ofs.tellp();
+  ofs.seekp(0);
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  ErrorUtils::enforce(ofs.good(), "ColumnFile: can't write " + fileName);
+  Logger::log() << "Wrote " << header.totRows << " rows of " << csvFileName << " to " << fileName;
+}
+
+
+ColumnFile::ColumnFile(std::string fileName)
+  : data_(nullptr), size_(0) {
+#ifdef _WIN32
+  file_ = INVALID_HANDLE_VALUE;
+  mapping_ = nullptr;
+#else
+  fd_ = -1;
+#endif
+  map(fileName);
+  validate();
+  Logger::log() << "Mapped " << header_->totRows << " rows of " << fileName;
+}
+
+
+ColumnFile::~ColumnFile() {
+  unmap();
+}
+
+
+int64_t ColumnFile::getTotRows() {
+  return header_->totRows;
+}
+
+
+int64_t ColumnFile::getTotAttributes() {
+  return header_->totAttributes;
+}
+
+
+int64_t ColumnFile::getTotClasses() {
+  return header_->totClasses;
+}
+
+
+int64_t ColumnFile::getTotBlocks() {
+  return header_->totBlocks;
+}
+
+
+int64_t ColumnFile::getBlockFirstRow(int64_t block) {
+  return block * header_->blockRows;
+}
+
+
+int64_t ColumnFile::getBlockRows(int64_t block) {
+  ErrorUtils::enforce(block >= 0 && block < header_->totBlocks, "Out of bounds");
+  return std::min(header_->blockRows, header_->totRows - getBlockFirstRow(block));
+}
+
+
+const int32_t* ColumnFile::getValues(int64_t block, int64_t attribInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < header_->totAttributes, "Out of bounds");
+  return reinterpret_cast<const int32_t*>(getBlock(block)) + attribInx * getBlockRows(block);
+}
+
+
+const double* ColumnFile::getBenefits(int64_t block, int64_t classInx) {
+  ErrorUtils::enforce(classInx >= 0 && classInx < header_->totClasses, "Out of bounds");
+  int64_t rows = getBlockRows(block);
+  int64_t valuesSize = ModelFormat::align(header_->totAttributes * rows * sizeof(int32_t));
+  return reinterpret_cast<const double*>(getBlock(block) + valuesSize) + classInx * rows;
+}
+
+
+int64_t ColumnFile::getBlockSize(const Header& header, int64_t rows) {
+  return ModelFormat::align(header.totAttributes * rows * sizeof(int32_t))
+         + header.totClasses * rows * sizeof(double);
+}
+
+
+void ColumnFile::map(std::string fileName) {
+#ifdef _WIN32
+  file_ = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  ErrorUtils::enforce(file_ != INVALID_HANDLE_VALUE, "ColumnFile: can't open " + fileName);
+  LARGE_INTEGER size;
+  GetFileSizeEx(file_, &size);
+  size_ = size.QuadPart;
+  if (size_ > 0) {
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) {
+      data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+#else
+  fd_ = open(fileName.c_str(), O_RDONLY);
+  ErrorUtils::enforce(fd_ >= 0, "ColumnFile: can't open " + fileName);
+  struct stat info;
+  fstat(fd_, &info);
+  size_ = info.st_size;
+  if (size_ > 0) {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    data_ = (data == MAP_FAILED) ? nullptr : static_cast<const char*>(data);
+    if (data_ != nullptr) {
+      // Every pass reads the blocks in order, pages behind it can be dropped
+      madvise(data, size_, MADV_SEQUENTIAL);
+    }
+  }
+#endif
+  if (data_ == nullptr) {
+    unmap();
+    ErrorUtils::enforce(false, "ColumnFile: can't map " + fileName);
+  }
+}
+
+
+void ColumnFile::unmap() {
+#ifdef _WIN32
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_);
+  }
+  mapping_ = nullptr;
+  file_ = INVALID_HANDLE_VALUE;
+#else
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  fd_ = -1;
+#endif
+  data_ = nullptr;
+}
+
+
+void ColumnFile::validate() {
+  ErrorUtils::enforce(size_ >= sizeof(Header), "ColumnFile: file too small.");
+  header_ = reinterpret_cast<const Header*>(data_);
+  ErrorUtils::enforce(std::memcmp(header_->magic, magic(), sizeof(header_->magic)) == 0,
+                      "ColumnFile: not a column file.");
+  ErrorUtils::enforce(header_->version == VERSION,
+                      "ColumnFile: unsupported version " + std::to_string(header_->version) + ".");
+  ErrorUtils::enforce(header_->headerSize == sizeof(Header) && header_->fileSize == size_
+                      && header_->blockRows > 0 && header_->totRows >= 0,
+                      "ColumnFile: corrupted header.");
+  int64_t fullBlocks = header_->totRows / header_->blockRows;
+  int64_t lastRows = header_->totRows % header_->blockRows;
+  ErrorUtils::enforce(header_->totBlocks == fullBlocks + (lastRows > 0 ? 1 : 0)
+                      && header_->fileSize == sizeof(Header) + fullBlocks * getBlockSize(*header_, header_->blockRows)
+                                              + getBlockSize(*header_, lastRows),
+                      "ColumnFile: corrupted header.");
+}
+
+
+const char* ColumnFile::getBlock(int64_t block) {
+  ErrorUtils::enforce(block >= 0 && block < header_->totBlocks, "Out of bounds");
+  return data_ + sizeof(Header) + block * getBlockSize(*header_, header_->blockRows);
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module stores an encoded data set column by column in a binary file
+// and maps it into memory to be scanned in sequential passes, so data sets
+// larger than the memory can be trained on. The rows are cut in blocks of
+// blockRows rows. A block holds an int32 value index column per attribute,
+// padded to 8 bytes, then a double benefit column per class. Blocks follow
+// the header in row order and all values are little endian.
+//
+
+#pragma once
+#include "DataSet.h"
+
+#include <cstdint>
+#include <string>
+
+class ColumnFile {
+public:
+  static const uint32_t VERSION = 1;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int64_t fileSize;
+    int64_t totRows;
+    int64_t totAttributes;
+    int64_t totClasses;
+    int64_t blockRows;
+    int64_t totBlocks;
+  };
+
+  static const char* magic() {
+    return "PTCOLS1";
+  }
+
+  // Encodes csvFileName with the attributes and classes of ds, e.g. from
+  // DataSetBuilder::buildDictionariesFromFile, reading a block at a time.
+  // Benefits are the ones DataSetBuilder gives the samples.
+  static void write(std::string fileName, std::string csvFileName, int64_t classColStart,
+                    DataSet& ds, int64_t blockRows);
+
+  ColumnFile(std::string fileName);
+  ~ColumnFile();
+
+  ColumnFile(const ColumnFile&) = delete;
+  ColumnFile& operator=(const ColumnFile&) = delete;
+
+  int64_t getTotRows();
+  int64_t getTotAttributes();
+  int64_t getTotClasses();
+  int64_t getTotBlocks();
+
+  // Rows of block are getBlockFirstRow(block) onwards
+  int64_t getBlockFirstRow(int64_t block);
+  int64_t getBlockRows(int64_t block);
+
+  // getBlockRows(block) value indexes of attribInx, as in Sample::inxValue_
+  const int32_t* getValues(int64_t block, int64_t attribInx);
+
+  // getBlockRows(block) benefits of classInx, as in Sample::benefit_
+  const double* getBenefits(int64_t block, int64_t classInx);
+
+private:
+  static int64_t getBlockSize(const Header& header, int64_t rows);
+  void map(std::string fileName);
+  void unmap();
+  void validate();
+  const char* getBlock(int64_t block);
+
+  const char* data_;
+  int64_t size_;
+#ifdef _WIN32
+  void* file_;
+  void* mapping_;
+#else
+  int fd_;
+#endif
+  const Header* header_;
+};
@@ -3,6 +3,8 @@
 
 #include "Converter.h"
 #include "ErrorUtils.h"
+#include <cinttypes>
+#include <cstdio>
 #include <cstdlib>
 #include <sstream>
 #include <string>
@@ -33,7 +35,11 @@ int64_t Converter::fromString<int64_t>(const std::string& str) {
   //return _atoi64(str.c_str());
   int64_t n;
   char c;
+#ifdef _WIN32
   int scanned = sscanf_s(str.c_str(), "%lld%c", &n, &c);
+#else
+  int scanned = sscanf(str.c_str(), "%" SCNd64 "%c", &n, &c);
+#endif
   if (scanned == 1) {
     return n;
   }
@@ -0,0 +1,77 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "DagBuilder.h"
+
+#include "ErrorUtils.h"
+
+
+std::shared_ptr<DecisionTreeNode> DagBuilder::share(std::shared_ptr<DecisionTreeNode> tree) {
+  ErrorUtils::enforce(tree != nullptr, "DagBuilder: empty tree.");
+  nodeId_.clear();
+  keyId_.clear();
+  nodes_.clear();
+  return nodes_[shareRec(tree.get(), false)];
+}
+
+
+std::shared_ptr<ExtrasTreeNode> DagBuilder::share(std::shared_ptr<ExtrasTreeNode> tree) {
+  ErrorUtils::enforce(tree != nullptr, "DagBuilder: empty tree.");
+  nodeId_.clear();
+  keyId_.clear();
+  nodes_.clear();
+  return std::static_pointer_cast<ExtrasTreeNode>(nodes_[shareRec(tree.get(), true)]);
+}
+
+
+// Children get their ids first, so two nodes have the same key only if their
+// subtrees are identical
+int64_t DagBuilder::shareRec(DecisionTreeNode* node, bool extras) {
+  auto it = nodeId_.find(node);
+  if (it != nodeId_.end()) {
+    return it->second;
+  }
+
+  std::vector<std::pair<int64_t, int64_t>> children;
+  for (const auto& child : node->children_) {
+    if (child.second) {
+      children.push_back({ child.first, shareRec(child.second.get(), extras) });
+    }
+  }
+  long double alpha = extras ? static_cast<ExtrasTreeNode*>(node)->getAlpha() : 0;
+  int64_t numSamples = extras ? static_cast<int64_t>(static_cast<ExtrasTreeNode*>(node)->getNumSamples()) : 0;
+  Key key(static_cast<int>(node->getType()), node->getAttribCol(), node->getSeparator(),
+          node->getLeafValue(), alpha, numSamples, children);
+
+  auto found = keyId_.find(key);
+  if (found != keyId_.end()) {
+    nodeId_[node] = found->second;
+    return found->second;
+  }
+
+  std::shared_ptr<DecisionTreeNode> copy;
+  if (extras) {
+    auto extrasCopy = std::make_shared<ExtrasTreeNode>(node->getType(), node->getAttribCol(), node->getSeparator());
+    extrasCopy->setAlpha(alpha);
+    extrasCopy->setNumSamples(numSamples);
+    copy = extrasCopy;
+  } else {
+    copy = std::make_shared<DecisionTreeNode>(node->getType(), node->getAttribCol(), node->getSeparator());
+  }
+  copy->setLeafValue(node->getLeafValue());
+  for (const auto& child : children) {
+    if (node->getType() == DecisionTreeNode::NodeType::REGULAR_NOMINAL) {
+      copy->addChild(nodes_[child.second], { child.first });
+    } else if (child.first == 0) {
+      copy->addLeftChild(nodes_[child.second]);
+    } else {
+      copy->addRightChild(nodes_[child.second]);
+    }
+  }
+
+  int64_t id = nodes_.size();
+  nodes_.push_back(copy);
+  keyId_[key] = id;
+  nodeId_[node] = id;
+  return id;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module turns a tree into a decision DAG by hash consing: subtrees
+// that are structurally identical, e.g. sibling leaves of the same class
+// after pruning, become a single node referenced by every parent.
+//
+
+#pragma once
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+class DagBuilder {
+public:
+  // Returns a copy of tree where identical subtrees share their node. It
+  // classifies as tree does, and getUniqueSize counts the distinct nodes.
+  // getSize may be smaller than the tree's, as identical children of a
+  // nominal node become one.
+  std::shared_ptr<DecisionTreeNode> share(std::shared_ptr<DecisionTreeNode> tree);
+
+  // Also compares alpha and number of samples, so getTree prunes the copy as the tree
+  std::shared_ptr<ExtrasTreeNode> share(std::shared_ptr<ExtrasTreeNode> tree);
+
+private:
+  // Type, attribute, separator, leaf value, alpha, number of samples and the
+  // (value, child id) pairs
+  typedef std::tuple<int, int64_t, int64_t, int64_t, long double, int64_t,
+                     std::vector<std::pair<int64_t, int64_t>>> Key;
+
+  int64_t shareRec(DecisionTreeNode* node, bool extras);
+
+  std::map<DecisionTreeNode*, int64_t> nodeId_;
+  std::map<Key, int64_t> keyId_;
+  std::vector<std::shared_ptr<DecisionTreeNode>> nodes_;
+};
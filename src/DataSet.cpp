@@ -4,6 +4,8 @@
 #include "DataSet.h"
 
 #include "CompareUtils.h"
+#include "MemoryUsage.h"
+#include "WorkCounters.h"
 
 DataSet::DataSet() {}
 
@@ -30,6 +32,7 @@ void DataSet::setClasses(std::vector<std::string>&& classes) {
 }
 
 void DataSet::addSample(std::shared_ptr<Sample> s) {
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, MemoryUsage::listNodeBytes(sizeof(std::shared_ptr<Sample>)));
   samples_.push_back(s);
 }
 
@@ -72,6 +75,30 @@ int64_t DataSet::getValueInx(int64_t attribInx, std::string value) {
   return -1;
 }
 
+template <>
+int64_t DataSet::getValue(int64_t attribInx, int64_t valueInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < attribInfo_.size()
+                      && attribInfo_[attribInx].first == AttributeType::INTEGER,
+                      "Not an INTEGER attribute");
+  return intAttributes_[attribInfo_[attribInx].second]->getValue(valueInx);
+}
+
+template <>
+double DataSet::getValue(int64_t attribInx, int64_t valueInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < attribInfo_.size()
+                      && attribInfo_[attribInx].first == AttributeType::DOUBLE,
+                      "Not a DOUBLE attribute");
+  return doubleAttributes_[attribInfo_[attribInx].second]->getValue(valueInx);
+}
+
+template <>
+std::string DataSet::getValue(int64_t attribInx, int64_t valueInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < attribInfo_.size()
+                      && attribInfo_[attribInx].first == AttributeType::STRING,
+                      "Not a STRING attribute");
+  return stringAttributes_[attribInfo_[attribInx].second]->getValue(valueInx);
+}
+
 int64_t DataSet::getClassInx(std::string value) {
   for (int i = 0; i < classes_.size(); i++) {
     if (classes_[i].compare(value) == 0) {
@@ -118,11 +145,13 @@ int64_t DataSet::getAttributeOriginalFrequency(int64_t attribInx, int64_t valueI
 
 std::vector<long double> DataSet::getAttributeCurrentFullFrequency(int64_t attribInx) {
   std::vector<long double> freqs(getAttributeSize(attribInx), 0);
+  int64_t totWeight = 0;
   for (auto s : samples_) {
-    freqs[s->inxValue_[attribInx]]++;
+    freqs[s->inxValue_[attribInx]] += s->weight_;
+    totWeight += s->weight_;
   }
   for (int i = 0; i < getAttributeSize(attribInx); i++) {
-    freqs[i] = freqs[i] / samples_.size();
+    freqs[i] = freqs[i] / totWeight;
   }
   return freqs;
 }
@@ -172,6 +201,7 @@ void DataSet::initAllAttributes(DataSet& ds) {
 DataSet DataSet::getSubDataSet(int64_t attribInx, int64_t valueInx) {
   DataSet newDS;
   newDS.initAllAttributes(*this);
+  WorkCounters::addRows(attribInx, samples_.size());
   for (const auto& s : samples_) {
     if (s->inxValue_[attribInx] == valueInx) {
       newDS.addSample(s);
@@ -180,6 +210,28 @@ DataSet DataSet::getSubDataSet(int64_t attribInx, int64_t valueInx) {
   return newDS;
 }
 
+int64_t DataSet::getSamplesMemoryUsage() {
+  int64_t ans = 0;
+  for (const auto& s : samples_) {
+    ans += MemoryUsage::listNodeBytes(sizeof(std::shared_ptr<Sample>)) + s->getMemoryUsage();
+  }
+  return ans;
+}
+
+int64_t DataSet::getAttributeMemoryUsage(int64_t attribInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < attribInfo_.size(),
+    "Out of bounds");
+  if (attribInfo_[attribInx].first == AttributeType::INTEGER) {
+    return intAttributes_[attribInfo_[attribInx].second]->getMemoryUsage();
+  }
+  else if (attribInfo_[attribInx].first == AttributeType::DOUBLE) {
+    return doubleAttributes_[attribInfo_[attribInx].second]->getMemoryUsage();
+  }
+  else {
+    return stringAttributes_[attribInfo_[attribInx].second]->getMemoryUsage();
+  }
+}
+
 std::pair<int64_t, double> DataSet::getBestClass() {
   int64_t bestInx = 0;
   double bestScore = getClassBenefit(0);
@@ -201,6 +253,14 @@ double DataSet::getClassBenefit(int64_t classInx) {
   return ans;
 }
 
+int64_t DataSet::getTotWeight() {
+  int64_t ans = 0;
+  for (const auto& s : samples_) {
+    ans += s->weight_;
+  }
+  return ans;
+}
+
 void DataSet::printTree(std::shared_ptr<DecisionTreeNode> root,
                         std::string fileName) {
   std::ofstream ofs(fileName, std::ofstream::app);
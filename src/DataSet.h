@@ -31,6 +31,9 @@ public:
   template <typename T>
   int64_t getValueInx(int64_t attribInx, T value);
 
+  template <typename T>
+  T getValue(int64_t attribInx, int64_t valueInx);
+
   int64_t getClassInx(std::string value);
 
   int64_t getTotAttributes();
@@ -57,6 +60,14 @@ public:
 
   double getClassBenefit(int64_t classInx);
 
+  // Number of rows, counting the weight of collapsed samples
+  int64_t getTotWeight();
+
+  // Estimated bytes held by the samples list and the samples it points to
+  int64_t getSamplesMemoryUsage();
+
+  int64_t getAttributeMemoryUsage(int64_t attribInx);
+
   void printTree(std::shared_ptr<DecisionTreeNode> root,
                  std::string fileName);
 
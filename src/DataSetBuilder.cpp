@@ -6,10 +6,12 @@
 #include "Converter.h"
 #include "ErrorUtils.h"
 #include "Logger.h"
+#include "Profiler.h"
 #include "ReadCSV.h"
 
 #include <utility>
 #include <iostream>
+#include <map>
 #include <set>
 
 DataSetBuilder::DataSetBuilder() {
@@ -44,6 +46,90 @@ DataSet DataSetBuilder::buildFromFile(std::string fileName,
 }
 
 
+DataSet DataSetBuilder::buildDictionariesFromFile(std::string fileName, int64_t classColStart,
+                                                  int64_t chunkRows) {
+  ErrorUtils::enforce(chunkRows > 1, "DataSetBuilder: chunkRows must be greater than 1.");
+  ReadCSV csvReader;
+  csvReader.open(fileName);
+  std::vector<std::vector<std::string>> rows;
+  ErrorUtils::enforce(csvReader.readChunk(rows, chunkRows), "Empty file");
+
+  Logger::log() << "Started building dictionaries of file " << fileName;
+  std::vector<std::string> header = rows[0];
+  int64_t totAttrib = 0;
+  if (classColStart <= 0) {
+    totAttrib = header.size() - 1;
+  } else {
+    totAttrib = classColStart;
+  }
+
+  // Number of rows of each distinct raw value, by column
+  std::vector<std::map<std::string, int64_t>> rawValues(totAttrib);
+  std::set<std::string> classValues;
+  int64_t first = 1;
+  do {
+    Profiler::ScopedTimer timer(Profiler::DICTIONARY_BUILD);
+    for (int64_t i = first; i < rows.size(); i++) {
+      for (int64_t col = 0; col < totAttrib && col < rows[i].size(); col++) {
+        rawValues[col][rows[i][col]]++;
+      }
+      if (classColStart <= 0) {
+        classValues.insert(rows[i][rows[i].size() - 1]);
+      }
+    }
+    first = 0;
+  } while (csvReader.readChunk(rows, chunkRows));
+
+  DataSet ds;
+  for (int64_t col = 0; col < totAttrib; col++) {
+    bool isInteger = true;
+    bool isDouble = true;
+    {
+      Profiler::ScopedTimer timer(Profiler::TYPE_INFERENCE);
+      for (const auto& value : rawValues[col]) {
+        isInteger = isInteger & Converter::isInteger(value.first);
+        isDouble = isDouble & Converter::isDouble(value.first);
+      }
+    }
+    Profiler::ScopedTimer timer(Profiler::DICTIONARY_BUILD);
+    if (isInteger) {
+      std::shared_ptr<Attribute<int64_t>> attrib = std::make_shared<Attribute<int64_t>>(AttributeType::INTEGER);
+      attrib->setName(header[col]);
+      for (const auto& value : rawValues[col]) {
+        attrib->addValue(Converter::fromString<int64_t>(value.first), value.second);
+      }
+      attrib->sortIndexes();
+      ds.addAttribute<int64_t>(attrib);
+    } else if (isDouble) {
+      std::shared_ptr<Attribute<double>> attrib = std::make_shared<Attribute<double>>(AttributeType::DOUBLE);
+      attrib->setName(header[col]);
+      for (const auto& value : rawValues[col]) {
+        attrib->addValue(Converter::fromString<double>(value.first), value.second);
+      }
+      attrib->sortIndexes();
+      ds.addAttribute<double>(attrib);
+    } else {
+      std::shared_ptr<Attribute<std::string>> attrib = std::make_shared<Attribute<std::string>>(AttributeType::STRING);
+      attrib->setName(header[col]);
+      for (const auto& value : rawValues[col]) {
+        attrib->addValue(value.first, value.second);
+      }
+      attrib->sortIndexes();
+      ds.addAttribute<std::string>(attrib);
+    }
+    rawValues[col].clear();
+  }
+
+  if (classColStart <= 0) {
+    ds.setClasses(std::vector<std::string>(classValues.begin(), classValues.end()));
+  } else {
+    ds.setClasses(std::vector<std::string>(header.begin() + classColStart, header.end()));
+  }
+  Logger::log() << "Finished building dictionaries of file " << fileName;
+  return ds;
+}
+
+
 void DataSetBuilder::buildTrainTestFromFile(std::string trainFileName,
                                             std::string testFileName,
                                             int64_t classColStart,
@@ -91,8 +177,47 @@ void DataSetBuilder::buildTrainTestFromFile(std::string trainFileName,
 }
 
 
+void DataSetBuilder::collapseDuplicates(DataSet& ds, bool sameBenefits) {
+  Profiler::ScopedTimer timer(Profiler::SAMPLE_ENCODING);
+  int64_t totRows = ds.samples_.size();
+  // Position of the sample kept for each attribute tuple, and benefits per
+  // row with sameBenefits, and whether it is already a copy
+  typedef std::pair<std::vector<int64_t>, std::vector<double>> Key;
+  std::map<Key, std::pair<std::list<std::shared_ptr<Sample>>::iterator, bool>> kept;
+  auto it = ds.samples_.begin();
+  while (it != ds.samples_.end()) {
+    Key key((*it)->inxValue_, std::vector<double>());
+    if (sameBenefits) {
+      for (auto benefit : (*it)->benefit_) {
+        key.second.push_back(benefit / (*it)->weight_);
+      }
+    }
+    auto found = kept.find(key);
+    if (found == kept.end()) {
+      kept[key] = std::make_pair(it, false);
+      it++;
+      continue;
+    }
+    auto& keptSample = *found->second.first;
+    if (!found->second.second) {
+      keptSample = std::make_shared<Sample>(*keptSample);
+      found->second.second = true;
+    }
+    keptSample->weight_ += (*it)->weight_;
+    for (int64_t c = 0; c < keptSample->benefit_.size(); c++) {
+      keptSample->benefit_[c] += (*it)->benefit_[c];
+    }
+    auto next = std::next(it);
+    ds.eraseSample(it);
+    it = next;
+  }
+  Logger::log() << "Collapsed " << totRows << " rows into " << ds.samples_.size() << " samples";
+}
+
+
 void DataSetBuilder::createAttribute(int col, std::vector<std::vector<std::string>>&& rawFile, DataSet& ds) {
   auto colType = getAttributeType(col, std::forward<std::vector<std::vector<std::string>>&&>(rawFile));
+  Profiler::ScopedTimer timer(Profiler::DICTIONARY_BUILD);
   if (colType == AttributeType::INTEGER) {
     std::shared_ptr<Attribute<int64_t>> attrib = std::make_shared<Attribute<int64_t>>(AttributeType::INTEGER);
 
@@ -127,6 +252,7 @@ void DataSetBuilder::createAttribute(int col, std::vector<std::vector<std::strin
 void DataSetBuilder::createClass(int64_t colStart,
                                  std::vector<std::vector<std::string>>&& rawFile,
                                  DataSet& ds) {
+  Profiler::ScopedTimer timer(Profiler::DICTIONARY_BUILD);
   if (colStart <= 0) {
     std::set<std::string> values;
     for (int64_t i = 1; i < rawFile.size(); i++) if (rawFile[i].size() > 0) {
@@ -146,6 +272,7 @@ void DataSetBuilder::createClass(int64_t colStart,
 
 
 AttributeType DataSetBuilder::getAttributeType(int col, std::vector<std::vector<std::string>>&& rawFile) {
+  Profiler::ScopedTimer timer(Profiler::TYPE_INFERENCE);
   bool isInteger = true;
   bool isDouble = true;
   for (int i = 1; i < rawFile.size(); i++) {
@@ -167,6 +294,7 @@ AttributeType DataSetBuilder::getAttributeType(int col, std::vector<std::vector<
 
 void DataSetBuilder::createSamples(std::vector<std::vector<std::string>>&& rawFile,
                                    DataSet& ds, int64_t classColStart) {
+  Profiler::ScopedTimer timer(Profiler::SAMPLE_ENCODING);
   int64_t totAttrib = ds.getTotAttributes();
   // Create all samples
   for (int i = 1; i < rawFile.size(); i++) if (rawFile[i].size() > 0) {
@@ -13,12 +13,26 @@ public:
 
   DataSet buildFromFile(std::string fileName, int64_t classColStart);
 
+  // Streams the file chunkRows rows at a time and builds only the attributes
+  // and classes buildFromFile would, without samples. Holds one entry per
+  // distinct raw value of each column instead of the whole file.
+  DataSet buildDictionariesFromFile(std::string fileName, int64_t classColStart,
+                                    int64_t chunkRows);
+
   void buildTrainTestFromFile(std::string trainFileName,
                               std::string testFileName,
                               int64_t classColStart,
                               DataSet& trainDS,
                               DataSet& testDS);
 
+  // Merges the samples with the same attribute values into one sample whose
+  // weight_ is their number and benefit_ the sum of their benefits. The first
+  // of them keeps its place. Merged samples are new, so a DataSet sharing the
+  // original samples is left untouched. With sameBenefits only samples whose
+  // benefits per row also match are merged, so every row of a merged sample
+  // has its mean benefits, as PairTree, AodhaTree and GreedyDrawTree assume.
+  void collapseDuplicates(DataSet& ds, bool sameBenefits);
+
 private:
   void createAttribute(int col, std::vector<std::vector<std::string>>&& rawFile,
                        DataSet& ds);
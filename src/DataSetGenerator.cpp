@@ -0,0 +1,303 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "DataSetGenerator.h"
+
+#include "ErrorUtils.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+
+DataSetGenerator::Random::Random(uint64_t seed) : state_(seed) {}
+
+
+// SplitMix64. Unlike the std distributions its output is fully specified.
+uint64_t DataSetGenerator::Random::next() {
+  uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+double DataSetGenerator::Random::uniform() {
+  return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+double DataSetGenerator::Random::normal() {
+  const double PI = 3.14159265358979323846;
+  double u1 = 1.0 - uniform();
+  double u2 = uniform();
+  return std::sqrt(-2.0 * std::log(u1)) * std::cos(2 * PI * u2);
+}
+
+
+DataSetGenerator::DataSetGenerator(std::shared_ptr<ConfigGenerator> config)
+  : config_(config) {
+  ErrorUtils::enforce(config_->rows >= 0, "Generator: rows must be non negative.");
+  ErrorUtils::enforce(getTotAttributes() > 0, "Generator: at least one attribute is needed.");
+  ErrorUtils::enforce(config_->classes > 1, "Generator: at least two classes are needed.");
+  ErrorUtils::enforce(config_->costMean.size() == config_->classes
+                      && config_->costStd.size() == config_->classes,
+                      "Generator: costMean and costStd need one value per class.");
+
+  // The value distributions and the hidden rule only depend on the seed
+  Random random(config_->seed);
+  cdf_.resize(getTotAttributes());
+  weight_.resize(getTotAttributes());
+  for (int64_t a = 0; a < getTotAttributes(); a++) {
+    int64_t cardinality = getCardinality(a);
+    ErrorUtils::enforce(cardinality > 0, "Generator: cardinalities must be positive.");
+    cdf_[a].resize(cardinality);
+    double total = 0;
+    for (int64_t j = 0; j < cardinality; j++) {
+      total += 1.0 / std::pow(j + 1.0, config_->skew);
+      cdf_[a][j] = total;
+    }
+    for (int64_t j = 0; j < cardinality; j++) {
+      cdf_[a][j] /= total;
+    }
+
+    weight_[a].assign(cardinality, std::vector<double>(config_->classes, 0));
+    if (a < config_->informative) {
+      for (int64_t j = 0; j < cardinality; j++) {
+        for (int64_t c = 0; c < config_->classes; c++) {
+          weight_[a][j][c] = 2 * random.uniform() - 1;
+        }
+      }
+    }
+  }
+}
+
+
+void DataSetGenerator::writeCSV(std::string fileName) {
+  Logger::log() << "Started generating file " << fileName;
+  std::ofstream ofs(fileName, std::ofstream::out);
+  ErrorUtils::enforce(ofs.is_open(), "Generator: can't create " + fileName);
+
+  for (int64_t a = 0; a < getTotAttributes(); a++) {
+    ofs << getAttributeName(a) << ",";
+  }
+  for (int64_t c = 0; c < config_->classes; c++) {
+    ofs << "C" << c << (c + 1 < config_->classes ? "," : "\n");
+  }
+
+  // Raw values are formatted once per attribute value
+  std::vector<std::vector<std::string>> rawValues(getTotAttributes());
+  for (int64_t a = 0; a < getTotAttributes(); a++) {
+    for (int64_t j = 0; j < getCardinality(a); j++) {
+      rawValues[a].push_back(getRawValue(a, j));
+    }
+  }
+
+  Row row;
+  std::string line;
+  char buffer[32];
+  for (int64_t r = 0; r < config_->rows; r++) {
+    generateRow(r, row);
+    line.clear();
+    for (int64_t a = 0; a < getTotAttributes(); a++) {
+      line += rawValues[a][row.values[a]];
+      line += ',';
+    }
+    for (int64_t c = 0; c < config_->classes; c++) {
+      snprintf(buffer, sizeof(buffer), "%.6f", row.costs[c]);
+      line += buffer;
+      line += (c + 1 < config_->classes ? ',' : '\n');
+    }
+    ofs << line;
+  }
+  ofs.close();
+  Logger::log() << "Finished generating file " << fileName;
+}
+
+
+DataSet DataSetGenerator::build() {
+  Logger::log() << "Started generating data set in memory";
+  int64_t totAttrib = getTotAttributes();
+  std::vector<std::shared_ptr<Attribute<int64_t>>> intAttributes;
+  std::vector<std::shared_ptr<Attribute<double>>> doubleAttributes;
+  std::vector<std::shared_ptr<Attribute<std::string>>> stringAttributes;
+  for (int64_t a = 0; a < totAttrib; a++) {
+    if (getAttributeType(a) == AttributeType::INTEGER) {
+      intAttributes.push_back(std::make_shared<Attribute<int64_t>>(AttributeType::INTEGER));
+      intAttributes.back()->setName(getAttributeName(a));
+    } else if (getAttributeType(a) == AttributeType::DOUBLE) {
+      doubleAttributes.push_back(std::make_shared<Attribute<double>>(AttributeType::DOUBLE));
+      doubleAttributes.back()->setName(getAttributeName(a));
+    } else {
+      stringAttributes.push_back(std::make_shared<Attribute<std::string>>(AttributeType::STRING));
+      stringAttributes.back()->setName(getAttributeName(a));
+    }
+  }
+
+  std::vector<std::vector<std::string>> rawValues(totAttrib);
+  std::vector<std::vector<double>> rawDoubles(totAttrib);
+  for (int64_t a = 0; a < totAttrib; a++) {
+    for (int64_t j = 0; j < getCardinality(a); j++) {
+      rawValues[a].push_back(getRawValue(a, j));
+      rawDoubles[a].push_back(getAttributeType(a) == AttributeType::DOUBLE ? std::stod(rawValues[a][j]) : 0);
+    }
+  }
+
+  // Samples hold the generator value index until the dictionaries are sorted
+  std::vector<std::shared_ptr<Sample>> samples(config_->rows);
+  Row row;
+  for (int64_t r = 0; r < config_->rows; r++) {
+    generateRow(r, row);
+    samples[r] = std::make_shared<Sample>(totAttrib, config_->classes);
+    int64_t countInt = 0;
+    int64_t countDouble = 0;
+    int64_t countString = 0;
+    for (int64_t a = 0; a < totAttrib; a++) {
+      int64_t j = row.values[a];
+      samples[r]->inxValue_[a] = j;
+      if (getAttributeType(a) == AttributeType::INTEGER) {
+        intAttributes[countInt++]->addValue(j);
+      } else if (getAttributeType(a) == AttributeType::DOUBLE) {
+        doubleAttributes[countDouble++]->addValue(rawDoubles[a][j]);
+      } else {
+        stringAttributes[countString++]->addValue(rawValues[a][j]);
+      }
+    }
+    for (int64_t c = 0; c < config_->classes; c++) {
+      samples[r]->benefit_[c] = -row.costs[c];
+    }
+  }
+
+  DataSet ds;
+  std::vector<std::vector<int64_t>> remap(totAttrib);
+  int64_t countInt = 0;
+  int64_t countDouble = 0;
+  int64_t countString = 0;
+  for (int64_t a = 0; a < totAttrib; a++) {
+    remap[a].resize(getCardinality(a));
+    if (getAttributeType(a) == AttributeType::INTEGER) {
+      auto attrib = intAttributes[countInt++];
+      attrib->sortIndexes();
+      for (int64_t j = 0; j < getCardinality(a); j++) {
+        remap[a][j] = attrib->getInx(j);
+      }
+      ds.addAttribute<int64_t>(attrib);
+    } else if (getAttributeType(a) == AttributeType::DOUBLE) {
+      auto attrib = doubleAttributes[countDouble++];
+      attrib->sortIndexes();
+      for (int64_t j = 0; j < getCardinality(a); j++) {
+        remap[a][j] = attrib->getInx(rawDoubles[a][j]);
+      }
+      ds.addAttribute<double>(attrib);
+    } else {
+      auto attrib = stringAttributes[countString++];
+      attrib->sortIndexes();
+      for (int64_t j = 0; j < getCardinality(a); j++) {
+        remap[a][j] = attrib->getInx(rawValues[a][j]);
+      }
+      ds.addAttribute<std::string>(attrib);
+    }
+  }
+  std::vector<std::string> classes;
+  for (int64_t c = 0; c < config_->classes; c++) {
+    classes.push_back("C" + std::to_string(c));
+  }
+  ds.setClasses(std::move(classes));
+
+  for (auto& s : samples) {
+    for (int64_t a = 0; a < totAttrib; a++) {
+      s->inxValue_[a] = remap[a][s->inxValue_[a]];
+    }
+    ds.addSample(s);
+  }
+  Logger::log() << "Finished generating data set in memory";
+  return ds;
+}
+
+
+int64_t DataSetGenerator::getClassColStart() {
+  return getTotAttributes();
+}
+
+
+int64_t DataSetGenerator::getTotAttributes() {
+  return config_->intAttributes + config_->doubleAttributes + config_->stringAttributes;
+}
+
+
+void DataSetGenerator::generateRow(int64_t row, Row& out) {
+  Random random(config_->seed ^ (0xD1B54A32D192ED03ull * (uint64_t)(row + 1)));
+  out.values.resize(getTotAttributes());
+  out.costs.resize(config_->classes);
+
+  std::vector<double> classScore(config_->classes, 0);
+  for (int64_t a = 0; a < getTotAttributes(); a++) {
+    out.values[a] = drawValue(a, random);
+    for (int64_t c = 0; c < config_->classes; c++) {
+      classScore[c] += weight_[a][out.values[a]][c];
+    }
+  }
+  int64_t bestClass = std::max_element(classScore.begin(), classScore.end()) - classScore.begin();
+  if (random.uniform() < config_->flipRate) {
+    bestClass = random.next() % config_->classes;
+  }
+
+  for (int64_t c = 0; c < config_->classes; c++) {
+    double cost = std::abs(config_->costMean[c] + config_->costStd[c] * random.normal());
+    // Same precision written to the CSV, so both outputs hold the same data
+    cost = std::round(cost * 1e6) / 1e6;
+    out.costs[c] = (c == bestClass) ? 0 : cost;
+  }
+}
+
+
+int64_t DataSetGenerator::drawValue(int64_t attrib, Random& random) {
+  double u = random.uniform();
+  int64_t j = std::lower_bound(cdf_[attrib].begin(), cdf_[attrib].end(), u) - cdf_[attrib].begin();
+  return std::min(j, getCardinality(attrib) - 1);
+}
+
+
+int64_t DataSetGenerator::getCardinality(int64_t attrib) {
+  if (getAttributeType(attrib) == AttributeType::INTEGER) {
+    return config_->intCardinality;
+  } else if (getAttributeType(attrib) == AttributeType::DOUBLE) {
+    return config_->doubleCardinality;
+  }
+  return config_->stringCardinality;
+}
+
+
+AttributeType DataSetGenerator::getAttributeType(int64_t attrib) {
+  if (attrib < config_->intAttributes) {
+    return AttributeType::INTEGER;
+  } else if (attrib < config_->intAttributes + config_->doubleAttributes) {
+    return AttributeType::DOUBLE;
+  }
+  return AttributeType::STRING;
+}
+
+
+std::string DataSetGenerator::getAttributeName(int64_t attrib) {
+  if (getAttributeType(attrib) == AttributeType::INTEGER) {
+    return "I" + std::to_string(attrib);
+  } else if (getAttributeType(attrib) == AttributeType::DOUBLE) {
+    return "D" + std::to_string(attrib);
+  }
+  return "S" + std::to_string(attrib);
+}
+
+
+std::string DataSetGenerator::getRawValue(int64_t attrib, int64_t value) {
+  if (getAttributeType(attrib) == AttributeType::INTEGER) {
+    return std::to_string(value);
+  } else if (getAttributeType(attrib) == AttributeType::DOUBLE) {
+    // Always has a fractional part so the column is typed as DOUBLE
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.4f", value + 0.5);
+    return buffer;
+  }
+  return "v" + std::to_string(attrib) + "_" + std::to_string(value);
+}
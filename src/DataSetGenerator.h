@@ -0,0 +1,80 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module generates synthetic cost-sensitive data sets, either as a CSV
+// in the classColStart format read by DataSetBuilder or directly in memory.
+// Every row is derived only from the seed and the row number, so the output
+// is the same on every machine and can be produced in any order.
+//
+
+#pragma once
+#include "DataSet.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ConfigGenerator {
+public:
+  int64_t rows = 10000;
+  int64_t intAttributes = 2;
+  int64_t doubleAttributes = 1;
+  int64_t stringAttributes = 2;
+  int64_t intCardinality = 32;
+  int64_t doubleCardinality = 256;
+  int64_t stringCardinality = 8;
+  // Zipf exponent of the attribute values distribution. 0 is uniform.
+  double skew = 0;
+  // Number of attributes (from the first one) that define the best class
+  int64_t informative = 2;
+  // Probability of a row having a random best class
+  double flipRate = 0.1;
+  int64_t classes = 2;
+  // Cost of choosing class c when it isn't the best class ~ |N(costMean[c], costStd[c])|
+  std::vector<double> costMean = { 1, 1 };
+  std::vector<double> costStd = { 0.5, 0.5 };
+  uint64_t seed = 42;
+};
+
+class DataSetGenerator {
+public:
+  DataSetGenerator(std::shared_ptr<ConfigGenerator> config);
+
+  void writeCSV(std::string fileName);
+
+  DataSet build();
+
+  int64_t getClassColStart();
+
+  int64_t getTotAttributes();
+
+private:
+  struct Row {
+    std::vector<int64_t> values;
+    std::vector<double> costs;
+  };
+
+  class Random {
+  public:
+    Random(uint64_t seed);
+    uint64_t next();
+    double uniform();
+    double normal();
+  private:
+    uint64_t state_;
+  };
+
+  void generateRow(int64_t row, Row& out);
+  int64_t drawValue(int64_t attrib, Random& random);
+  int64_t getCardinality(int64_t attrib);
+  AttributeType getAttributeType(int64_t attrib);
+  std::string getAttributeName(int64_t attrib);
+  std::string getRawValue(int64_t attrib, int64_t value);
+
+  std::shared_ptr<ConfigGenerator> config_;
+  // cdf_[a][j] = probability of attribute 'a' assuming a value <= j
+  std::vector<std::vector<double>> cdf_;
+  // weight_[a][j][c] = contribution of value 'j' of attribute 'a' to class 'c'
+  std::vector<std::vector<std::vector<double>>> weight_;
+};
@@ -3,11 +3,16 @@
 
 #include "DecisionTreeNode.h"
 #include "ErrorUtils.h"
+#include "MemoryUsage.h"
+#include "WorkCounters.h"
 
 #include <iostream>
 
 DecisionTreeNode::DecisionTreeNode(NodeType type, int64_t attribCol, int64_t splitValue)
-  : type_(type), attribCol_(attribCol), splitValue_(splitValue), leafValue_(-1) {}
+  : type_(type), attribCol_(attribCol), splitValue_(splitValue), leafValue_(-1) {
+  WorkCounters::add(WorkCounters::NODES_CREATED);
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, sizeof(DecisionTreeNode));
+}
 
 void DecisionTreeNode::setLeafValue(int64_t leafValue) {
   leafValue_ = leafValue;
@@ -75,18 +80,12 @@ int64_t DecisionTreeNode::getSize() {
     }
     return 1 + leftSize + rightSize;
   } else {
+    // Children shared by several values are counted once
     int64_t size = 1;
-    std::map<int64_t, std::shared_ptr<DecisionTreeNode>>::iterator it, itPrev;
-    for (it = children_.begin(); it != children_.end(); it++) {
-      bool found = false;
-      for (itPrev = children_.begin(); itPrev != it; itPrev++) {
-        if (it->second == itPrev->second) {
-          found = true;
-          break;
-        }
-      }
-      if (!found) {
-        size += it->second->getSize();
+    std::set<DecisionTreeNode*> counted;
+    for (const auto& child : children_) {
+      if (counted.insert(child.second.get()).second) {
+        size += child.second->getSize();
       }
     }
     return size;
@@ -94,6 +93,47 @@ int64_t DecisionTreeNode::getSize() {
 }
 
 
+int64_t DecisionTreeNode::getUniqueSize() {
+  std::set<DecisionTreeNode*> visited;
+  return getUniqueSizeRec(visited);
+}
+
+
+int64_t DecisionTreeNode::getUniqueSizeRec(std::set<DecisionTreeNode*>& visited) {
+  if (!visited.insert(this).second) {
+    return 0;
+  }
+  int64_t size = 1;
+  for (const auto& child : children_) {
+    size += child.second->getUniqueSizeRec(visited);
+  }
+  return size;
+}
+
+
+int64_t DecisionTreeNode::getMemoryUsage(int64_t nodeBytes) {
+  std::set<DecisionTreeNode*> visited;
+  return getMemoryUsageRec(nodeBytes, visited);
+}
+
+
+int64_t DecisionTreeNode::getMemoryUsageRec(int64_t nodeBytes, std::set<DecisionTreeNode*>& visited) {
+  if (!visited.insert(this).second) {
+    return 0;
+  }
+  // make_shared keeps the two reference counters next to the node
+  int64_t ans = nodeBytes + 2 * sizeof(int64_t);
+  if (name_.capacity() > 15) {
+    ans += name_.capacity() + 1;
+  }
+  for (const auto& child : children_) {
+    ans += MemoryUsage::mapNodeBytes(sizeof(std::pair<const int64_t, std::shared_ptr<DecisionTreeNode>>));
+    ans += child.second->getMemoryUsageRec(nodeBytes, visited);
+  }
+  return ans;
+}
+
+
 void DecisionTreeNode::addChild(std::shared_ptr<DecisionTreeNode> child, std::vector<int64_t> v) {
   ErrorUtils::enforce(type_ == NodeType::REGULAR_NOMINAL,
                       "Can only add a nominal child to a REGULAR_NOMINAL node.");
@@ -130,6 +170,21 @@ int64_t DecisionTreeNode::classify(std::shared_ptr<Sample> s) {
   return next->second->classify(s);
 }
 
+
+int64_t DecisionTreeNode::classify(std::shared_ptr<Sample> s, int64_t& pathLength) {
+  pathLength++;
+  if (type_ == NodeType::LEAF) {
+    return leafValue_;
+  }
+
+  ErrorUtils::enforce(attribCol_ < s->inxValue_.size(), "Sample doesn't have the required column");
+  auto next = findChild(s->inxValue_[attribCol_]);
+  if (next == children_.end()) {
+    return -1;
+  }
+  return next->second->classify(s, pathLength);
+}
+
 bool DecisionTreeNode::isLeaf() {
   return type_ == DecisionTreeNode::NodeType::LEAF;
 }
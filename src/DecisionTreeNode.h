@@ -11,6 +11,7 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 #include <fstream>
 
@@ -42,6 +43,14 @@ public:
 
   int64_t getSize();
 
+  // Number of distinct nodes, a node reached from several parents is counted
+  // once. Smaller than getSize on trees whose subtrees are shared (DagBuilder).
+  int64_t getUniqueSize();
+
+  // Estimated bytes of the tree, counting nodeBytes per node plus the
+  // children maps. Nodes shared by several children are counted once.
+  int64_t getMemoryUsage(int64_t nodeBytes = sizeof(DecisionTreeNode));
+
   void addChild(std::shared_ptr<DecisionTreeNode> child, std::vector<int64_t> v);
 
   void addLeftChild(std::shared_ptr<DecisionTreeNode> child);
@@ -50,6 +59,9 @@ public:
 
   int64_t classify(std::shared_ptr<Sample> s);
 
+  // Also adds the number of nodes visited to pathLength
+  int64_t classify(std::shared_ptr<Sample> s, int64_t& pathLength);
+
   bool isLeaf();
 
   std::map<int64_t, std::shared_ptr<DecisionTreeNode>> children_;
@@ -57,6 +69,10 @@ public:
 protected:
   std::map<int64_t, std::shared_ptr<DecisionTreeNode>>::iterator findChild(int64_t inxValue);
 
+  int64_t getMemoryUsageRec(int64_t nodeBytes, std::set<DecisionTreeNode*>& visited);
+
+  int64_t getUniqueSizeRec(std::set<DecisionTreeNode*>& visited);
+
   std::string name_;
   NodeType type_;
   int64_t attribCol_;
@@ -5,10 +5,13 @@
 
 #include "CompareUtils.h"
 #include "ErrorUtils.h"
+#include "WorkCounters.h"
 
 
 ExtrasTreeNode::ExtrasTreeNode(NodeType type, int64_t attribCol, int64_t splitValue)
-  : DecisionTreeNode(type, attribCol, splitValue), alpha_(1), numSamples_(0) {}
+  : DecisionTreeNode(type, attribCol, splitValue), alpha_(1), numSamples_(0) {
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, sizeof(ExtrasTreeNode) - sizeof(DecisionTreeNode));
+}
 
 
 void ExtrasTreeNode::setAlpha(long double alpha) {
@@ -41,20 +44,15 @@ std::shared_ptr<DecisionTreeNode> ExtrasTreeNode::getTree(long double targetAlph
   } else {
     node = std::make_shared<DecisionTreeNode>(type_, attribCol_, splitValue_);
     if (node->getType() == NodeType::REGULAR_NOMINAL) {
-      std::map<int64_t, std::shared_ptr<DecisionTreeNode>>::iterator it, itPrev;
-      for (it = children_.begin(); it != children_.end(); it++) {
-        bool found = false;
-        for (itPrev = children_.begin(); itPrev != it; itPrev++) {
-          if (it->second == itPrev->second) {
-            found = true;
-            node->addChild(std::static_pointer_cast<ExtrasTreeNode>(node->children_[itPrev->first]), { it->first });
-            break;
-          }
-        }
-        if (!found) {
-          node->addChild(std::static_pointer_cast<ExtrasTreeNode>(it->second)->getTree(targetAlpha, minSamples),
-                         { it->first });
+      // Children shared by several values stay shared in the pruned tree
+      std::map<DecisionTreeNode*, std::shared_ptr<DecisionTreeNode>> pruned;
+      for (const auto& child : children_) {
+        auto it = pruned.find(child.second.get());
+        if (it == pruned.end()) {
+          it = pruned.insert({ child.second.get(),
+            std::static_pointer_cast<ExtrasTreeNode>(child.second)->getTree(targetAlpha, minSamples) }).first;
         }
+        node->addChild(it->second, { child.first });
       }
     } else {
       node->addLeftChild(std::static_pointer_cast<ExtrasTreeNode>(getLeftChild())->getTree(targetAlpha, minSamples));
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// Synthetic data set generator entry point.
+// Usage: PairTreeGen -out file.csv [-rows 10000] [-int 2] [-double 1] [-string 2]
+//                    [-intCard 32] [-doubleCard 256] [-stringCard 8] [-skew 0]
+//                    [-informative 2] [-flip 0.1] [-classes 2]
+//                    [-costMean 1,1] [-costStd 0.5,0.5] [-seed 42]
+// The class costs start at column (int + double + string), which is the
+// classColStart to use in the train configuration.
+//
+
+#include "DataSetGenerator.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+std::vector<double> parseList(const std::string& value) {
+  std::vector<double> ans;
+  std::stringstream ss(value);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    ans.push_back(std::stod(item));
+  }
+  return ans;
+}
+
+int main(int argc, char** argv) {
+  std::shared_ptr<ConfigGenerator> config = std::make_shared<ConfigGenerator>();
+  std::string outputFile = "";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    ErrorUtils::enforce(i + 1 < argc, "Missing value for " + arg);
+    std::string value = argv[++i];
+    if (arg == "-out") {
+      outputFile = value;
+    } else if (arg == "-rows") {
+      config->rows = std::stoll(value);
+    } else if (arg == "-int") {
+      config->intAttributes = std::stoll(value);
+    } else if (arg == "-double") {
+      config->doubleAttributes = std::stoll(value);
+    } else if (arg == "-string") {
+      config->stringAttributes = std::stoll(value);
+    } else if (arg == "-intCard") {
+      config->intCardinality = std::stoll(value);
+    } else if (arg == "-doubleCard") {
+      config->doubleCardinality = std::stoll(value);
+    } else if (arg == "-stringCard") {
+      config->stringCardinality = std::stoll(value);
+    } else if (arg == "-skew") {
+      config->skew = std::stod(value);
+    } else if (arg == "-informative") {
+      config->informative = std::stoll(value);
+    } else if (arg == "-flip") {
+      config->flipRate = std::stod(value);
+    } else if (arg == "-classes") {
+      config->classes = std::stoll(value);
+    } else if (arg == "-costMean") {
+      config->costMean = parseList(value);
+    } else if (arg == "-costStd") {
+      config->costStd = parseList(value);
+    } else if (arg == "-seed") {
+      config->seed = std::stoull(value);
+    } else {
+      ErrorUtils::enforce(false, "Unknown option " + arg);
+    }
+  }
+  ErrorUtils::enforce(outputFile != "", "Missing output file (-out).");
+
+  // A single mean or std is used for every class. The defaults have a
+  // single value for every class as well.
+  if (config->costMean.size() == 1 || config->costMean == ConfigGenerator().costMean) {
+    config->costMean.assign(config->classes, config->costMean[0]);
+  }
+  if (config->costStd.size() == 1 || config->costStd == ConfigGenerator().costStd) {
+    config->costStd.assign(config->classes, config->costStd[0]);
+  }
+
+  DataSetGenerator generator(config);
+  generator.writeCSV(outputFile);
+  Logger::log() << "classColStart = " << generator.getClassColStart() << std::endl;
+  return 0;
+}
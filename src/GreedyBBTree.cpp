@@ -3,7 +3,9 @@
 
 #include "GreedyBBTree.h"
 
+#include "BitmapIndex.h"
 #include "CompareUtils.h"
+#include "Profiler.h"
 
 
 std::shared_ptr<DecisionTreeNode> GreedyBBTree::createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) {
@@ -26,15 +28,24 @@ std::shared_ptr<DecisionTreeNode> GreedyBBTree::createTreeRec(DataSet& ds, int64
     return leaf;
   }
   auto state = initState(availableAttrib, height);
+  // Every backbone is scored on the same index, as any attribute may be in it
+  std::vector<int64_t> attribs(ds.getTotAttributes());
+  for (int64_t a = 0; a < attribs.size(); a++) {
+    attribs[a] = a;
+  }
   std::shared_ptr<DecisionTreeNode> bestBB = nullptr;
   double bestScore;
-  do {
-    auto currBB = createBB(ds, state);
-    if (bestBB == nullptr || CompareUtils::compare(bestScore, currBB.second) < 0) {
-      bestBB = currBB.first;
-      bestScore = currBB.second;
-    }
-  } while (nextState(ds, state));
+  {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    BitmapIndex index(ds, attribs);
+    do {
+      auto currBB = createBB(ds, index, state);
+      if (bestBB == nullptr || CompareUtils::compare(bestScore, currBB.second) < 0) {
+        bestBB = currBB.first;
+        bestScore = currBB.second;
+      }
+    } while (nextState(ds, state));
+  }
 
   std::shared_ptr<DecisionTreeNode> root = bestBB;
   auto node = root;
@@ -45,8 +56,8 @@ std::shared_ptr<DecisionTreeNode> GreedyBBTree::createTreeRec(DataSet& ds, int64
     std::pair<std::shared_ptr<DecisionTreeNode>, int64_t> next = std::make_pair(nullptr, -1);
     for (auto&& child : node->children_) {
       if (child.second->isLeaf()) {
-        child.second = createTreeRec(currDS.getSubDataSet(node->getAttribCol(), child.first),
-                                      height - count - 1, availableAttrib);
+        DataSet childDS = currDS.getSubDataSet(node->getAttribCol(), child.first);
+        child.second = createTreeRec(childDS, height - count - 1, availableAttrib);
       }
       else {
         next = std::make_pair(child.second, child.first);
@@ -113,22 +124,22 @@ bool GreedyBBTree::nextState(DataSet& ds,
 }
 
 
-std::pair<std::shared_ptr<DecisionTreeNode>, double> GreedyBBTree::createBB(DataSet& ds,
+std::pair<std::shared_ptr<DecisionTreeNode>, double> GreedyBBTree::createBB(DataSet& ds, BitmapIndex& index,
                                                          const std::vector<std::pair<int64_t, int64_t>>& state) {
   std::shared_ptr<DecisionTreeNode> root = nullptr;
   double finalScore = 0;
   
-  DataSet currDS = ds;
+  BitmapIndex::Bits node = index.getAllRows();
   std::shared_ptr<DecisionTreeNode> prev = nullptr;
   for (int i = 0; i < state.size(); i++) {
     std::shared_ptr<DecisionTreeNode> curr =
       std::make_shared<DecisionTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL,
                                          state[i].first);
-    for (int j = 0; j < currDS.getAttributeSize(state[i].first); j++) {
+    for (int j = 0; j < ds.getAttributeSize(state[i].first); j++) {
       if (j != state[i].second || i == state.size() - 1) {
         std::shared_ptr<DecisionTreeNode> leaf =
           std::make_shared<DecisionTreeNode>(DecisionTreeNode::NodeType::LEAF);
-        std::pair<int64_t, double> bestClass = currDS.getSubDataSet(state[i].first, j).getBestClass();
+        std::pair<int64_t, double> bestClass = index.getBestClass(node, state[i].first, j);
         finalScore += bestClass.second;
         leaf->setLeafValue(bestClass.first);
         curr->addChild(leaf, { j });
@@ -142,7 +153,7 @@ std::pair<std::shared_ptr<DecisionTreeNode>, double> GreedyBBTree::createBB(Data
       prev->addChild(curr, {state[i-1].second});
     }
     prev = curr;
-    currDS = currDS.getSubDataSet(state[i].first, state[i].second);
+    node = index.getSubRows(node, state[i].first, state[i].second);
   }
 
   return std::make_pair(root, finalScore);
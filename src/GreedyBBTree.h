@@ -2,6 +2,7 @@
 // License: BSD 3 clause
 
 #pragma once
+#include "BitmapIndex.h"
 #include "ConfigTree.h"
 #include "DataSet.h"
 #include "DecisionTreeNode.h"
@@ -19,6 +20,7 @@ public:
 private:
   std::shared_ptr<DecisionTreeNode> createTreeRec(DataSet& ds, int64_t height, std::vector<bool> availableAttrib);
   bool nextState(DataSet& ds, std::vector<std::pair<int64_t, int64_t>>& state);
-  std::pair<std::shared_ptr<DecisionTreeNode>, double> createBB(DataSet& ds, const std::vector<std::pair<int64_t, int64_t>>& state);
+  std::pair<std::shared_ptr<DecisionTreeNode>, double> createBB(DataSet& ds, BitmapIndex& index,
+                                                                const std::vector<std::pair<int64_t, int64_t>>& state);
   std::vector<std::pair<int64_t, int64_t>> initState(std::vector<bool> availableAttrib, int64_t height);
 };
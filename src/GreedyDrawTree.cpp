@@ -4,6 +4,9 @@
 #include "GreedyDrawTree.h"
 
 #include "CompareUtils.h"
+#include "HardwareCounters.h"
+#include "NodeStats.h"
+#include "Profiler.h"
 
 #include <random>
 
@@ -30,21 +33,37 @@ std::shared_ptr<DecisionTreeNode> GreedyDrawTree::createTreeRec(DataSet& ds, int
                                                                 std::vector<bool> availableAttrib) {
   ErrorUtils::enforce(ds.getTotClasses() > 0, "Invalid data set.");
 
-  if (height == 0 || (minLeaf > 0 && ds.samples_.size() <= minLeaf)) {
-    return createLeaf(ds);
+  if (height == 0 || (minLeaf > 0 && ds.getTotWeight() <= minLeaf)) {
+    return createLeaf(ds.getBestClass().first);
+  }
+
+  std::vector<int64_t> attribs;
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    if (availableAttrib[i]) {
+      attribs.push_back(i);
+    }
+  }
+  std::unique_ptr<NodeStats> stats;
+  {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    stats.reset(new NodeStats(ds, attribs));
   }
 
   int64_t bestAttrib = -1;
   for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, attribOrder_[i]);
     if (availableAttrib[attribOrder_[i]]
-        && isGoodAttribute(ds, attribOrder_[i], totDraws)) {
+        && isGoodAttribute(ds, *stats, attribOrder_[i], totDraws)) {
       bestAttrib = attribOrder_[i];
       break;
     }
   }
+  int64_t bestClass = stats->getBestClass().first;
+  // The children get their own statistics
+  stats.reset();
   // There are no good attributes left
   if (bestAttrib == -1) {
-    return createLeaf(ds);
+    return createLeaf(bestClass);
   }
   availableAttrib[bestAttrib] = false;
 
@@ -53,8 +72,12 @@ std::shared_ptr<DecisionTreeNode> GreedyDrawTree::createTreeRec(DataSet& ds, int
   for (int64_t i = 0; i < bestAttribSize; i++) {
     allDS[i].initAllAttributes(ds);
   }
-  for (const auto& s : ds.samples_) {
-    allDS[s->inxValue_[bestAttrib]].addSample(s);
+  {
+    Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+    HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+    for (const auto& s : ds.samples_) {
+      allDS[s->inxValue_[bestAttrib]].addSample(s);
+    }
   }
 
   std::shared_ptr<DecisionTreeNode> node = std::make_shared<DecisionTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL,
@@ -66,15 +89,15 @@ std::shared_ptr<DecisionTreeNode> GreedyDrawTree::createTreeRec(DataSet& ds, int
 }
 
 
-bool GreedyDrawTree::isGoodAttribute(DataSet& ds, int64_t attribInx, int totDraws) {
+bool GreedyDrawTree::isGoodAttribute(DataSet& ds, NodeStats& stats, int64_t attribInx, int totDraws) {
   double attribScore = 0;
   for (int64_t i = 0; i < ds.getAttributeSize(attribInx); i++) {
-    auto bestClass = ds.getSubDataSet(attribInx, i).getBestClass();
+    auto bestClass = stats.getBestClass(attribInx, i);
     attribScore += bestClass.second;
   }
 
   for (int i = 0; i < totDraws; i++) {
-    double score = getRandomAttribute(ds, attribInx);
+    double score = getRandomAttribute(ds, stats, attribInx);
     if (CompareUtils::compare(attribScore, score) <= 0) {
       return false;
     }
@@ -83,19 +106,19 @@ bool GreedyDrawTree::isGoodAttribute(DataSet& ds, int64_t attribInx, int totDraw
 }
 
 
-double GreedyDrawTree::getRandomAttribute(DataSet& ds, int64_t attribInx) {
+double GreedyDrawTree::getRandomAttribute(DataSet& ds, NodeStats& stats, int64_t attribInx) {
   // distrib[i] = number of samples valued 'i' for this attribute
   std::vector<int64_t> distrib(ds.getAttributeSize(attribInx), 0);
-  for (auto s : ds.samples_) {
-    distrib[s->inxValue_[attribInx]]++;
+  for (int64_t i = 0; i < distrib.size(); i++) {
+    distrib[i] = stats.getTotWeight(attribInx, i);
   }
 
-  // Copies the samples to a vector. This is needed to run the shuffling
-  std::vector<std::shared_ptr<Sample>> samplesShuffle(ds.samples_.size());
-  auto it = ds.samples_.begin();
-  for (int64_t i = 0; i < samplesShuffle.size(); i++) {
-    samplesShuffle[i] = *it;
-    it++;
+  // Copies the samples to a vector, a sample of weight w once per row. This is
+  // needed to run the shuffling
+  std::vector<std::shared_ptr<Sample>> samplesShuffle;
+  samplesShuffle.reserve(stats.getTotWeight());
+  for (const auto& s : ds.samples_) {
+    samplesShuffle.insert(samplesShuffle.end(), s->weight_, s);
   }
   std::random_device rd;
   std::mt19937 gen(rd());
@@ -108,7 +131,7 @@ double GreedyDrawTree::getRandomAttribute(DataSet& ds, int64_t attribInx) {
     std::vector<double> classBenefit(ds.getTotClasses(), 0);
     for (int64_t i = 0; i < distrib[j]; i++) {
       for (int k = 0; k < ds.getTotClasses(); k++) {
-        classBenefit[k] += samplesShuffle[sInx]->benefit_[k];
+        classBenefit[k] += samplesShuffle[sInx]->benefit_[k] / samplesShuffle[sInx]->weight_;
       }
       sInx++;
     }
@@ -123,12 +146,12 @@ double GreedyDrawTree::getRandomAttribute(DataSet& ds, int64_t attribInx) {
   return score;
 }
 
-std::shared_ptr<DecisionTreeNode> GreedyDrawTree::createLeaf(DataSet& ds) {
-  auto best = ds.getBestClass();
+std::shared_ptr<DecisionTreeNode> GreedyDrawTree::createLeaf(int64_t leafValue) {
+  Profiler::ScopedTimer timer(Profiler::LEAF_CREATION);
 
   std::shared_ptr<DecisionTreeNode> leaf = std::make_shared<DecisionTreeNode>(DecisionTreeNode::NodeType::LEAF);
-  leaf->setName("LEAF " + std::to_string(best.first));
-  leaf->setLeafValue(best.first);
+  leaf->setName("LEAF " + std::to_string(leafValue));
+  leaf->setLeafValue(leafValue);
 
   return leaf;
 }
@@ -4,6 +4,7 @@
 #pragma once
 #include "ConfigTree.h"
 #include "DataSet.h"
+#include "NodeStats.h"
 #include "Tree.h"
 
 #include <vector>
@@ -22,9 +23,9 @@ private:
   std::shared_ptr<DecisionTreeNode> createTreeRec(DataSet& ds, int64_t height,
                                                   int totDraws, int64_t minLeaf,
                                                   std::vector<bool> availableAttrib);
-  bool isGoodAttribute(DataSet& ds, int64_t attribInx, int totDraws);
-  double getRandomAttribute(DataSet& ds, int64_t attribInx);
-  std::shared_ptr<DecisionTreeNode> createLeaf(DataSet& ds);
+  bool isGoodAttribute(DataSet& ds, NodeStats& stats, int64_t attribInx, int totDraws);
+  double getRandomAttribute(DataSet& ds, NodeStats& stats, int64_t attribInx);
+  std::shared_ptr<DecisionTreeNode> createLeaf(int64_t leafValue);
 
   // Order the attributes by smallest branching factor first
   std::vector<int64_t> attribOrder_;
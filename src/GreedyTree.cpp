@@ -3,9 +3,16 @@
 
 #include "GreedyTree.h"
 
+#include "BestFirstTree.h"
 #include "CompareUtils.h"
 #include "ErrorUtils.h"
+#include "HardwareCounters.h"
+#include "LevelWiseTree.h"
 #include "Logger.h"
+#include "NodeStats.h"
+#include "ParallelSplitSearch.h"
+#include "Profiler.h"
+#include "WorkCounters.h"
 #include "ExtrasTreeNode.h"
 
 #include <string>
@@ -15,26 +22,59 @@ GreedyTree::GreedyTree() {}
 std::shared_ptr<DecisionTreeNode> GreedyTree::createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) {
   ErrorUtils::enforce(ds.getTotClasses() == 2, "Error! Number of classes must be 2.");
   std::shared_ptr<ConfigGreedy> config = std::static_pointer_cast<ConfigGreedy>(c);
-  std::vector<bool> availableAttrib(ds.getTotAttributes(), true);
+  if (config->levelWise) {
+    return LevelWiseTree().createTree(ds, c);
+  }
+  nominalAttribs_.clear();
+  allAttribs_.clear();
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    if (ds.getAttributeType(i) == AttributeType::STRING) {
+      nominalAttribs_.push_back(i);
+    }
+    allAttribs_.push_back(i);
+  }
+  threads_ = config->threads;
+  parallelRows_ = config->parallelRows;
+  if (config->maxLeaves > 0 || config->maxSeconds > 0) {
+    return BestFirstTree(config->maxLeaves, config->maxSeconds).createTree(ds, config->height,
+      [&](DataSet& nodeDS, int64_t height) {
+        return createTreeRec(nodeDS, height, config->minLeaf, config->percentiles,
+                             config->minGain, config->useNominalBinary, config->useNominalOrdered);
+      });
+  }
   return createTreeRec(ds, config->height, config->minLeaf, config->percentiles,
-                       config->minGain, config->useNominalBinary);
+                       config->minGain, config->useNominalBinary, config->useNominalOrdered);
 }
 
 std::shared_ptr<DecisionTreeNode> GreedyTree::createTreeRec(DataSet& ds, int64_t height, int64_t minLeaf,
                                                             int64_t percentiles, double minGain,
-                                                            bool useNominalBinary) {
+                                                            bool useNominalBinary, bool useNominalOrdered) {
   ErrorUtils::enforce(ds.getTotClasses() > 0, "Invalid data set.");
 
-  if (height == 0 || (minLeaf > 0 && ds.samples_.size() <= minLeaf)
-      || isAllSameClass(ds)) {
-    return createLeaf(ds);
+  if (height == 0 || (minLeaf > 0 && ds.getTotWeight() <= minLeaf)) {
+    return createLeaf(ds.getBestClass().first);
+  }
+  std::unique_ptr<NodeStats> stats;
+  {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    if (threads_ != 1 && ds.samples_.size() >= parallelRows_) {
+      stats = ParallelSplitSearch(threads_).createStats(ds, allAttribs_);
+    } else {
+      stats.reset(new NodeStats(ds, nominalAttribs_));
+    }
+  }
+  auto bestClass = stats->getBestClass();
+  int64_t totWeight = stats->getTotWeight();
+  if (stats->isAllSameClass()) {
+    return createLeaf(bestClass.first);
   }
 
   int64_t bestAttrib = -1;
-  long double bestScore = ds.getBestClass().second;
+  long double bestScore = bestClass.second;
   int64_t bestSeparator = -1;
   for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
-    auto attrib = getAttribScore(ds, i, percentiles, useNominalBinary);
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, i);
+    auto attrib = getAttribScore(ds, *stats, i, percentiles, useNominalBinary, useNominalOrdered);
     long double score = attrib.first;
     int64_t separator = attrib.second;
     if (CompareUtils::compare(score, bestScore) > 0) {
@@ -43,9 +83,22 @@ std::shared_ptr<DecisionTreeNode> GreedyTree::createTreeRec(DataSet& ds, int64_t
       bestSeparator = separator;
     }
   }
-  long double bestGain = calcGain(ds, bestScore);
+  long double bestGain = calcGain(bestClass.second, bestScore);
+  // Values going to the first child of a nominal split in two
+  std::vector<int64_t> leftValues;
+  if (bestAttrib != -1 && bestSeparator != -1 && ds.getAttributeType(bestAttrib) == AttributeType::STRING) {
+    if (useNominalOrdered) {
+      std::vector<int64_t> order = stats->getValueOrder(bestAttrib);
+      leftValues.assign(order.begin(), order.begin() + bestSeparator + 1);
+      std::sort(leftValues.begin(), leftValues.end());
+    } else {
+      leftValues.push_back(bestSeparator);
+    }
+  }
+  // The children get their own statistics
+  stats.reset();
   if (bestAttrib == -1 || CompareUtils::compare(bestGain, minGain) < 0) {
-    return createLeaf(ds);
+    return createLeaf(bestClass.first);
   }
 
   if (bestSeparator == -1) {
@@ -54,106 +107,114 @@ std::shared_ptr<DecisionTreeNode> GreedyTree::createTreeRec(DataSet& ds, int64_t
     for (int64_t i = 0; i < bestAttribSize; i++) {
       allDS[i].initAllAttributes(ds);
     }
-    for (const auto& s : ds.samples_) {
-      allDS[s->inxValue_[bestAttrib]].addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        allDS[s->inxValue_[bestAttrib]].addSample(s);
+      }
     }
 
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL,
       bestAttrib);
     node->setAlpha(1 - bestGain);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(totWeight);
+    node->setLeafValue(bestClass.first);
     for (int64_t j = 0; j < bestAttribSize; j++) {
-      node->addChild(createTreeRec(allDS[j], height - 1, minLeaf, percentiles, minGain, useNominalBinary), { j });
+      node->addChild(createTreeRec(allDS[j], height - 1, minLeaf, percentiles, minGain, useNominalBinary, useNominalOrdered), { j });
     }
     return node;
 
-  // Nominal attribute separating one value from the rest
+  // Nominal attribute separating leftValues from the rest
   } else if(bestSeparator != -1 && ds.getAttributeType(bestAttrib) == AttributeType::STRING) {
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, bestAttrib);
     node->setAlpha(1 - bestGain);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(totWeight);
+    node->setLeafValue(bestClass.first);
 
+    std::vector<bool> isLeft(ds.getAttributeSize(bestAttrib), false);
+    for (auto j : leftValues) {
+      isLeft[j] = true;
+    }
     DataSet leftDS, rightDS;
     leftDS.initAllAttributes(ds);
     rightDS.initAllAttributes(ds);
-    for (const auto& s : ds.samples_) {
-      if (s->inxValue_[bestAttrib] == bestSeparator) {
-        leftDS.addSample(s);
-      }
-      else {
-        rightDS.addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        if (isLeft[s->inxValue_[bestAttrib]]) {
+          leftDS.addSample(s);
+        }
+        else {
+          rightDS.addSample(s);
+        }
       }
     }
 
-    node->addChild(createTreeRec(leftDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary), { bestSeparator });
+    node->addChild(createTreeRec(leftDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary, useNominalOrdered), leftValues);
     std::vector<int64_t> rightInxs;
     for (int64_t i = 0; i < ds.getAttributeSize(bestAttrib); i++) {
-      if (i != bestSeparator) rightInxs.push_back(i);
+      if (!isLeft[i]) rightInxs.push_back(i);
     }
-    node->addChild(createTreeRec(rightDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary), rightInxs);
+    node->addChild(createTreeRec(rightDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary, useNominalOrdered), rightInxs);
 
     return node;
 
   } else {
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_ORDERED, bestAttrib, bestSeparator);
     node->setAlpha(1 - bestGain);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(totWeight);
+    node->setLeafValue(bestClass.first);
     DataSet leftDS, rightDS;
     leftDS.initAllAttributes(ds);
     rightDS.initAllAttributes(ds);
-    for (const auto& s : ds.samples_) {
-      if (s->inxValue_[bestAttrib] <= bestSeparator) {
-        leftDS.addSample(s);
-      }
-      else {
-        rightDS.addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        if (s->inxValue_[bestAttrib] <= bestSeparator) {
+          leftDS.addSample(s);
+        }
+        else {
+          rightDS.addSample(s);
+        }
       }
     }
-    node->addLeftChild(createTreeRec(leftDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary));
-    node->addRightChild(createTreeRec(rightDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary));
+    node->addLeftChild(createTreeRec(leftDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary, useNominalOrdered));
+    node->addRightChild(createTreeRec(rightDS, height - 1, minLeaf, percentiles, minGain, useNominalBinary, useNominalOrdered));
     return node;
   }
 }
 
 
-bool GreedyTree::isAllSameClass(DataSet& ds) {
-  int64_t tot0 = 0;
-  int64_t tot1 = 0;
-  for (auto s : ds.samples_) {
-    if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) >= 0) {
-      tot0++;
-    }
-    else {
-      tot1++;
-    }
-    if (tot0 > 0 && tot1 > 0) return false;
-  }
-  return tot0 == 0 || tot1 == 0;
-}
-
-
-std::pair<long double, int64_t> GreedyTree::getAttribScore(DataSet& ds, int64_t attribInx,
-                                                           int64_t percentiles, bool useNominalBinary) {
+std::pair<long double, int64_t> GreedyTree::getAttribScore(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                           int64_t percentiles, bool useNominalBinary,
+                                                           bool useNominalOrdered) {
   if (ds.getAttributeType(attribInx) == AttributeType::STRING) {
-    return getNominalScore(ds, attribInx, useNominalBinary);
+    return getNominalScore(ds, stats, attribInx, useNominalBinary, useNominalOrdered);
+  } else if (stats.isCollected(attribInx)) {
+    return getHistogramScore(ds, stats, attribInx, percentiles);
   } else {
     return getOrderedScore(ds, attribInx, percentiles);
   }
 }
 
 
-std::pair<long double, int64_t> GreedyTree::getNominalScore(DataSet& ds, int64_t attribInx, bool useNominalBinary) {
+std::pair<long double, int64_t> GreedyTree::getNominalScore(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                            bool useNominalBinary, bool useNominalOrdered) {
+  if (useNominalOrdered) {
+    return getNominalOrderedScore(stats, attribInx);
+  }
   long double score = 0;
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, useNominalBinary ? ds.getAttributeSize(attribInx) : 1);
 
   if (useNominalBinary) {
     std::vector<std::vector<long double>> subClassScore(ds.getAttributeSize(attribInx),
                                                         std::vector<long double>(2, 0));
     for (int64_t j = 0; j < ds.getAttributeSize(attribInx); j++) {
-      subClassScore[j][0] = ds.getSubDataSet(attribInx, j).getClassBenefit(0);
-      subClassScore[j][1] = ds.getSubDataSet(attribInx, j).getClassBenefit(1);
+      subClassScore[j][0] = stats.getClassBenefit(attribInx, j, 0);
+      subClassScore[j][1] = stats.getClassBenefit(attribInx, j, 1);
     }
 
     long double sumClass0 = 0;
@@ -179,7 +240,7 @@ std::pair<long double, int64_t> GreedyTree::getNominalScore(DataSet& ds, int64_t
   }
   else {
     for (int64_t j = 0; j < ds.getAttributeSize(attribInx); j++) {
-      auto best = ds.getSubDataSet(attribInx, j).getBestClass();
+      auto best = stats.getBestClass(attribInx, j);
       score += best.second;
     }
     return std::pair<long double, int64_t>(score, -1);
@@ -187,6 +248,39 @@ std::pair<long double, int64_t> GreedyTree::getNominalScore(DataSet& ds, int64_t
 }
 
 
+// The values sorted by NodeStats::getValueOrder are swept as getOrderedScore
+// sweeps an ordered attribute, a value at a time. The separator is the last
+// position of the order going to the left.
+std::pair<long double, int64_t> GreedyTree::getNominalOrderedScore(NodeStats& stats, int64_t attribInx) {
+  std::vector<int64_t> order = stats.getValueOrder(attribInx);
+  long double leftScore[2] = { 0 };
+  long double rightScore[2] = { 0 };
+  for (auto j : order) {
+    rightScore[0] += stats.getClassBenefit(attribInx, j, 0);
+    rightScore[1] += stats.getClassBenefit(attribInx, j, 1);
+  }
+
+  long double bestScore = std::max(rightScore[0], rightScore[1]);
+  int64_t bestSeparator = order.size() - 1;
+  int64_t totCandidates = 0;
+  // Values without samples are last and don't move the sums
+  for (int64_t p = 0; p + 1 < order.size() && stats.getTotWeight(attribInx, order[p + 1]) > 0; p++) {
+    totCandidates++;
+    leftScore[0] += stats.getClassBenefit(attribInx, order[p], 0);
+    leftScore[1] += stats.getClassBenefit(attribInx, order[p], 1);
+    rightScore[0] -= stats.getClassBenefit(attribInx, order[p], 0);
+    rightScore[1] -= stats.getClassBenefit(attribInx, order[p], 1);
+    long double score = std::max(leftScore[0], leftScore[1]) + std::max(rightScore[0], rightScore[1]);
+    if (CompareUtils::compare(bestScore, score) < 0) {
+      bestScore = score;
+      bestSeparator = p;
+    }
+  }
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
+  return std::make_pair(bestScore, bestSeparator);
+}
+
+
 std::pair<long double, int64_t> GreedyTree::getOrderedScore(DataSet& ds, int64_t attribInx,
                                                             int64_t percentiles) {
   // Order attributes in asceding order according to this attribute
@@ -195,11 +289,16 @@ std::pair<long double, int64_t> GreedyTree::getOrderedScore(DataSet& ds, int64_t
     double benefit[2];
   };
   std::vector<Order> ord(ds.samples_.size());
+  WorkCounters::addRows(attribInx, ds.samples_.size());
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, ord.size() * sizeof(Order));
+  long double rightScore[2] = { 0 }; // Benefit of all samples to the right
   int64_t count = 0;
   for (auto s : ds.samples_) {
     ord[count].attribValue = s->inxValue_[attribInx];
     ord[count].benefit[0] = s->benefit_[0];
     ord[count].benefit[1] = s->benefit_[1];
+    rightScore[0] += s->benefit_[0];
+    rightScore[1] += s->benefit_[1];
     count++;
   }
   std::sort(ord.begin(), ord.end(),
@@ -207,16 +306,13 @@ std::pair<long double, int64_t> GreedyTree::getOrderedScore(DataSet& ds, int64_t
 
   // Try all possible percentiles
   int64_t step = std::max(1.0, ds.getAttributeSize(attribInx) / (double)percentiles);
-  long double rightScore[2] = { 0 }; // Benefit of all samples to the right
-  for (auto s : ds.samples_) {
-    rightScore[0] += s->benefit_[0];
-    rightScore[1] += s->benefit_[1];
-  }
   long double leftScore[2] = { 0 }; // Benefit of all samples to the left
   long double bestScore = std::max(rightScore[0], rightScore[1]);
   int64_t bestSeparator = ds.getAttributeSize(attribInx) - 1;
   int64_t limit = 0; // First element to the right
+  int64_t totCandidates = 0;
   while (limit < ord.size()) {
+    totCandidates++;
     if (CompareUtils::compare(bestScore, std::max(leftScore[0], leftScore[1])
                                          + std::max(rightScore[0], rightScore[1])) < 0) {
       bestScore = std::max(leftScore[0], leftScore[1])
@@ -233,24 +329,66 @@ std::pair<long double, int64_t> GreedyTree::getOrderedScore(DataSet& ds, int64_t
       limit++;
     }
   }
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
   return std::make_pair(bestScore, bestSeparator-1);
 }
 
 
-std::shared_ptr<DecisionTreeNode> GreedyTree::createLeaf(DataSet& ds) {
-  auto best = ds.getBestClass();
+// Same candidates as getOrderedScore, a value of the histogram
+// standing for its samples
+std::pair<long double, int64_t> GreedyTree::getHistogramScore(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                              int64_t percentiles) {
+  int64_t attribSize = ds.getAttributeSize(attribInx);
+  long double rightScore[2] = { 0 };
+  for (int64_t j = 0; j < attribSize; j++) {
+    rightScore[0] += stats.getClassBenefit(attribInx, j, 0);
+    rightScore[1] += stats.getClassBenefit(attribInx, j, 1);
+  }
+
+  int64_t step = std::max(1.0, attribSize / (double)percentiles);
+  long double leftScore[2] = { 0 };
+  long double bestScore = std::max(rightScore[0], rightScore[1]);
+  int64_t bestSeparator = attribSize - 1;
+  int64_t totCandidates = 0;
+  // First value with samples to the right
+  int64_t limit = 0;
+  while (limit < attribSize && stats.getTotWeight(attribInx, limit) == 0) limit++;
+  while (limit < attribSize) {
+    totCandidates++;
+    if (CompareUtils::compare(bestScore, std::max(leftScore[0], leftScore[1])
+                                         + std::max(rightScore[0], rightScore[1])) < 0) {
+      bestScore = std::max(leftScore[0], leftScore[1])
+                  + std::max(rightScore[0], rightScore[1]);
+      bestSeparator = limit;
+    }
+
+    int64_t nextLimit = limit + step;
+    while (limit < attribSize && (limit < nextLimit || stats.getTotWeight(attribInx, limit) == 0)) {
+      leftScore[0] += stats.getClassBenefit(attribInx, limit, 0);
+      leftScore[1] += stats.getClassBenefit(attribInx, limit, 1);
+      rightScore[0] -= stats.getClassBenefit(attribInx, limit, 0);
+      rightScore[1] -= stats.getClassBenefit(attribInx, limit, 1);
+      limit++;
+    }
+  }
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
+  return std::make_pair(bestScore, bestSeparator - 1);
+}
+
+
+std::shared_ptr<DecisionTreeNode> GreedyTree::createLeaf(int64_t leafValue) {
+  Profiler::ScopedTimer timer(Profiler::LEAF_CREATION);
 
   std::shared_ptr<DecisionTreeNode> leaf = std::make_shared<DecisionTreeNode>(DecisionTreeNode::NodeType::LEAF);
-  leaf->setName("LEAF " + std::to_string(best.first));
-  leaf->setLeafValue(best.first);
+  leaf->setName("LEAF " + std::to_string(leafValue));
+  leaf->setLeafValue(leafValue);
 
   return leaf;
 }
 
 
-long double GreedyTree::calcGain(DataSet& ds, long double score) {
-  auto bestClass = ds.getBestClass();
-  if (CompareUtils::compare(bestClass.second, 0) == 0) return 0;
+long double GreedyTree::calcGain(double leafScore, long double score) {
+  if (CompareUtils::compare(leafScore, 0) == 0) return 0;
 
-  return (score - bestClass.second) / std::abs(bestClass.second);
+  return (score - leafScore) / std::abs(leafScore);
 }
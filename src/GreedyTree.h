@@ -5,6 +5,7 @@
 #include "ConfigTree.h"
 #include "DataSet.h"
 #include "DecisionTreeNode.h"
+#include "NodeStats.h"
 #include "Tree.h"
 
 #include <vector>
@@ -15,6 +16,20 @@ public:
   int64_t percentiles;
   double minGain;
   bool useNominalBinary;
+  // Splits nominal attributes in two by the order of NodeStats::getValueOrder,
+  // instead of one value against the rest
+  bool useNominalOrdered = false;
+  // Grows the tree a level at a time with LevelWiseTree instead of a node at a time
+  bool levelWise = false;
+  // Threads streaming the attribute columns of a level when level-wise, or
+  // collecting the statistics of a node of at least parallelRows samples by
+  // ranges of rows (ParallelSplitSearch). 0 uses every hardware thread.
+  int64_t threads = 1;
+  int64_t parallelRows = 1000000;
+  // Grows the tree best first with BestFirstTree until it has maxLeaves leaves
+  // or maxSeconds have passed, 0 for no limit on either
+  int64_t maxLeaves = 0;
+  double maxSeconds = 0;
   std::vector<long double> alphas;
   std::vector<int64_t> minSamples;
 };
@@ -25,15 +40,31 @@ public:
   std::shared_ptr<DecisionTreeNode> createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) override;
 
 private:
+  // Scores nodes from statistics gathered over column files
+  friend class LevelWiseTree;
+
   std::shared_ptr<DecisionTreeNode> createTreeRec(DataSet& ds, int64_t height,
                                                   int64_t minLeaf, int64_t percentiles,
-                                                  double minGain, bool useNominalBinary);
-  bool isAllSameClass(DataSet& ds);
-  std::pair<long double, int64_t> getAttribScore(DataSet& ds, int64_t attribInx,
-                                                 int64_t percentiles, bool useNominalBinary);
-  std::pair<long double, int64_t> getNominalScore(DataSet& ds, int64_t attribInx, bool useNominalBinary);
+                                                  double minGain, bool useNominalBinary,
+                                                  bool useNominalOrdered);
+  std::pair<long double, int64_t> getAttribScore(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                 int64_t percentiles, bool useNominalBinary,
+                                                 bool useNominalOrdered);
+  std::pair<long double, int64_t> getNominalScore(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                  bool useNominalBinary, bool useNominalOrdered);
+  std::pair<long double, int64_t> getNominalOrderedScore(NodeStats& stats, int64_t attribInx);
   std::pair<long double, int64_t> getOrderedScore(DataSet& ds, int64_t attribInx,
                                                   int64_t percentiles);
-  std::shared_ptr<DecisionTreeNode> createLeaf(DataSet& ds);
-  long double calcGain(DataSet& ds, long double score);
+  // Sweeps the values of attribInx collected by stats instead of sorted samples
+  std::pair<long double, int64_t> getHistogramScore(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                    int64_t percentiles);
+  std::shared_ptr<DecisionTreeNode> createLeaf(int64_t leafValue);
+  long double calcGain(double leafScore, long double score);
+
+  // Attributes scored by value, collected by NodeStats
+  std::vector<int64_t> nominalAttribs_;
+  // Huge nodes collect every attribute and sweep ordered ones by value
+  std::vector<int64_t> allAttribs_;
+  int64_t threads_ = 1;
+  int64_t parallelRows_ = 0;
 };
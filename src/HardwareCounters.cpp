@@ -0,0 +1,186 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "HardwareCounters.h"
+
+#include "Logger.h"
+#include "ThreadLocalStats.h"
+
+#include <atomic>
+#include <ostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+typedef ThreadLocalStats<HardwareCounters::Snapshot, HardwareCounters::accumulate> Stats;
+
+namespace {
+
+std::atomic<int> available(-1);
+
+#ifdef __linux__
+
+// One counter group per thread, all events are read with a single syscall
+class EventGroup {
+public:
+  EventGroup() : leader_(-1), totOpened_(0) {
+    for (int e = 0; e < HardwareCounters::TOT_EVENTS; e++) {
+      fds_[e] = -1;
+      slot_[e] = -1;
+    }
+    const uint64_t configs[HardwareCounters::TOT_EVENTS] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int e = 0; e < HardwareCounters::TOT_EVENTS; e++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[e];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0);
+      if (fd < 0) {
+        // Without the leader there is no group
+        if (leader_ < 0) break;
+        continue;
+      }
+      if (leader_ < 0) leader_ = fd;
+      fds_[e] = fd;
+      slot_[e] = totOpened_++;
+    }
+    if (available.load() < 0) {
+      available = leader_ >= 0 ? 1 : 0;
+      if (leader_ < 0) {
+        Logger::log() << "Hardware counters unavailable, perf_event_open failed.";
+      }
+    }
+  }
+
+  ~EventGroup() {
+    for (int e = 0; e < HardwareCounters::TOT_EVENTS; e++) {
+      if (fds_[e] >= 0) close(fds_[e]);
+    }
+  }
+
+  bool read(int64_t* values) {
+    if (leader_ < 0) return false;
+    uint64_t buffer[1 + HardwareCounters::TOT_EVENTS];
+    if (::read(leader_, buffer, sizeof(buffer)) < (ssize_t)sizeof(uint64_t)) {
+      return false;
+    }
+    for (int e = 0; e < HardwareCounters::TOT_EVENTS; e++) {
+      values[e] = (slot_[e] >= 0 && slot_[e] < buffer[0]) ? buffer[1 + slot_[e]] : 0;
+    }
+    return true;
+  }
+
+private:
+  int leader_;
+  int totOpened_;
+  int fds_[HardwareCounters::TOT_EVENTS];
+  // Position of each event in the group read
+  int slot_[HardwareCounters::TOT_EVENTS];
+};
+
+bool readEvents(int64_t* values) {
+  thread_local EventGroup group;
+  return group.read(values);
+}
+
+#else
+
+bool readEvents(int64_t* values) {
+  if (available.load() < 0) {
+    available = 0;
+    Logger::log() << "Hardware counters are only available on Linux.";
+  }
+  return false;
+}
+
+#endif
+
+}
+
+bool HardwareCounters::enabled_ = false;
+
+
+HardwareCounters::ScopedRegion::ScopedRegion(Region region)
+  : region_(region), active_(enabled_ && readEvents(start_)) {}
+
+
+HardwareCounters::ScopedRegion::~ScopedRegion() {
+  if (!active_) return;
+  int64_t end[TOT_EVENTS];
+  if (!readEvents(end)) return;
+  Snapshot& stats = Stats::local();
+  for (int e = 0; e < TOT_EVENTS; e++) {
+    stats.values[region_][e] += end[e] - start_[e];
+  }
+  stats.calls[region_]++;
+}
+
+
+void HardwareCounters::setEnabled(bool enabled) {
+  enabled_ = enabled;
+}
+
+
+bool HardwareCounters::isEnabled() {
+  return enabled_;
+}
+
+
+bool HardwareCounters::isAvailable() {
+  return available.load() == 1;
+}
+
+
+HardwareCounters::Snapshot HardwareCounters::snapshot() {
+  return Stats::merged();
+}
+
+
+void HardwareCounters::reset() {
+  Stats::reset();
+}
+
+
+void HardwareCounters::accumulate(Snapshot& to, const Snapshot& from) {
+  for (int r = 0; r < TOT_REGIONS; r++) {
+    for (int e = 0; e < TOT_EVENTS; e++) {
+      to.values[r][e] += from.values[r][e];
+    }
+    to.calls[r] += from.calls[r];
+  }
+}
+
+
+std::string HardwareCounters::getRegionName(Region region) {
+  switch (region) {
+  case NUMERIC_SPLIT: return "numericSplit";
+  case NOMINAL_SCORE: return "nominalScore";
+  case PARTITIONING: return "partitioning";
+  case CLASSIFY: return "classify";
+  default: return "unknown";
+  }
+}
+
+
+std::string HardwareCounters::getEventName(Event event) {
+  switch (event) {
+  case CYCLES: return "cycles";
+  case INSTRUCTIONS: return "instructions";
+  case CACHE_MISSES: return "cacheMisses";
+  case BRANCH_MISSES: return "branchMisses";
+  default: return "unknown";
+  }
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module samples CPU performance counters (cycles, instructions, cache
+// misses and branch misses) around selected regions using perf_event_open.
+// It is off by default and only available on Linux, elsewhere and when the
+// kernel refuses the events all regions report zero.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class HardwareCounters {
+public:
+  enum Region {
+    NUMERIC_SPLIT,
+    NOMINAL_SCORE,
+    PARTITIONING,
+    CLASSIFY,
+    TOT_REGIONS
+  };
+
+  enum Event {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    TOT_EVENTS
+  };
+
+  struct Snapshot {
+    Snapshot() : values(TOT_REGIONS, std::vector<int64_t>(TOT_EVENTS, 0)), calls(TOT_REGIONS, 0) {}
+    // values[region][event]
+    std::vector<std::vector<int64_t>> values;
+    std::vector<int64_t> calls;
+  };
+
+  class ScopedRegion {
+  public:
+    ScopedRegion(Region region);
+    ~ScopedRegion();
+
+  private:
+    Region region_;
+    bool active_;
+    int64_t start_[TOT_EVENTS];
+  };
+
+  static void setEnabled(bool enabled);
+  static bool isEnabled();
+  // Whether the events could be opened, only known after the first region
+  static bool isAvailable();
+
+  static Snapshot snapshot();
+  static void reset();
+  static void accumulate(Snapshot& to, const Snapshot& from);
+
+  static std::string getRegionName(Region region);
+  static std::string getEventName(Event event);
+
+private:
+  static bool enabled_;
+};
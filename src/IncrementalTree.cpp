@@ -0,0 +1,284 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "IncrementalTree.h"
+
+#include "ErrorUtils.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "WorkCounters.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace {
+// Orders samples by their values, benefits and weight
+struct SampleLess {
+  bool operator()(const Sample* a, const Sample* b) const {
+    return std::tie(a->inxValue_, a->benefit_, a->weight_) < std::tie(b->inxValue_, b->benefit_, b->weight_);
+  }
+};
+}
+
+
+IncrementalTree::IncrementalTree(DataSet& ds, std::shared_ptr<ConfigTree> c)
+  : config_(c), ds_(ds), totRegrown_(1), regrownSamples_(ds.samples_.size()) {
+  ErrorUtils::enforce(c->typeName == "greedy" || c->typeName == "aodha",
+                      "IncrementalTree: only greedy and aodha trees can be updated.");
+  levelWise_.setConfig(ds_, c);
+  if (levelWise_.useAodha_) {
+    calcNormVars();
+  }
+  grow(root_, ds_);
+}
+
+
+void IncrementalTree::update(DataSet& added, DataSet& removed) {
+  ErrorUtils::enforce(added.getTotAttributes() == ds_.getTotAttributes()
+                      && removed.getTotAttributes() == ds_.getTotAttributes()
+                      && added.getTotClasses() == ds_.getTotClasses()
+                      && removed.getTotClasses() == ds_.getTotClasses(),
+                      "IncrementalTree: the samples weren't encoded with this data set.");
+  totRegrown_ = 0;
+  regrownSamples_ = 0;
+  std::vector<std::shared_ptr<Sample>> taken = takeSamples(removed);
+  for (const auto& s : added.samples_) {
+    ds_.addSample(s);
+  }
+
+  // The normalized differences of every sample depend on the range
+  if (levelWise_.useAodha_ && calcNormVars()) {
+    grow(root_, ds_);
+    totRegrown_ = 1;
+    regrownSamples_ = ds_.samples_.size();
+    Logger::log() << "Benefit range changed, grew the tree again from " << regrownSamples_ << " samples"
+                  << std::endl;
+    return;
+  }
+
+  {
+    Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+    for (const auto& s : taken) {
+      route(*s, false);
+    }
+    for (const auto& s : added.samples_) {
+      route(*s, true);
+    }
+  }
+  std::vector<Node*> nodes;
+  refresh(root_, nodes);
+  if (!nodes.empty()) {
+    regrow(nodes);
+  }
+  Logger::log() << "Updated the tree with " << added.samples_.size() << " added and " << taken.size()
+                << " removed samples, grew " << totRegrown_ << " subtrees again from " << regrownSamples_
+                << " samples" << std::endl;
+}
+
+
+std::shared_ptr<DecisionTreeNode> IncrementalTree::getTree() {
+  return root_.tree;
+}
+
+
+DataSet& IncrementalTree::getDataSet() {
+  return ds_;
+}
+
+
+int64_t IncrementalTree::getTotRegrown() {
+  return totRegrown_;
+}
+
+
+int64_t IncrementalTree::getRegrownSamples() {
+  return regrownSamples_;
+}
+
+
+// Same statistics, in the same sample order, as LevelWiseTree gives the node
+void IncrementalTree::grow(Node& node, DataSet& ds) {
+  node.children.clear();
+  node.childOf.clear();
+  node.splitAttrib = -1;
+  node.touched = false;
+  node.regrowInx = -1;
+  bool lastLevel = node.depth == config_->height;
+  {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    std::vector<int64_t> attribs = lastLevel ? std::vector<int64_t>() : levelWise_.allAttribs_;
+    if (levelWise_.useAodha_ && !lastLevel) {
+      node.stats.reset(new NodeStats(ds_, attribs, levelWise_.minValue_, levelWise_.maxValue_, false));
+    } else {
+      node.stats.reset(new NodeStats(ds_, attribs, false));
+    }
+    for (const auto& s : ds.samples_) {
+      node.stats->add(s->inxValue_.data(), s->benefit_.data(), s->weight_);
+    }
+    for (auto a : attribs) {
+      WorkCounters::addRows(a, ds.samples_.size());
+    }
+  }
+
+  LevelWiseTree::Split split = levelWise_.chooseSplit(ds_, *node.stats, lastLevel);
+  if (split.attrib == -1) {
+    setLeaf(node, node.stats->getBestClass().first);
+    return;
+  }
+  std::vector<std::vector<int64_t>> childKeys;
+  auto tree = levelWise_.createSplitNode(ds_, *node.stats, split, node.childOf, childKeys);
+  node.tree = tree;
+  node.splitAttrib = split.attrib;
+  if (node.parent) {
+    levelWise_.attach(node.parent, node.keys, tree);
+  }
+
+  std::vector<DataSet> childDS(childKeys.size());
+  for (auto& child : childDS) {
+    child.initAllAttributes(ds_);
+  }
+  {
+    Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+    for (const auto& s : ds.samples_) {
+      childDS[node.childOf[s->inxValue_[split.attrib]]].addSample(s);
+    }
+  }
+  for (int64_t i = 0; i < childKeys.size(); i++) {
+    node.children.emplace_back(new Node());
+    Node& child = *node.children.back();
+    child.parent = tree;
+    child.keys = childKeys[i];
+    child.depth = node.depth + 1;
+    grow(child, childDS[i]);
+  }
+}
+
+
+std::vector<std::shared_ptr<Sample>> IncrementalTree::takeSamples(DataSet& removed) {
+  std::map<const Sample*, int64_t, SampleLess> toRemove;
+  for (const auto& s : removed.samples_) {
+    toRemove[s.get()]++;
+  }
+  std::vector<std::shared_ptr<Sample>> taken;
+  for (auto it = ds_.samples_.begin(); it != ds_.samples_.end() && taken.size() < removed.samples_.size();) {
+    auto found = toRemove.find(it->get());
+    if (found != toRemove.end() && found->second > 0) {
+      found->second--;
+      taken.push_back(*it);
+      it = ds_.samples_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ErrorUtils::enforce(taken.size() == removed.samples_.size(),
+                      "IncrementalTree: a removed sample isn't in the tree.");
+  return taken;
+}
+
+
+void IncrementalTree::route(const Sample& s, bool add) {
+  Node* node = &root_;
+  // Nodes above the last level collect every attribute
+  int64_t totCollecting = 0;
+  while (node) {
+    if (add) {
+      node->stats->add(s.inxValue_.data(), s.benefit_.data(), s.weight_);
+    } else {
+      node->stats->remove(s.inxValue_.data(), s.benefit_.data(), s.weight_);
+    }
+    node->touched = true;
+    if (node->depth < config_->height) {
+      totCollecting++;
+    }
+    node = node->childOf.empty() ? nullptr : node->children[node->childOf[s.inxValue_[node->splitAttrib]]].get();
+  }
+  for (auto a : levelWise_.allAttribs_) {
+    WorkCounters::addRows(a, totCollecting);
+  }
+}
+
+
+void IncrementalTree::refresh(Node& node, std::vector<Node*>& regrow) {
+  if (!node.touched) {
+    return;
+  }
+  node.touched = false;
+  LevelWiseTree::Split split = levelWise_.chooseSplit(ds_, *node.stats, node.depth == config_->height);
+  if (split.attrib == -1 && node.childOf.empty()) {
+    int64_t leafValue = node.stats->getBestClass().first;
+    if (node.tree->getLeafValue() != leafValue) {
+      setLeaf(node, leafValue);
+    }
+    return;
+  }
+
+  if (split.attrib != -1 && split.attrib == node.splitAttrib) {
+    std::vector<int32_t> childOf;
+    std::vector<std::vector<int64_t>> childKeys;
+    auto tree = levelWise_.createSplitNode(ds_, *node.stats, split, childOf, childKeys);
+    auto old = std::static_pointer_cast<ExtrasTreeNode>(node.tree);
+    if (childOf == node.childOf && tree->getType() == old->getType()
+        && tree->getSeparator() == old->getSeparator()) {
+      old->setAlpha(tree->getAlpha());
+      old->setNumSamples(tree->getNumSamples());
+      old->setLeafValue(tree->getLeafValue());
+      for (auto& child : node.children) {
+        refresh(*child, regrow);
+      }
+      return;
+    }
+  }
+  node.regrowInx = regrow.size();
+  regrow.push_back(&node);
+}
+
+
+// One pass over the samples collects the samples of every node to regrow
+void IncrementalTree::regrow(std::vector<Node*>& nodes) {
+  std::vector<DataSet> nodeDS(nodes.size());
+  for (auto& ds : nodeDS) {
+    ds.initAllAttributes(ds_);
+  }
+  {
+    Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+    for (const auto& s : ds_.samples_) {
+      Node* node = &root_;
+      while (node->regrowInx == -1 && !node->childOf.empty()) {
+        node = node->children[node->childOf[s->inxValue_[node->splitAttrib]]].get();
+      }
+      if (node->regrowInx != -1) {
+        nodeDS[node->regrowInx].addSample(s);
+      }
+    }
+  }
+  for (int64_t i = 0; i < nodes.size(); i++) {
+    totRegrown_++;
+    regrownSamples_ += nodeDS[i].samples_.size();
+    grow(*nodes[i], nodeDS[i]);
+  }
+}
+
+
+void IncrementalTree::setLeaf(Node& node, int64_t leafValue) {
+  node.tree = levelWise_.createLeaf(leafValue);
+  if (node.parent) {
+    levelWise_.attach(node.parent, node.keys, node.tree);
+  }
+}
+
+
+bool IncrementalTree::calcNormVars() {
+  long double minValue = std::numeric_limits<long double>::max();
+  long double maxValue = std::numeric_limits<long double>::min();
+  for (const auto& s : ds_.samples_) {
+    minValue = std::min(minValue, (long double)std::min(s->benefit_[0], s->benefit_[1]) / s->weight_);
+    maxValue = std::max(maxValue, (long double)std::max(s->benefit_[0], s->benefit_[1]) / s->weight_);
+  }
+  // Exact, the statistics must be normalized as a tree grown from scratch
+  bool changed = minValue != levelWise_.minValue_ || maxValue != levelWise_.maxValue_;
+  levelWise_.minValue_ = minValue;
+  levelWise_.maxValue_ = maxValue;
+  return changed;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module keeps a GreedyTree or AodhaTree up to date as samples are added
+// and removed, instead of growing it again from scratch. Every node keeps the
+// NodeStats of its samples, leaves included. An update routes each changed
+// sample down its path, adding it to or removing it from the statistics of
+// the nodes it crosses, then decides again the nodes it touched top-down with
+// the decisions of LevelWiseTree: a node whose split is unchanged only gets
+// its alpha, number of samples and leaf value refreshed, and a node whose
+// split changed is grown again from its samples. The cost of an update is the
+// changed samples times the height plus the samples under the regrown nodes.
+// The tree is the one grown from scratch, up to the rounding of the sums.
+//
+
+#pragma once
+#include "ConfigTree.h"
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+#include "LevelWiseTree.h"
+#include "NodeStats.h"
+
+#include <memory>
+#include <vector>
+
+class IncrementalTree {
+public:
+  // Grows the tree of c, a ConfigGreedy or a ConfigAodha by its typeName, and
+  // keeps the samples of ds to update it
+  IncrementalTree(DataSet& ds, std::shared_ptr<ConfigTree> c);
+
+  // Adds the samples of added and, for every sample of removed, removes one
+  // sample with the same values, benefits and weight. Both must be encoded
+  // with the attributes of the tree's samples.
+  void update(DataSet& added, DataSet& removed);
+
+  std::shared_ptr<DecisionTreeNode> getTree();
+  // The samples the tree is grown on
+  DataSet& getDataSet();
+
+  // Subtrees grown again by the last update, and their number of samples
+  int64_t getTotRegrown();
+  int64_t getRegrownSamples();
+
+private:
+  struct Node {
+    std::shared_ptr<DecisionTreeNode> tree;
+    // Null for the root
+    std::shared_ptr<ExtrasTreeNode> parent;
+    std::vector<int64_t> keys;
+    int64_t depth = 0;
+    std::unique_ptr<NodeStats> stats;
+    // Position of the child by value of splitAttrib, empty on leaves
+    int64_t splitAttrib = -1;
+    std::vector<int32_t> childOf;
+    std::vector<std::unique_ptr<Node>> children;
+    // Changed samples crossed the node in the current update
+    bool touched = false;
+    // Position in the list of nodes to grow again, -1 if kept
+    int64_t regrowInx = -1;
+  };
+
+  // Grows node, whose parent, keys and depth are set, from the samples of ds
+  // and attaches it to its parent
+  void grow(Node& node, DataSet& ds);
+  std::vector<std::shared_ptr<Sample>> takeSamples(DataSet& removed);
+  void route(const Sample& s, bool add);
+  // Decides the touched nodes under node again, listing the ones to regrow
+  void refresh(Node& node, std::vector<Node*>& regrow);
+  void regrow(std::vector<Node*>& nodes);
+  void setLeaf(Node& node, int64_t leafValue);
+  // As AodhaTree::calcNormVars, true if the range changed
+  bool calcNormVars();
+
+  std::shared_ptr<ConfigTree> config_;
+  LevelWiseTree levelWise_;
+  DataSet ds_;
+  Node root_;
+  int64_t totRegrown_;
+  int64_t regrownSamples_;
+};
@@ -0,0 +1,137 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "JsonWriter.h"
+
+#include "ErrorUtils.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+
+JsonWriter::JsonWriter(std::ostream& out) : out_(out), afterKey_(false) {}
+
+
+void JsonWriter::beginObject() {
+  separate();
+  out_ << "{";
+  hasElement_.push_back(false);
+}
+
+
+void JsonWriter::endObject() {
+  ErrorUtils::enforce(!hasElement_.empty(), "JsonWriter: no open object.");
+  bool hadElement = hasElement_.back();
+  hasElement_.pop_back();
+  if (hadElement) newLine();
+  out_ << "}";
+  if (hasElement_.empty()) out_ << std::endl;
+}
+
+
+void JsonWriter::beginArray() {
+  separate();
+  out_ << "[";
+  hasElement_.push_back(false);
+}
+
+
+void JsonWriter::endArray() {
+  ErrorUtils::enforce(!hasElement_.empty(), "JsonWriter: no open array.");
+  bool hadElement = hasElement_.back();
+  hasElement_.pop_back();
+  if (hadElement) newLine();
+  out_ << "]";
+  if (hasElement_.empty()) out_ << std::endl;
+}
+
+
+void JsonWriter::key(const std::string& name) {
+  separate();
+  out_ << "\"" << escape(name) << "\": ";
+  afterKey_ = true;
+}
+
+
+void JsonWriter::value(const std::string& v) {
+  separate();
+  out_ << "\"" << escape(v) << "\"";
+}
+
+
+void JsonWriter::value(const char* v) {
+  value(std::string(v));
+}
+
+
+void JsonWriter::value(int64_t v) {
+  separate();
+  out_ << v;
+}
+
+
+void JsonWriter::value(int v) {
+  value((int64_t)v);
+}
+
+
+void JsonWriter::value(double v) {
+  value((long double)v);
+}
+
+
+void JsonWriter::value(long double v) {
+  separate();
+  // JSON has no representation for NaN or infinity
+  if (std::isnan(v) || std::isinf(v)) {
+    out_ << "null";
+    return;
+  }
+  out_ << std::setprecision(std::numeric_limits<double>::digits10 + 2) << v;
+}
+
+
+void JsonWriter::value(bool v) {
+  separate();
+  out_ << (v ? "true" : "false");
+}
+
+
+void JsonWriter::separate() {
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  if (hasElement_.empty()) return;
+  if (hasElement_.back()) out_ << ",";
+  hasElement_.back() = true;
+  newLine();
+}
+
+
+void JsonWriter::newLine() {
+  out_ << std::endl << std::string(2 * hasElement_.size(), ' ');
+}
+
+
+std::string JsonWriter::escape(const std::string& s) {
+  std::string ans;
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      ans += '\\';
+      ans += c;
+    } else if (c == '\n') {
+      ans += "\\n";
+    } else if (c == '\t') {
+      ans += "\\t";
+    } else if ((unsigned char)c < 0x20) {
+      char buffer[8];
+      snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+      ans += buffer;
+    } else {
+      ans += c;
+    }
+  }
+  return ans;
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements a minimal streaming JSON writer used by the
+// benchmark and run reports.
+//
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class JsonWriter {
+public:
+  JsonWriter(std::ostream& out);
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  void key(const std::string& name);
+
+  void value(const std::string& v);
+  void value(const char* v);
+  void value(int64_t v);
+  void value(int v);
+  void value(double v);
+  void value(long double v);
+  void value(bool v);
+
+  template <typename T>
+  void field(const std::string& name, const T& v) {
+    key(name);
+    value(v);
+  }
+
+private:
+  void separate();
+  void newLine();
+  static std::string escape(const std::string& s);
+
+  std::ostream& out_;
+  // For each open scope, whether it already holds an element
+  std::vector<bool> hasElement_;
+  bool afterKey_;
+};
@@ -0,0 +1,424 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "LevelWiseTree.h"
+
+#include "CompareUtils.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "WorkCounters.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <thread>
+
+
+LevelWiseTree::LevelWiseTree()
+  : columns_(nullptr), totRows_(0), threads_(1), useAodha_(false), minLeaf_(0), minGain_(0),
+    useNominalOrdered_(false),
+    minValue_(std::numeric_limits<long double>::max()),
+    maxValue_(std::numeric_limits<long double>::min()) {}
+
+
+std::shared_ptr<DecisionTreeNode> LevelWiseTree::createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) {
+  ErrorUtils::enforce(ds.samples_.size() < std::numeric_limits<int32_t>::max(),
+                      "LevelWiseTree: too many rows.");
+  columns_ = nullptr;
+  totRows_ = ds.samples_.size();
+  {
+    Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+    values_.assign(ds.getTotAttributes(), std::vector<int32_t>(totRows_));
+    benefits_.assign(ds.getTotClasses(), std::vector<double>(totRows_));
+    weights_.resize(totRows_);
+    WorkCounters::add(WorkCounters::BYTES_ALLOCATED,
+                      totRows_ * (ds.getTotAttributes() * sizeof(int32_t)
+                                  + ds.getTotClasses() * sizeof(double) + sizeof(int64_t)));
+    int64_t row = 0;
+    for (const auto& s : ds.samples_) {
+      for (int64_t j = 0; j < ds.getTotAttributes(); j++) {
+        values_[j][row] = s->inxValue_[j];
+      }
+      for (int64_t k = 0; k < ds.getTotClasses(); k++) {
+        benefits_[k][row] = s->benefit_[k];
+      }
+      weights_[row] = s->weight_;
+      row++;
+    }
+  }
+  auto tree = grow(ds, c);
+  values_.clear();
+  benefits_.clear();
+  weights_.clear();
+  return tree;
+}
+
+
+std::shared_ptr<DecisionTreeNode> LevelWiseTree::createTree(ColumnFile& columns, DataSet& ds,
+                                                            std::shared_ptr<ConfigTree> c) {
+  ErrorUtils::enforce(columns.getTotAttributes() == ds.getTotAttributes()
+                      && columns.getTotClasses() == ds.getTotClasses(),
+                      "LevelWiseTree: the columns weren't encoded with this data set.");
+  ErrorUtils::enforce(columns.getTotRows() < std::numeric_limits<int32_t>::max(),
+                      "LevelWiseTree: too many rows.");
+  columns_ = &columns;
+  totRows_ = columns.getTotRows();
+  auto tree = grow(ds, c);
+  columns_ = nullptr;
+  return tree;
+}
+
+
+std::shared_ptr<DecisionTreeNode> LevelWiseTree::grow(DataSet& ds, std::shared_ptr<ConfigTree> c) {
+  setConfig(ds, c);
+  if (useAodha_) {
+    calcNormVars();
+  }
+  nodeOf_.assign(totRows_, 0);
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, nodeOf_.size() * sizeof(int32_t));
+
+  std::shared_ptr<DecisionTreeNode> root;
+  std::vector<OpenNode> prev;
+  std::vector<OpenNode> level(1);
+  for (int64_t depth = 0; !level.empty(); depth++) {
+    bool lastLevel = depth == c->height;
+    scanLevel(ds, prev, level, lastLevel);
+    std::vector<OpenNode> next;
+    for (auto& node : level) {
+      auto tree = growNode(ds, node, lastLevel, next);
+      if (node.parent) {
+        attach(node.parent, node.keys, tree);
+      } else {
+        root = tree;
+      }
+      // The children get their own statistics
+      node.stats.reset();
+    }
+    Logger::log() << "Grew level " << depth << " with " << level.size() << " nodes";
+    prev = std::move(level);
+    level = std::move(next);
+  }
+  nodeOf_.clear();
+  nodeOf_.shrink_to_fit();
+  return root;
+}
+
+
+void LevelWiseTree::setConfig(DataSet& ds, std::shared_ptr<ConfigTree> c) {
+  ErrorUtils::enforce(ds.getTotClasses() == 2, "Error! Number of classes must be 2.");
+  useAodha_ = c->typeName == "aodha";
+  ErrorUtils::enforce(useAodha_ || c->typeName == "greedy",
+                      "LevelWiseTree: only greedy and aodha trees can be grown level-wise.");
+  if (useAodha_) {
+    configAodha_ = std::static_pointer_cast<ConfigAodha>(c);
+    minLeaf_ = configAodha_->minLeaf;
+    minGain_ = configAodha_->minGain;
+    useNominalOrdered_ = configAodha_->useNominalOrdered;
+    threads_ = configAodha_->threads;
+  } else {
+    configGreedy_ = std::static_pointer_cast<ConfigGreedy>(c);
+    minLeaf_ = configGreedy_->minLeaf;
+    minGain_ = configGreedy_->minGain;
+    useNominalOrdered_ = configGreedy_->useNominalOrdered;
+    threads_ = configGreedy_->threads;
+  }
+  bool budget = useAodha_ ? configAodha_->maxLeaves > 0 || configAodha_->maxSeconds > 0
+                          : configGreedy_->maxLeaves > 0 || configGreedy_->maxSeconds > 0;
+  ErrorUtils::enforce(!budget, "LevelWiseTree: maxLeaves and maxSeconds need best-first growth.");
+  if (threads_ <= 0) {
+    threads_ = std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+  threads_ = std::min<int64_t>(threads_, std::max<int64_t>(1, ds.getTotAttributes()));
+  allAttribs_.clear();
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    allAttribs_.push_back(i);
+  }
+}
+
+
+int64_t LevelWiseTree::getTotBlocks() {
+  return columns_ ? columns_->getTotBlocks() : 1;
+}
+
+
+void LevelWiseTree::getBlock(int64_t blockInx, Block& block) {
+  if (columns_) {
+    block.firstRow = columns_->getBlockFirstRow(blockInx);
+    block.totRows = columns_->getBlockRows(blockInx);
+    block.values.resize(columns_->getTotAttributes());
+    for (int64_t j = 0; j < block.values.size(); j++) {
+      block.values[j] = columns_->getValues(blockInx, j);
+    }
+    block.benefits.resize(columns_->getTotClasses());
+    for (int64_t k = 0; k < block.benefits.size(); k++) {
+      block.benefits[k] = columns_->getBenefits(blockInx, k);
+    }
+    block.weights = nullptr;
+  } else {
+    block.firstRow = 0;
+    block.totRows = totRows_;
+    block.values.resize(values_.size());
+    for (int64_t j = 0; j < values_.size(); j++) {
+      block.values[j] = values_[j].data();
+    }
+    block.benefits.resize(benefits_.size());
+    for (int64_t k = 0; k < benefits_.size(); k++) {
+      block.benefits[k] = benefits_[k].data();
+    }
+    block.weights = weights_.data();
+  }
+}
+
+
+// Rows of a node are added in row order, which is the order of the samples
+// of the DataSet the depth-first builders would give the node
+void LevelWiseTree::scanLevel(DataSet& ds, std::vector<OpenNode>& prev, std::vector<OpenNode>& level,
+                              bool lastLevel) {
+  // The last level only needs the class benefits
+  std::vector<int64_t> attribs = lastLevel ? std::vector<int64_t>() : allAttribs_;
+  {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    for (auto& node : level) {
+      if (useAodha_ && !lastLevel) {
+        node.stats.reset(new NodeStats(ds, attribs, minValue_, maxValue_, false));
+      } else {
+        node.stats.reset(new NodeStats(ds, attribs, false));
+      }
+    }
+  }
+
+  Block block;
+  std::vector<double> benefit(ds.getTotClasses());
+  for (int64_t b = 0; b < getTotBlocks(); b++) {
+    getBlock(b, block);
+    int32_t* nodeOf = &nodeOf_[block.firstRow];
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      for (int64_t r = 0; r < block.totRows && !prev.empty(); r++) {
+        if (nodeOf[r] >= 0) {
+          const OpenNode& parent = prev[nodeOf[r]];
+          nodeOf[r] = parent.childOf.empty() ? -1 : parent.childOf[block.values[parent.splitAttrib][r]];
+        }
+      }
+    }
+    // Only filling the statistics is split search, as in the depth-first builders
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH);
+    for (int64_t r = 0; r < block.totRows; r++) {
+      if (nodeOf[r] >= 0) {
+        for (int64_t k = 0; k < benefit.size(); k++) {
+          benefit[k] = block.benefits[k][r];
+        }
+        level[nodeOf[r]].stats->addTotals(benefit.data(), block.weights ? block.weights[r] : 1);
+      }
+    }
+    if (lastLevel) {
+      continue;
+    }
+    if (threads_ <= 1) {
+      scanValues(block, level, 0, 1);
+    } else {
+      // Each thread fills the values of its own attributes
+      std::vector<std::thread> workers;
+      for (int64_t t = 0; t < threads_; t++) {
+        workers.emplace_back(&LevelWiseTree::scanValues, this, std::cref(block), std::ref(level), t, threads_);
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    }
+  }
+}
+
+
+// Streams the columns firstAttrib, firstAttrib + step, ... of block
+void LevelWiseTree::scanValues(const Block& block, std::vector<OpenNode>& level, int64_t firstAttrib,
+                               int64_t step) {
+  const int32_t* nodeOf = &nodeOf_[block.firstRow];
+  std::vector<double> benefit(block.benefits.size());
+  for (int64_t j = firstAttrib; j < block.values.size(); j += step) {
+    const int32_t* values = block.values[j];
+    int64_t totAdded = 0;
+    for (int64_t r = 0; r < block.totRows; r++) {
+      if (nodeOf[r] >= 0) {
+        for (int64_t k = 0; k < benefit.size(); k++) {
+          benefit[k] = block.benefits[k][r];
+        }
+        level[nodeOf[r]].stats->addValue(j, values[r], benefit.data(), block.weights ? block.weights[r] : 1);
+        totAdded++;
+      }
+    }
+    WorkCounters::addRows(j, totAdded);
+  }
+}
+
+
+std::shared_ptr<DecisionTreeNode> LevelWiseTree::growNode(DataSet& ds, OpenNode& node, bool lastLevel,
+                                                          std::vector<OpenNode>& next) {
+  NodeStats& stats = *node.stats;
+  Split split = chooseSplit(ds, stats, lastLevel);
+  if (split.attrib == -1) {
+    return createLeaf(stats.getBestClass().first);
+  }
+
+  std::vector<std::vector<int64_t>> childKeys;
+  auto tree = createSplitNode(ds, stats, split, node.childOf, childKeys);
+  node.splitAttrib = split.attrib;
+  for (auto& child : node.childOf) {
+    child += next.size();
+  }
+  for (auto& keys : childKeys) {
+    next.push_back(OpenNode());
+    next.back().parent = tree;
+    next.back().keys = keys;
+  }
+  return tree;
+}
+
+
+// Same decisions as GreedyTree::createTreeRec and AodhaTree::createTreeRec
+LevelWiseTree::Split LevelWiseTree::chooseSplit(DataSet& ds, NodeStats& stats, bool lastLevel) {
+  Split none;
+  if (lastLevel || (minLeaf_ > 0 && stats.getTotWeight() <= minLeaf_) || stats.isAllSameClass()) {
+    return none;
+  }
+  Split split = useAodha_ ? findAodhaSplit(ds, stats) : findGreedySplit(ds, stats);
+  if (split.attrib == -1 || CompareUtils::compare(split.gain, minGain_) < 0) {
+    return none;
+  }
+  return split;
+}
+
+
+std::shared_ptr<ExtrasTreeNode> LevelWiseTree::createSplitNode(DataSet& ds, NodeStats& stats, const Split& split,
+                                                               std::vector<int32_t>& childOf,
+                                                               std::vector<std::vector<int64_t>>& childKeys) {
+  int64_t attribSize = ds.getAttributeSize(split.attrib);
+  childOf.assign(attribSize, -1);
+  childKeys.clear();
+  std::shared_ptr<ExtrasTreeNode> tree;
+  if (split.separator == -1) {
+    tree = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, split.attrib);
+    for (int64_t j = 0; j < attribSize; j++) {
+      childOf[j] = j;
+      childKeys.push_back({ j });
+    }
+
+  // Nominal attribute separating leftValues from the rest
+  } else if (ds.getAttributeType(split.attrib) == AttributeType::STRING) {
+    tree = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, split.attrib);
+    std::vector<int64_t> leftValues;
+    if (useNominalOrdered_) {
+      std::vector<int64_t> order = stats.getValueOrder(split.attrib);
+      leftValues.assign(order.begin(), order.begin() + split.separator + 1);
+      std::sort(leftValues.begin(), leftValues.end());
+    } else {
+      leftValues.push_back(split.separator);
+    }
+    std::vector<int64_t> rightValues;
+    std::vector<bool> isLeft(attribSize, false);
+    for (auto j : leftValues) {
+      isLeft[j] = true;
+    }
+    for (int64_t j = 0; j < attribSize; j++) {
+      if (!isLeft[j]) rightValues.push_back(j);
+      childOf[j] = isLeft[j] ? 0 : 1;
+    }
+    childKeys.push_back(leftValues);
+    childKeys.push_back(rightValues);
+
+  } else {
+    tree = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_ORDERED, split.attrib,
+                                            split.separator);
+    for (int64_t j = 0; j < attribSize; j++) {
+      childOf[j] = j <= split.separator ? 0 : 1;
+    }
+    childKeys.push_back({ 0 });
+    childKeys.push_back({ 1 });
+  }
+  tree->setAlpha(1 - split.gain);
+  tree->setNumSamples(stats.getTotWeight());
+  tree->setLeafValue(stats.getBestClass().first);
+  return tree;
+}
+
+
+LevelWiseTree::Split LevelWiseTree::findGreedySplit(DataSet& ds, NodeStats& stats) {
+  auto bestClass = stats.getBestClass();
+  Split ans;
+  long double bestScore = bestClass.second;
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, i);
+    std::pair<long double, int64_t> attrib;
+    if (ds.getAttributeType(i) == AttributeType::STRING) {
+      attrib = greedy_.getNominalScore(ds, stats, i, configGreedy_->useNominalBinary, useNominalOrdered_);
+    } else {
+      attrib = greedy_.getHistogramScore(ds, stats, i, configGreedy_->percentiles);
+    }
+    if (CompareUtils::compare(attrib.first, bestScore) > 0) {
+      ans.attrib = i;
+      bestScore = attrib.first;
+      ans.separator = attrib.second;
+    }
+  }
+  ans.gain = greedy_.calcGain(bestClass.second, bestScore);
+  return ans;
+}
+
+
+LevelWiseTree::Split LevelWiseTree::findAodhaSplit(DataSet& ds, NodeStats& stats) {
+  long double impurity = aodha_.calcImpurity(stats.getDiffSums());
+  Split ans;
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, i);
+    AodhaTree::AttribResult result;
+    if (ds.getAttributeType(i) == AttributeType::STRING && useNominalOrdered_) {
+      result = aodha_.calcNominalOrderedGain(stats, i, impurity);
+    } else if (ds.getAttributeType(i) == AttributeType::STRING) {
+      result = aodha_.calcNominalGain(ds, stats, i, impurity, configAodha_->useNominalBinary);
+    } else {
+      result = aodha_.calcHistogramGain(ds, stats, i, impurity);
+    }
+    if (CompareUtils::compare(result.gain, ans.gain) > 0) {
+      ans.attrib = i;
+      ans.gain = result.gain;
+      ans.separator = result.separator;
+    }
+  }
+  return ans;
+}
+
+
+// A pass over the benefits, as AodhaTree::calcNormVars over the samples
+void LevelWiseTree::calcNormVars() {
+  minValue_ = std::numeric_limits<long double>::max();
+  maxValue_ = std::numeric_limits<long double>::min();
+  Block block;
+  for (int64_t b = 0; b < getTotBlocks(); b++) {
+    getBlock(b, block);
+    for (int64_t r = 0; r < block.totRows; r++) {
+      int64_t weight = block.weights ? block.weights[r] : 1;
+      minValue_ = std::min(minValue_, (long double)std::min(block.benefits[0][r], block.benefits[1][r]) / weight);
+      maxValue_ = std::max(maxValue_, (long double)std::max(block.benefits[0][r], block.benefits[1][r]) / weight);
+    }
+  }
+}
+
+
+std::shared_ptr<DecisionTreeNode> LevelWiseTree::createLeaf(int64_t leafValue) {
+  return greedy_.createLeaf(leafValue);
+}
+
+
+void LevelWiseTree::attach(std::shared_ptr<ExtrasTreeNode> parent, const std::vector<int64_t>& keys,
+                           std::shared_ptr<DecisionTreeNode> tree) {
+  if (parent->getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+    if (keys[0] == 0) {
+      parent->addLeftChild(tree);
+    } else {
+      parent->addRightChild(tree);
+    }
+  } else {
+    parent->addChild(tree, keys);
+  }
+}
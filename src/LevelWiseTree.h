@@ -0,0 +1,120 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module grows the trees of GreedyTree and AodhaTree breadth first, a
+// level at a time, over a DataSet or a ColumnFile too large for memory. Each
+// level is one sequential pass over the rows in column order: every row is
+// routed to the child of the node split at the previous level, then each
+// attribute column is streamed once into the NodeStats of all the nodes of
+// the level, on several threads if asked. Only the node of each row and the
+// statistics of the current level are kept besides the columns. Ordered
+// attributes are swept over the value histograms of NodeStats instead of
+// sorted samples, so splits match the depth-first builders up to the rounding
+// of the sums.
+//
+
+#pragma once
+#include "AodhaTree.h"
+#include "ColumnFile.h"
+#include "ConfigTree.h"
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+#include "GreedyTree.h"
+#include "NodeStats.h"
+
+#include <memory>
+#include <vector>
+
+class LevelWiseTree {
+public:
+  LevelWiseTree();
+
+  // c is a ConfigGreedy or a ConfigAodha by its typeName
+  std::shared_ptr<DecisionTreeNode> createTree(DataSet& ds, std::shared_ptr<ConfigTree> c);
+
+  // ds holds the attributes and classes the columns were encoded with, its
+  // samples are ignored
+  std::shared_ptr<DecisionTreeNode> createTree(ColumnFile& columns, DataSet& ds,
+                                               std::shared_ptr<ConfigTree> c);
+
+private:
+  // Updates trees with the same decisions
+  friend class IncrementalTree;
+
+  // Columns of a range of rows, from a ColumnFile block or from the samples
+  struct Block {
+    int64_t firstRow;
+    int64_t totRows;
+    std::vector<const int32_t*> values;
+    std::vector<const double*> benefits;
+    // Null when every row weighs 1
+    const int64_t* weights;
+  };
+
+  // A node of the level being grown
+  struct OpenNode {
+    // Null for the root
+    std::shared_ptr<ExtrasTreeNode> parent;
+    // Values leading to the node on a REGULAR_NOMINAL parent, or 0 and 1 for
+    // the left and right children of a REGULAR_ORDERED one
+    std::vector<int64_t> keys;
+    std::unique_ptr<NodeStats> stats;
+    // Once split, the position of the child in the next level by value of
+    // splitAttrib. Empty on leaves.
+    int64_t splitAttrib = -1;
+    std::vector<int32_t> childOf;
+  };
+
+  struct Split {
+    int64_t attrib = -1;
+    int64_t separator = -1;
+    long double gain = 0;
+  };
+
+  std::shared_ptr<DecisionTreeNode> grow(DataSet& ds, std::shared_ptr<ConfigTree> c);
+  void setConfig(DataSet& ds, std::shared_ptr<ConfigTree> c);
+  int64_t getTotBlocks();
+  void getBlock(int64_t blockInx, Block& block);
+  void scanLevel(DataSet& ds, std::vector<OpenNode>& prev, std::vector<OpenNode>& level,
+                 bool lastLevel);
+  void scanValues(const Block& block, std::vector<OpenNode>& level, int64_t firstAttrib,
+                  int64_t step);
+  std::shared_ptr<DecisionTreeNode> growNode(DataSet& ds, OpenNode& node, bool lastLevel,
+                                             std::vector<OpenNode>& next);
+  // The split of a node with these statistics, attrib -1 for a leaf
+  Split chooseSplit(DataSet& ds, NodeStats& stats, bool lastLevel);
+  // The node of split, with the child position of every value of its
+  // attribute and the keys leading to each child
+  std::shared_ptr<ExtrasTreeNode> createSplitNode(DataSet& ds, NodeStats& stats, const Split& split,
+                                                  std::vector<int32_t>& childOf,
+                                                  std::vector<std::vector<int64_t>>& childKeys);
+  Split findGreedySplit(DataSet& ds, NodeStats& stats);
+  Split findAodhaSplit(DataSet& ds, NodeStats& stats);
+  void calcNormVars();
+  std::shared_ptr<DecisionTreeNode> createLeaf(int64_t leafValue);
+  void attach(std::shared_ptr<ExtrasTreeNode> parent, const std::vector<int64_t>& keys,
+              std::shared_ptr<DecisionTreeNode> tree);
+
+  // Rows come from columns_ if set, from the copies below otherwise
+  ColumnFile* columns_;
+  int64_t totRows_;
+  std::vector<std::vector<int32_t>> values_;
+  std::vector<std::vector<double>> benefits_;
+  std::vector<int64_t> weights_;
+
+  int64_t threads_;
+  bool useAodha_;
+  std::shared_ptr<ConfigGreedy> configGreedy_;
+  std::shared_ptr<ConfigAodha> configAodha_;
+  int64_t minLeaf_;
+  long double minGain_;
+  bool useNominalOrdered_;
+  GreedyTree greedy_;
+  AodhaTree aodha_;
+  long double minValue_;
+  long double maxValue_;
+  std::vector<int64_t> allAttribs_;
+  // Position in the current level of the node of each row, -1 once in a leaf
+  std::vector<int32_t> nodeOf_;
+};
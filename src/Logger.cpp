@@ -15,11 +15,11 @@ std::filebuf Logger::fb_;
 
 void Logger::setOutput(std::string fileName) {
   if (fileName.compare("") == 0) {
-    out_.set_rdbuf(std::cout.rdbuf());
+    out_.rdbuf(std::cout.rdbuf());
   }
   else {
     fb_.open(fileName, std::ios::out);
-    out_.set_rdbuf(&fb_);
+    out_.rdbuf(&fb_);
   }
 }
 
@@ -0,0 +1,425 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "MappedModel.h"
+
+#include "Converter.h"
+#include "ErrorUtils.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedModel::MappedModel()
+  : data_(nullptr), size_(0) {
+#ifdef _WIN32
+  file_ = INVALID_HANDLE_VALUE;
+  mapping_ = nullptr;
+#else
+  fd_ = -1;
+#endif
+}
+
+
+MappedModel::MappedModel(std::string fileName) : MappedModel() {
+  std::string error = load(fileName);
+  ErrorUtils::enforce(error == "", error);
+}
+
+
+std::shared_ptr<MappedModel> MappedModel::tryLoad(std::string fileName, std::string& error) {
+  std::shared_ptr<MappedModel> model(new MappedModel());
+  error = model->load(fileName);
+  return error == "" ? model : nullptr;
+}
+
+
+MappedModel::~MappedModel() {
+  unmap();
+}
+
+
+int64_t MappedModel::classify(const int64_t* inxValues) {
+  int64_t nodeInx = 0;
+  for (int64_t depth = 0; depth < header_->totNodes; depth++) {
+    const ModelFormat::Node& node = nodes_[nodeInx];
+    if (node.type == ModelFormat::LEAF) {
+      return node.leafValue;
+    }
+    int64_t value = inxValues[node.attribCol];
+    if (value < 0) {
+      return node.leafValue;
+    }
+    const ModelFormat::Child* first = children_ + node.firstChild;
+    const ModelFormat::Child* last = first + node.totChildren;
+    int64_t key = value;
+    if (node.type == ModelFormat::ORDERED) {
+      key = (value <= node.separator) ? 0 : 1;
+    }
+    auto child = std::lower_bound(first, last, key,
+      [](const ModelFormat::Child& c, int64_t v) { return c.value < v; });
+    if (child == last || child->value != key) {
+      return node.leafValue;
+    }
+    nodeInx = child->node;
+  }
+  ErrorUtils::enforce(false, "MappedModel: cycle found while classifying.");
+  return -1;
+}
+
+
+int64_t MappedModel::classify(const std::vector<std::string>& rawValues) {
+  std::vector<int64_t> inxValues;
+  encode(rawValues, inxValues);
+  return classify(inxValues.data());
+}
+
+
+int64_t MappedModel::encode(int64_t attribInx, const std::string& rawValue) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < header_->totAttributes,
+                      "MappedModel: attribute index out of bounds.");
+  const ModelFormat::Attribute& attrib = attributes_[attribInx];
+  AttributeType type = static_cast<AttributeType>(attrib.type);
+  if (type == AttributeType::STRING) {
+    auto first = reinterpret_cast<const ModelFormat::StringRef*>(data_ + attrib.valuesOffset);
+    auto last = first + attrib.size;
+    auto it = std::lower_bound(first, last, rawValue,
+      [this](const ModelFormat::StringRef& ref, const std::string& value) {
+        return value.compare(0, std::string::npos, strings_ + ref.offset, ref.length) > 0;
+      });
+    if (it == last || rawValue.compare(0, std::string::npos, strings_ + it->offset, it->length) != 0) {
+      return -1;
+    }
+    return it - first;
+  }
+
+  if (type == AttributeType::INTEGER && Converter::isInteger(rawValue)) {
+    auto first = reinterpret_cast<const int64_t*>(data_ + attrib.valuesOffset);
+    int64_t value = Converter::fromString<int64_t>(rawValue);
+    return std::lower_bound(first, first + attrib.size, value) - first;
+  }
+  if (!Converter::isDouble(rawValue)) {
+    return -1;
+  }
+  return encode(attribInx, Converter::fromString<double>(rawValue));
+}
+
+
+int64_t MappedModel::encode(int64_t attribInx, double value) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < header_->totAttributes,
+                      "MappedModel: attribute index out of bounds.");
+  const ModelFormat::Attribute& attrib = attributes_[attribInx];
+  AttributeType type = static_cast<AttributeType>(attrib.type);
+  if (type == AttributeType::STRING || std::isnan(value)) {
+    return -1;
+  }
+  if (type == AttributeType::INTEGER) {
+    auto first = reinterpret_cast<const int64_t*>(data_ + attrib.valuesOffset);
+    return std::lower_bound(first, first + attrib.size, value,
+      [](int64_t a, double b) { return a < b; }) - first;
+  }
+  // Same tolerance used to sort the DOUBLE dictionaries
+  const double EPS = 1e-9;
+  auto first = reinterpret_cast<const double*>(data_ + attrib.valuesOffset);
+  return std::lower_bound(first, first + attrib.size, value,
+    [EPS](double a, double b) { return b - a > EPS; }) - first;
+}
+
+
+void MappedModel::encode(const std::vector<std::string>& rawValues,
+                         std::vector<int64_t>& inxValues) {
+  ErrorUtils::enforce(rawValues.size() == header_->totAttributes,
+                      "MappedModel: wrong number of attributes.");
+  inxValues.resize(rawValues.size());
+  for (int64_t a = 0; a < rawValues.size(); a++) {
+    inxValues[a] = encode(a, rawValues[a]);
+  }
+}
+
+
+std::shared_ptr<ExtrasTreeNode> MappedModel::toTree() {
+  std::vector<std::shared_ptr<ExtrasTreeNode>> built(header_->totNodes);
+  return toTreeRec(0, built);
+}
+
+
+int64_t MappedModel::getTotNodes() {
+  return header_->totNodes;
+}
+
+
+int64_t MappedModel::getTotAttributes() {
+  return header_->totAttributes;
+}
+
+
+AttributeType MappedModel::getAttributeType(int64_t attribInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < header_->totAttributes, "Out of bounds");
+  return static_cast<AttributeType>(attributes_[attribInx].type);
+}
+
+
+std::string MappedModel::getAttributeName(int64_t attribInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < header_->totAttributes, "Out of bounds");
+  return getString(attributes_[attribInx].name);
+}
+
+
+int64_t MappedModel::getAttributeSize(int64_t attribInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < header_->totAttributes, "Out of bounds");
+  return attributes_[attribInx].size;
+}
+
+
+int64_t MappedModel::getTotClasses() {
+  return header_->totClasses;
+}
+
+
+std::string MappedModel::getClassValue(int64_t classInx) {
+  ErrorUtils::enforce(classInx >= 0 && classInx < header_->totClasses,
+                      "Class index out of bounds");
+  return getString(classes_[classInx]);
+}
+
+
+bool MappedModel::isComplete(std::string fileName) {
+  std::ifstream ifs(fileName, std::ifstream::binary | std::ifstream::ate);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  int64_t size = ifs.tellg();
+  ModelFormat::Header header;
+  ifs.seekg(0);
+  if (size < sizeof(header) || !ifs.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
+  }
+  return std::memcmp(header.magic, ModelFormat::magic(), sizeof(header.magic)) == 0
+         && header.version == ModelFormat::VERSION && header.fileSize == size;
+}
+
+
+std::string MappedModel::load(std::string fileName) {
+  std::string error = map(fileName);
+  if (error == "") {
+    error = validate();
+  }
+  if (error != "") {
+    unmap();
+    return error;
+  }
+  Logger::log() << "Mapped model " << fileName << " with " << header_->totNodes << " nodes";
+  return "";
+}
+
+
+std::string MappedModel::map(std::string fileName) {
+#ifdef _WIN32
+  file_ = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return "MappedModel: can't open " + fileName;
+  }
+  LARGE_INTEGER size;
+  GetFileSizeEx(file_, &size);
+  size_ = size.QuadPart;
+  if (size_ > 0) {
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) {
+      data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+#else
+  fd_ = open(fileName.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    return "MappedModel: can't open " + fileName;
+  }
+  struct stat info;
+  fstat(fd_, &info);
+  size_ = info.st_size;
+  if (size_ > 0) {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    data_ = (data == MAP_FAILED) ? nullptr : static_cast<const char*>(data);
+  }
+#endif
+  if (data_ == nullptr) {
+    return "MappedModel: can't map " + fileName;
+  }
+  return "";
+}
+
+
+void MappedModel::unmap() {
+#ifdef _WIN32
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_);
+  }
+  mapping_ = nullptr;
+  file_ = INVALID_HANDLE_VALUE;
+#else
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  fd_ = -1;
+#endif
+  data_ = nullptr;
+}
+
+
+// Checks every offset and index once, so classify can trust the file
+std::string MappedModel::validate() {
+  if (size_ < sizeof(ModelFormat::Header)) {
+    return "MappedModel: file too small.";
+  }
+  header_ = reinterpret_cast<const ModelFormat::Header*>(data_);
+  if (std::memcmp(header_->magic, ModelFormat::magic(), sizeof(header_->magic)) != 0) {
+    return "MappedModel: not a model file.";
+  }
+  if (header_->version != ModelFormat::VERSION) {
+    return "MappedModel: unsupported version " + std::to_string(header_->version) + ".";
+  }
+  if (header_->headerSize != sizeof(ModelFormat::Header) || header_->fileSize != size_) {
+    return "MappedModel: corrupted header.";
+  }
+  if (header_->totNodes <= 0) {
+    return "MappedModel: empty tree.";
+  }
+
+  if (!section(header_->nodesOffset, header_->totNodes, nodes_)
+      || !section(header_->childrenOffset, header_->totChildren, children_)
+      || !section(header_->attributesOffset, header_->totAttributes, attributes_)
+      || !section(header_->classesOffset, header_->totClasses, classes_)
+      || !section(header_->stringsOffset, header_->stringsSize, strings_)) {
+    return "MappedModel: section out of bounds.";
+  }
+
+  for (int64_t i = 0; i < header_->totNodes; i++) {
+    const ModelFormat::Node& node = nodes_[i];
+    if (node.type < ModelFormat::NOMINAL || node.type > ModelFormat::LEAF) {
+      return "MappedModel: invalid node type.";
+    }
+    if (node.leafValue < -1 || node.leafValue >= header_->totClasses) {
+      return "MappedModel: invalid leaf value.";
+    }
+    if (node.type == ModelFormat::LEAF) {
+      continue;
+    }
+    if (node.attribCol < 0 || node.attribCol >= header_->totAttributes) {
+      return "MappedModel: invalid node attribute.";
+    }
+    if (node.firstChild < 0 || node.totChildren < 0
+        || node.firstChild + node.totChildren > header_->totChildren) {
+      return "MappedModel: invalid node children.";
+    }
+    for (int64_t c = node.firstChild; c < node.firstChild + node.totChildren; c++) {
+      if (children_[c].node < 0 || children_[c].node >= header_->totNodes) {
+        return "MappedModel: invalid child.";
+      }
+      if (c != node.firstChild && children_[c - 1].value >= children_[c].value) {
+        return "MappedModel: children out of order.";
+      }
+    }
+  }
+  for (int64_t a = 0; a < header_->totAttributes; a++) {
+    const ModelFormat::Attribute& attrib = attributes_[a];
+    if (!isString(attrib.name)) {
+      return "MappedModel: string out of bounds.";
+    }
+    if (attrib.type == static_cast<int32_t>(AttributeType::STRING)) {
+      const ModelFormat::StringRef* values;
+      if (!section(attrib.valuesOffset, attrib.size, values)) {
+        return "MappedModel: section out of bounds.";
+      }
+      for (int64_t v = 0; v < attrib.size; v++) {
+        if (!isString(values[v])) {
+          return "MappedModel: string out of bounds.";
+        }
+      }
+    } else {
+      if (attrib.type != static_cast<int32_t>(AttributeType::INTEGER)
+          && attrib.type != static_cast<int32_t>(AttributeType::DOUBLE)) {
+        return "MappedModel: invalid attribute type.";
+      }
+      const int64_t* values;
+      if (!section(attrib.valuesOffset, attrib.size, values)) {
+        return "MappedModel: section out of bounds.";
+      }
+    }
+  }
+  for (int64_t c = 0; c < header_->totClasses; c++) {
+    if (!isString(classes_[c])) {
+      return "MappedModel: string out of bounds.";
+    }
+  }
+  return "";
+}
+
+
+template <typename T>
+bool MappedModel::section(int64_t offset, int64_t count, const T*& data) {
+  if (offset < 0 || offset % ModelFormat::ALIGNMENT != 0 || count < 0
+      || offset > size_ || count > (size_ - offset) / (int64_t)sizeof(T)) {
+    return false;
+  }
+  data = reinterpret_cast<const T*>(data_ + offset);
+  return true;
+}
+
+
+bool MappedModel::isString(const ModelFormat::StringRef& ref) {
+  return ref.offset >= 0 && ref.length >= 0 && ref.offset <= header_->stringsSize
+         && ref.length <= header_->stringsSize - ref.offset;
+}
+
+
+std::string MappedModel::getString(const ModelFormat::StringRef& ref) {
+  ErrorUtils::enforce(isString(ref), "MappedModel: string out of bounds.");
+  return std::string(strings_ + ref.offset, ref.length);
+}
+
+
+std::shared_ptr<ExtrasTreeNode> MappedModel::toTreeRec(int64_t nodeInx,
+  std::vector<std::shared_ptr<ExtrasTreeNode>>& built) {
+  if (built[nodeInx]) {
+    return built[nodeInx];
+  }
+  const ModelFormat::Node& info = nodes_[nodeInx];
+  std::shared_ptr<ExtrasTreeNode> node;
+  if (info.type == ModelFormat::LEAF) {
+    node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::LEAF);
+  } else {
+    auto type = info.type == ModelFormat::ORDERED ? DecisionTreeNode::NodeType::REGULAR_ORDERED
+                                                  : DecisionTreeNode::NodeType::REGULAR_NOMINAL;
+    node = std::make_shared<ExtrasTreeNode>(type, info.attribCol, info.separator);
+  }
+  node->setLeafValue(info.leafValue);
+  node->setAlpha(info.alpha);
+  node->setNumSamples(info.numSamples);
+  built[nodeInx] = node;
+  for (int64_t c = info.firstChild; c < info.firstChild + info.totChildren; c++) {
+    node->children_[children_[c].value] = toTreeRec(children_[c].node, built);
+  }
+  return node;
+}
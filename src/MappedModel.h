@@ -0,0 +1,99 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module maps a model saved by ModelWriter into memory and scores
+// directly from the mapped file, without building a DecisionTreeNode tree.
+//
+
+#pragma once
+#include "Attribute.h"
+#include "ExtrasTreeNode.h"
+#include "ModelFormat.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MappedModel {
+public:
+  MappedModel(std::string fileName);
+  ~MappedModel();
+
+  // Same as the constructor, but returns null and sets error instead of
+  // aborting when the file can't be mapped or isn't a valid model
+  static std::shared_ptr<MappedModel> tryLoad(std::string fileName, std::string& error);
+
+  MappedModel(const MappedModel&) = delete;
+  MappedModel& operator=(const MappedModel&) = delete;
+
+  // inxValues holds one value index per attribute, as in Sample::inxValue_.
+  // A value index of -1 or a nominal value without a child stops at the
+  // current node and returns its leaf value.
+  int64_t classify(const int64_t* inxValues);
+
+  // Encodes and classifies one row of raw attribute values
+  int64_t classify(const std::vector<std::string>& rawValues);
+
+  // Returns the value index used by the tree for a raw value. Numeric values
+  // missing from the dictionary get the index of the next larger value, so
+  // they fall on the right side of every threshold. Unknown strings and
+  // values that can't be parsed are -1.
+  int64_t encode(int64_t attribInx, const std::string& rawValue);
+
+  // Same for a numeric value, -1 for STRING attributes
+  int64_t encode(int64_t attribInx, double value);
+
+  void encode(const std::vector<std::string>& rawValues, std::vector<int64_t>& inxValues);
+
+  // Rebuilds the tree, e.g. to prune it with ExtrasTreeNode::getTree
+  std::shared_ptr<ExtrasTreeNode> toTree();
+
+  int64_t getTotNodes();
+
+  int64_t getTotAttributes();
+
+  AttributeType getAttributeType(int64_t attribInx);
+
+  std::string getAttributeName(int64_t attribInx);
+
+  int64_t getAttributeSize(int64_t attribInx);
+
+  int64_t getTotClasses();
+
+  std::string getClassValue(int64_t classInx);
+
+  // Checks the header and the size without mapping, so a file still being
+  // written can be skipped instead of failing validation
+  static bool isComplete(std::string fileName);
+
+private:
+  MappedModel();
+  // These return the reason the file can't be used, or "" if it can
+  std::string load(std::string fileName);
+  std::string map(std::string fileName);
+  std::string validate();
+  void unmap();
+  // Points data at count items from offset, false if out of the file
+  template <typename T>
+  bool section(int64_t offset, int64_t count, const T*& data);
+  bool isString(const ModelFormat::StringRef& ref);
+  std::string getString(const ModelFormat::StringRef& ref);
+  std::shared_ptr<ExtrasTreeNode> toTreeRec(int64_t nodeInx,
+                                            std::vector<std::shared_ptr<ExtrasTreeNode>>& built);
+
+  const char* data_;
+  int64_t size_;
+#ifdef _WIN32
+  void* file_;
+  void* mapping_;
+#else
+  int fd_;
+#endif
+  const ModelFormat::Header* header_;
+  const ModelFormat::Node* nodes_;
+  const ModelFormat::Child* children_;
+  const ModelFormat::Attribute* attributes_;
+  const ModelFormat::StringRef* classes_;
+  const char* strings_;
+};
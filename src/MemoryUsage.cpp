@@ -0,0 +1,103 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "MemoryUsage.h"
+
+#include "ThreadLocalStats.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+typedef ThreadLocalStats<MemoryUsage::Snapshot, MemoryUsage::accumulate> Stats;
+
+
+MemoryUsage::ScopedBytes::ScopedBytes(Temporary temporary, int64_t bytes)
+  : temporary_(temporary), bytes_(bytes) {
+  allocate(temporary_, bytes_);
+}
+
+
+MemoryUsage::ScopedBytes::~ScopedBytes() {
+  release(temporary_, bytes_);
+}
+
+
+void MemoryUsage::allocate(Temporary temporary, int64_t bytes) {
+  Snapshot& stats = Stats::local();
+  stats.current[temporary] += bytes;
+  stats.peak[temporary] = std::max(stats.peak[temporary], stats.current[temporary]);
+}
+
+
+void MemoryUsage::release(Temporary temporary, int64_t bytes) {
+  Stats::local().current[temporary] -= bytes;
+}
+
+
+MemoryUsage::Snapshot MemoryUsage::snapshot() {
+  return Stats::merged();
+}
+
+
+void MemoryUsage::reset() {
+  Stats::reset();
+}
+
+
+void MemoryUsage::accumulate(Snapshot& to, const Snapshot& from) {
+  for (int t = 0; t < TOT_TEMPORARIES; t++) {
+    to.current[t] += from.current[t];
+    to.peak[t] += from.peak[t];
+  }
+}
+
+
+std::string MemoryUsage::getTemporaryName(Temporary temporary) {
+  switch (temporary) {
+  case BIT_ARRAYS: return "bitArrays";
+  case SAMPLE_INFO: return "sampleInfo";
+  default: return "unknown";
+  }
+}
+
+
+int64_t MemoryUsage::getPeakRSS() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return counters.PeakWorkingSetSize;
+  }
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  // Linux reports kilobytes
+  return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+
+int64_t MemoryUsage::mapNodeBytes(int64_t valueBytes) {
+  // Color plus parent, left and right links, rounded to the 16 byte
+  // allocator granularity
+  return (valueBytes + 4 * sizeof(void*) + 15) / 16 * 16;
+}
+
+
+int64_t MemoryUsage::listNodeBytes(int64_t valueBytes) {
+  // Previous and next links
+  return (valueBytes + 2 * sizeof(void*) + 15) / 16 * 16;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module tracks the bytes held by the temporaries of the tree builders
+// and reads the process peak resident set size. Long lived structures report
+// their own footprint through getMemoryUsage().
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MemoryUsage {
+public:
+  enum Temporary {
+    BIT_ARRAYS,
+    SAMPLE_INFO,
+    TOT_TEMPORARIES
+  };
+
+  struct Snapshot {
+    Snapshot() : current(TOT_TEMPORARIES, 0), peak(TOT_TEMPORARIES, 0) {}
+    std::vector<int64_t> current;
+    std::vector<int64_t> peak;
+  };
+
+  class ScopedBytes {
+  public:
+    ScopedBytes(Temporary temporary, int64_t bytes);
+    ~ScopedBytes();
+
+  private:
+    Temporary temporary_;
+    int64_t bytes_;
+  };
+
+  static void allocate(Temporary temporary, int64_t bytes);
+  static void release(Temporary temporary, int64_t bytes);
+
+  // Peaks of different threads are summed, an upper bound of the real peak
+  static Snapshot snapshot();
+  static void reset();
+  static void accumulate(Snapshot& to, const Snapshot& from);
+
+  static std::string getTemporaryName(Temporary temporary);
+
+  // Process peak resident set size in bytes, 0 if unknown
+  static int64_t getPeakRSS();
+
+  // Estimated heap size of a std::map / std::list node holding valueBytes
+  static int64_t mapNodeBytes(int64_t valueBytes);
+  static int64_t listNodeBytes(int64_t valueBytes);
+};
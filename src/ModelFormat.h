@@ -0,0 +1,83 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module defines the binary model layout written by ModelWriter and read
+// in place by MappedModel. The file is a header followed by arrays of the
+// structs below, each section 8 byte aligned. Offsets are from the start of
+// the file and all values are little endian.
+//
+
+#pragma once
+#include <cstdint>
+
+class ModelFormat {
+public:
+  static const uint32_t VERSION = 1;
+  static const int64_t ALIGNMENT = 8;
+
+  enum NodeType {
+    NOMINAL = 0,
+    ORDERED = 1,
+    LEAF = 2
+  };
+
+  struct StringRef {
+    int64_t offset;
+    int64_t length;
+  };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int64_t fileSize;
+    int64_t totNodes;
+    int64_t nodesOffset;
+    int64_t totChildren;
+    int64_t childrenOffset;
+    int64_t totAttributes;
+    int64_t attributesOffset;
+    int64_t totClasses;
+    int64_t classesOffset;
+    int64_t stringsOffset;
+    int64_t stringsSize;
+  };
+
+  // The root is node 0. Children of a node are the range
+  // [firstChild, firstChild + totChildren) of the children array.
+  struct Node {
+    int32_t type;
+    int32_t attribCol;
+    int64_t separator;
+    int64_t leafValue;
+    int64_t numSamples;
+    double alpha;
+    int64_t firstChild;
+    int64_t totChildren;
+  };
+
+  // Sorted by value. ORDERED nodes use value 0 for the left child and 1 for
+  // the right one.
+  struct Child {
+    int64_t value;
+    int64_t node;
+  };
+
+  // Dictionary values are int64_t, double or StringRef arrays sorted by value
+  // index, so the value index of a raw input is found by binary search.
+  struct Attribute {
+    int32_t type;
+    int32_t reserved;
+    int64_t size;
+    int64_t valuesOffset;
+    StringRef name;
+  };
+
+  static const char* magic() {
+    return "PTMODEL";
+  }
+
+  static int64_t align(int64_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+};
@@ -0,0 +1,163 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "ModelWriter.h"
+
+#include "ErrorUtils.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <fstream>
+#include <ostream>
+
+
+namespace {
+// Pads buffer to the format alignment and appends bytes, returning their offset
+int64_t append(std::string& buffer, const void* data, int64_t bytes) {
+  buffer.resize(ModelFormat::align(buffer.size()), '\0');
+  int64_t offset = buffer.size();
+  buffer.append(static_cast<const char*>(data), bytes);
+  return offset;
+}
+}
+
+
+void ModelWriter::save(std::string fileName, std::shared_ptr<ExtrasTreeNode> tree, DataSet& ds) {
+  write(fileName, tree.get(), true, ds);
+}
+
+
+void ModelWriter::save(std::string fileName, std::shared_ptr<DecisionTreeNode> tree, DataSet& ds) {
+  write(fileName, tree.get(), false, ds);
+}
+
+
+void ModelWriter::write(std::string fileName, DecisionTreeNode* root, bool hasExtras, DataSet& ds) {
+  ErrorUtils::enforce(root != nullptr, "ModelWriter: empty tree.");
+  uint16_t probe = 1;
+  ErrorUtils::enforce(*reinterpret_cast<char*>(&probe) == 1,
+                      "ModelWriter: only little endian platforms are supported.");
+  Logger::log() << "Started saving model " << fileName;
+
+  nodes_.clear();
+  children_.clear();
+  strings_.clear();
+  nodeInx_.clear();
+  addNode(root, hasExtras);
+
+  std::vector<ModelFormat::Attribute> attributes(ds.getTotAttributes());
+  for (int64_t a = 0; a < ds.getTotAttributes(); a++) {
+    attributes[a].type = static_cast<int32_t>(ds.getAttributeType(a));
+    attributes[a].reserved = 0;
+    attributes[a].size = ds.getAttributeSize(a);
+    attributes[a].name = addString(ds.getAttributeName(a));
+  }
+  std::vector<ModelFormat::StringRef> classes(ds.getTotClasses());
+  for (int64_t c = 0; c < ds.getTotClasses(); c++) {
+    classes[c] = addString(ds.getClassValue(c));
+  }
+
+  ModelFormat::Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, ModelFormat::magic(), sizeof(header.magic));
+  header.version = ModelFormat::VERSION;
+  header.headerSize = sizeof(header);
+  header.totNodes = nodes_.size();
+  header.totChildren = children_.size();
+  header.totAttributes = attributes.size();
+  header.totClasses = classes.size();
+
+  std::string buffer(sizeof(header), '\0');
+  header.nodesOffset = append(buffer, nodes_.data(), nodes_.size() * sizeof(ModelFormat::Node));
+  header.childrenOffset = append(buffer, children_.data(),
+                                 children_.size() * sizeof(ModelFormat::Child));
+  for (int64_t a = 0; a < ds.getTotAttributes(); a++) {
+    int64_t size = attributes[a].size;
+    if (ds.getAttributeType(a) == AttributeType::INTEGER) {
+      std::vector<int64_t> values(size);
+      for (int64_t v = 0; v < size; v++) {
+        values[v] = ds.getValue<int64_t>(a, v);
+      }
+      attributes[a].valuesOffset = append(buffer, values.data(), size * sizeof(int64_t));
+    } else if (ds.getAttributeType(a) == AttributeType::DOUBLE) {
+      std::vector<double> values(size);
+      for (int64_t v = 0; v < size; v++) {
+        values[v] = ds.getValue<double>(a, v);
+      }
+      attributes[a].valuesOffset = append(buffer, values.data(), size * sizeof(double));
+    } else {
+      std::vector<ModelFormat::StringRef> values(size);
+      for (int64_t v = 0; v < size; v++) {
+        values[v] = addString(ds.getValue<std::string>(a, v));
+      }
+      attributes[a].valuesOffset = append(buffer, values.data(),
+                                          size * sizeof(ModelFormat::StringRef));
+    }
+  }
+  header.attributesOffset = append(buffer, attributes.data(),
+                                   attributes.size() * sizeof(ModelFormat::Attribute));
+  header.classesOffset = append(buffer, classes.data(),
+                                classes.size() * sizeof(ModelFormat::StringRef));
+  header.stringsOffset = append(buffer, strings_.data(), strings_.size());
+  header.stringsSize = strings_.size();
+  buffer.resize(ModelFormat::align(buffer.size()), '\0');
+  header.fileSize = buffer.size();
+  std::memcpy(&buffer[0], &header, sizeof(header));
+
+  std::ofstream ofs(fileName, std::ofstream::out | std::ofstream::binary);
+  ErrorUtils::enforce(ofs.is_open(), "ModelWriter: can't create " + fileName);
+  ofs.write(buffer.data(), buffer.size());
+  ofs.close();
+  Logger::log() << "Finished saving model " << fileName << " with " << nodes_.size()
+                << " nodes and " << buffer.size() << " bytes";
+}
+
+
+int64_t ModelWriter::addNode(DecisionTreeNode* node, bool hasExtras) {
+  auto it = nodeInx_.find(node);
+  if (it != nodeInx_.end()) {
+    return it->second;
+  }
+  int64_t inx = nodes_.size();
+  nodeInx_[node] = inx;
+  nodes_.push_back(ModelFormat::Node());
+  ModelFormat::Node info;
+  std::memset(&info, 0, sizeof(info));
+  info.attribCol = node->getAttribCol();
+  info.leafValue = node->getLeafValue();
+  info.alpha = 1;
+  info.numSamples = 0;
+  // Only the regular nodes of an extras tree are known to be ExtrasTreeNode
+  if (hasExtras && !node->isLeaf()) {
+    auto extras = static_cast<ExtrasTreeNode*>(node);
+    info.alpha = extras->getAlpha();
+    info.numSamples = extras->getNumSamples();
+  }
+
+  std::vector<ModelFormat::Child> children;
+  if (node->getType() == DecisionTreeNode::NodeType::LEAF) {
+    info.type = ModelFormat::LEAF;
+  } else {
+    info.type = node->getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED
+                ? ModelFormat::ORDERED : ModelFormat::NOMINAL;
+    info.separator = node->getSeparator();
+    for (const auto& child : node->children_) {
+      if (child.second) {
+        children.push_back({child.first, addNode(child.second.get(), hasExtras)});
+      }
+    }
+  }
+  // Appended after the recursion so the children of a node stay contiguous
+  info.firstChild = children_.size();
+  info.totChildren = children.size();
+  children_.insert(children_.end(), children.begin(), children.end());
+  nodes_[inx] = info;
+  return inx;
+}
+
+
+ModelFormat::StringRef ModelWriter::addString(const std::string& str) {
+  ModelFormat::StringRef ref = {(int64_t)strings_.size(), (int64_t)str.size()};
+  strings_ += str;
+  return ref;
+}
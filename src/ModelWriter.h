@@ -0,0 +1,36 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module saves a tree and the dictionaries of its data set in the binary
+// format described in ModelFormat.h.
+//
+
+#pragma once
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+#include "ModelFormat.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ModelWriter {
+public:
+  // Keeps alpha and numSamples of the regular nodes
+  void save(std::string fileName, std::shared_ptr<ExtrasTreeNode> tree, DataSet& ds);
+
+  void save(std::string fileName, std::shared_ptr<DecisionTreeNode> tree, DataSet& ds);
+
+private:
+  void write(std::string fileName, DecisionTreeNode* root, bool hasExtras, DataSet& ds);
+  int64_t addNode(DecisionTreeNode* node, bool hasExtras);
+  ModelFormat::StringRef addString(const std::string& str);
+
+  std::vector<ModelFormat::Node> nodes_;
+  std::vector<ModelFormat::Child> children_;
+  std::string strings_;
+  // Shared subtrees are written once
+  std::map<DecisionTreeNode*, int64_t> nodeInx_;
+};
@@ -0,0 +1,274 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "NodeStats.h"
+
+#include "CompareUtils.h"
+#include "ErrorUtils.h"
+#include "WorkCounters.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+NodeStats::NodeStats(DataSet& ds, const std::vector<int64_t>& attribs, bool addSamples)
+  : useDiff_(false), minValue_(0), range_(1) {
+  init(ds, attribs);
+  if (addSamples) {
+    addAll(ds);
+  }
+}
+
+
+NodeStats::NodeStats(DataSet& ds, const std::vector<int64_t>& attribs,
+                     long double minValue, long double maxValue, bool addSamples)
+  : useDiff_(true), minValue_(minValue), range_(maxValue - minValue) {
+  ErrorUtils::enforce(ds.getTotClasses() == 2, "NodeStats: benefit differences need 2 classes.");
+  init(ds, attribs);
+  if (addSamples) {
+    addAll(ds);
+  }
+}
+
+
+int64_t NodeStats::getTotWeight() {
+  return totWeight_;
+}
+
+
+double NodeStats::getClassBenefit(int64_t classInx) {
+  return classBenefit_[classInx];
+}
+
+
+std::pair<int64_t, double> NodeStats::getBestClass() {
+  int64_t bestInx = 0;
+  for (int64_t k = 1; k < totClasses_; k++) {
+    if (CompareUtils::compare(classBenefit_[k], classBenefit_[bestInx]) > 0) {
+      bestInx = k;
+    }
+  }
+  return std::pair<int64_t, double>(bestInx, classBenefit_[bestInx]);
+}
+
+
+bool NodeStats::isAllSameClass() {
+  return totPrefer0_ == 0 || totPrefer0_ == totSamples_;
+}
+
+
+NodeStats::DiffSums NodeStats::getDiffSums() {
+  ErrorUtils::enforce(useDiff_, "NodeStats: benefit differences weren't collected.");
+  return diffSums_;
+}
+
+
+bool NodeStats::isCollected(int64_t attribInx) {
+  return attribInx >= 0 && attribInx < firstPos_.size() && firstPos_[attribInx] >= 0;
+}
+
+
+int64_t NodeStats::getTotWeight(int64_t attribInx, int64_t valueInx) {
+  return valueWeight_[getPos(attribInx, valueInx)];
+}
+
+
+double NodeStats::getClassBenefit(int64_t attribInx, int64_t valueInx, int64_t classInx) {
+  return valueBenefit_[getPos(attribInx, valueInx) * totClasses_ + classInx];
+}
+
+
+std::pair<int64_t, double> NodeStats::getBestClass(int64_t attribInx, int64_t valueInx) {
+  const double* benefit = &valueBenefit_[getPos(attribInx, valueInx) * totClasses_];
+  int64_t bestInx = 0;
+  for (int64_t k = 1; k < totClasses_; k++) {
+    if (CompareUtils::compare(benefit[k], benefit[bestInx]) > 0) {
+      bestInx = k;
+    }
+  }
+  return std::pair<int64_t, double>(bestInx, benefit[bestInx]);
+}
+
+
+NodeStats::DiffSums NodeStats::getDiffSums(int64_t attribInx, int64_t valueInx) {
+  ErrorUtils::enforce(useDiff_, "NodeStats: benefit differences weren't collected.");
+  return valueDiffSums_[getPos(attribInx, valueInx)];
+}
+
+
+std::vector<int64_t> NodeStats::getValueOrder(int64_t attribInx) {
+  ErrorUtils::enforce(totClasses_ == 2, "NodeStats: value order needs 2 classes.");
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < firstPos_.size() && firstPos_[attribInx] >= 0,
+                      "NodeStats: attribute wasn't collected.");
+  std::vector<int64_t> order(attribSize_[attribInx]);
+  std::vector<long double> meanDiff(order.size(), 0);
+  for (int64_t j = 0; j < order.size(); j++) {
+    order[j] = j;
+    int64_t pos = firstPos_[attribInx] + j;
+    if (valueWeight_[pos] > 0) {
+      meanDiff[j] = ((long double)valueBenefit_[pos * 2] - valueBenefit_[pos * 2 + 1]) / valueWeight_[pos];
+    }
+  }
+  int64_t first = firstPos_[attribInx];
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    if ((valueWeight_[first + a] > 0) != (valueWeight_[first + b] > 0)) {
+      return valueWeight_[first + a] > 0;
+    }
+    return meanDiff[a] < meanDiff[b];
+  });
+  return order;
+}
+
+
+void NodeStats::add(const int64_t* inxValue, const double* benefit, int64_t weight) {
+  addTotals(benefit, weight);
+  for (auto a : attribs_) {
+    addValue(a, inxValue[a], benefit, weight);
+  }
+}
+
+
+void NodeStats::addTotals(const double* benefit, int64_t weight) {
+  totSamples_++;
+  totWeight_ += weight;
+  if (totClasses_ < 2 || CompareUtils::compare(benefit[0], benefit[1]) >= 0) {
+    totPrefer0_++;
+  }
+  for (int64_t k = 0; k < totClasses_; k++) {
+    classBenefit_[k] += benefit[k];
+  }
+  if (useDiff_) {
+    addDiff(diffSums_, benefit, weight);
+  }
+}
+
+
+void NodeStats::addValue(int64_t attribInx, int64_t valueInx, const double* benefit, int64_t weight) {
+  int64_t pos = firstPos_[attribInx] + valueInx;
+  valueWeight_[pos] += weight;
+  double* valueBenefit = &valueBenefit_[pos * totClasses_];
+  for (int64_t k = 0; k < totClasses_; k++) {
+    valueBenefit[k] += benefit[k];
+  }
+  if (useDiff_) {
+    addDiff(valueDiffSums_[pos], benefit, weight);
+  }
+}
+
+
+void NodeStats::remove(const int64_t* inxValue, const double* benefit, int64_t weight) {
+  ErrorUtils::enforce(totSamples_ > 0, "NodeStats: no sample to remove.");
+  totSamples_--;
+  totWeight_ -= weight;
+  if (totClasses_ < 2 || CompareUtils::compare(benefit[0], benefit[1]) >= 0) {
+    totPrefer0_--;
+  }
+  for (int64_t k = 0; k < totClasses_; k++) {
+    classBenefit_[k] -= benefit[k];
+  }
+  if (useDiff_) {
+    addDiff(diffSums_, benefit, weight, -1);
+  }
+  for (auto a : attribs_) {
+    int64_t pos = firstPos_[a] + inxValue[a];
+    valueWeight_[pos] -= weight;
+    double* valueBenefit = &valueBenefit_[pos * totClasses_];
+    for (int64_t k = 0; k < totClasses_; k++) {
+      valueBenefit[k] -= benefit[k];
+    }
+    if (useDiff_) {
+      addDiff(valueDiffSums_[pos], benefit, weight, -1);
+    }
+  }
+}
+
+
+void NodeStats::add(const NodeStats& other) {
+  ErrorUtils::enforce(other.attribs_ == attribs_ && other.valueWeight_.size() == valueWeight_.size(),
+                      "NodeStats: the statistics weren't collected over the same attributes.");
+  totSamples_ += other.totSamples_;
+  totPrefer0_ += other.totPrefer0_;
+  totWeight_ += other.totWeight_;
+  for (int64_t k = 0; k < totClasses_; k++) {
+    classBenefit_[k] += other.classBenefit_[k];
+  }
+  addSums(diffSums_, other.diffSums_);
+  for (int64_t pos = 0; pos < valueWeight_.size(); pos++) {
+    valueWeight_[pos] += other.valueWeight_[pos];
+  }
+  for (int64_t pos = 0; pos < valueBenefit_.size(); pos++) {
+    valueBenefit_[pos] += other.valueBenefit_[pos];
+  }
+  for (int64_t pos = 0; pos < valueDiffSums_.size(); pos++) {
+    addSums(valueDiffSums_[pos], other.valueDiffSums_[pos]);
+  }
+}
+
+
+void NodeStats::init(DataSet& ds, const std::vector<int64_t>& attribs) {
+  totClasses_ = ds.getTotClasses();
+  totSamples_ = 0;
+  totPrefer0_ = 0;
+  totWeight_ = 0;
+  classBenefit_.assign(totClasses_, 0);
+
+  attribs_ = attribs;
+  firstPos_.assign(ds.getTotAttributes(), -1);
+  attribSize_.assign(ds.getTotAttributes(), 0);
+  int64_t totPos = 0;
+  for (auto a : attribs) {
+    ErrorUtils::enforce(a >= 0 && a < ds.getTotAttributes(), "Out of bounds");
+    firstPos_[a] = totPos;
+    attribSize_[a] = ds.getAttributeSize(a);
+    totPos += attribSize_[a];
+  }
+  valueWeight_.assign(totPos, 0);
+  valueBenefit_.assign(totPos * totClasses_, 0);
+  if (useDiff_) {
+    valueDiffSums_.assign(totPos, DiffSums());
+  }
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED,
+                    totPos * (sizeof(int64_t) + totClasses_ * sizeof(double)
+                              + (useDiff_ ? sizeof(DiffSums) : 0)));
+}
+
+
+// Samples are added in list order, so every sum matches the one of a DataSet
+// holding the same samples
+void NodeStats::addAll(DataSet& ds) {
+  for (const auto& s : ds.samples_) {
+    add(s->inxValue_.data(), s->benefit_.data(), s->weight_);
+  }
+  for (auto a : attribs_) {
+    WorkCounters::addRows(a, ds.samples_.size());
+  }
+}
+
+
+void NodeStats::addDiff(DiffSums& sums, const double* benefit, int64_t weight, int64_t sign) {
+  long double w = sign * weight;
+  long double benefit0 = (benefit[0] / weight - minValue_) / range_;
+  long double benefit1 = (benefit[1] / weight - minValue_) / range_;
+  bool prefer0 = CompareUtils::compare(benefit0, benefit1) > 0;
+  long double diff = prefer0 ? benefit0 - benefit1 : benefit1 - benefit0;
+  sums.sumS += w * std::abs(benefit0 - benefit1);
+  (prefer0 ? sums.sumS0 : sums.sumS1) += w * diff;
+  (prefer0 ? sums.sumSqS0 : sums.sumSqS1) += w * (diff * diff);
+}
+
+
+void NodeStats::addSums(DiffSums& sums, const DiffSums& other) {
+  sums.sumS += other.sumS;
+  sums.sumS0 += other.sumS0;
+  sums.sumS1 += other.sumS1;
+  sums.sumSqS0 += other.sumSqS0;
+  sums.sumSqS1 += other.sumSqS1;
+}
+
+
+int64_t NodeStats::getPos(int64_t attribInx, int64_t valueInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < firstPos_.size() && firstPos_[attribInx] >= 0,
+                      "NodeStats: attribute wasn't collected.");
+  ErrorUtils::enforce(valueInx >= 0 && valueInx < attribSize_[attribInx], "Out of bounds");
+  return firstPos_[attribInx] + valueInx;
+}
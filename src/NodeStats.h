@@ -0,0 +1,115 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module collects the sufficient statistics of a tree node in a single
+// pass over its samples: the class benefits and number of samples of the node
+// and of every value of the requested attributes, and optionally the sums of
+// the normalized benefit differences used by AodhaTree's impurity. Builders
+// score nominal splits from them instead of copying a DataSet per value.
+//
+
+#pragma once
+#include "DataSet.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class NodeStats {
+public:
+  // Sums of the differences d = |b0 - b1| of the normalized benefits, split by
+  // the class preferred (S0 when b0 > b1, S1 otherwise). A sample of weight w
+  // counts as w rows with its mean benefits.
+  struct DiffSums {
+    long double sumS = 0;
+    long double sumS0 = 0;
+    long double sumS1 = 0;
+    long double sumSqS0 = 0;
+    long double sumSqS1 = 0;
+  };
+
+  // Class benefits of the node and of every value of attribs. Without
+  // addSamples the statistics start empty and ds only gives the attribute
+  // sizes, e.g. to fill them with add from rows that aren't in memory, and
+  // the caller counts the rows it adds.
+  NodeStats(DataSet& ds, const std::vector<int64_t>& attribs, bool addSamples = true);
+
+  // Also the DiffSums of benefits normalized as (b - minValue) / (maxValue - minValue).
+  // Two classes only.
+  NodeStats(DataSet& ds, const std::vector<int64_t>& attribs,
+            long double minValue, long double maxValue, bool addSamples = true);
+
+  // Adds a sample given by its value index per attribute, as in
+  // Sample::inxValue_, its benefit per class and its weight
+  void add(const int64_t* inxValue, const double* benefit, int64_t weight);
+
+  // add in two steps, to fill the statistics a column at a time: addTotals
+  // once per sample and addValue once per sample and collected attribute.
+  // Calls for different attributes may run on different threads.
+  void addTotals(const double* benefit, int64_t weight);
+  void addValue(int64_t attribInx, int64_t valueInx, const double* benefit, int64_t weight);
+
+  // Takes back a sample given to add, leaving the statistics of the other
+  // samples up to rounding
+  void remove(const int64_t* inxValue, const double* benefit, int64_t weight);
+
+  // Adds the statistics of other, collected over the same attributes of a
+  // data set with the same attributes, e.g. by another thread over other rows
+  void add(const NodeStats& other);
+
+  // Number of rows, counting the weight of collapsed samples
+  int64_t getTotWeight();
+
+  // Same sums as DataSet::getClassBenefit and DataSet::getBestClass
+  double getClassBenefit(int64_t classInx);
+  std::pair<int64_t, double> getBestClass();
+
+  // True if no sample prefers a class other than the one of the rest, comparing
+  // the first two classes as the builders do. True on an empty node.
+  bool isAllSameClass();
+
+  DiffSums getDiffSums();
+
+  // True if attribInx is one of the attributes given to the constructor
+  bool isCollected(int64_t attribInx);
+
+  // Statistics of the samples with valueInx in attribInx, which must be one of
+  // the attributes given to the constructor. Same sums as getSubDataSet would give.
+  int64_t getTotWeight(int64_t attribInx, int64_t valueInx);
+  double getClassBenefit(int64_t attribInx, int64_t valueInx, int64_t classInx);
+  std::pair<int64_t, double> getBestClass(int64_t attribInx, int64_t valueInx);
+  DiffSums getDiffSums(int64_t attribInx, int64_t valueInx);
+
+  // Values of attribInx by increasing mean benefit difference b0 - b1 per row,
+  // values without samples last. Two classes only. With a split criterion
+  // convex in the class mix, some prefix of the order is the best binary split.
+  std::vector<int64_t> getValueOrder(int64_t attribInx);
+
+private:
+  void init(DataSet& ds, const std::vector<int64_t>& attribs);
+  // Adds the samples of ds and counts them as rows scanned
+  void addAll(DataSet& ds);
+  void addDiff(DiffSums& sums, const double* benefit, int64_t weight, int64_t sign = 1);
+  void addSums(DiffSums& sums, const DiffSums& other);
+  int64_t getPos(int64_t attribInx, int64_t valueInx);
+
+  int64_t totClasses_;
+  bool useDiff_;
+  long double minValue_;
+  long double range_;
+
+  int64_t totSamples_;
+  int64_t totPrefer0_;
+  int64_t totWeight_;
+  std::vector<double> classBenefit_;
+  DiffSums diffSums_;
+
+  std::vector<int64_t> attribs_;
+  // The values of attribute a are positions firstPos_[a] onwards, -1 if not collected
+  std::vector<int64_t> firstPos_;
+  std::vector<int64_t> attribSize_;
+  // By position, and by position and class
+  std::vector<int64_t> valueWeight_;
+  std::vector<double> valueBenefit_;
+  std::vector<DiffSums> valueDiffSums_;
+};
@@ -4,56 +4,82 @@
 #include "PairTree.h"
 
 #include "Attribute.h"
+#include "BestFirstTree.h"
 #include "BIT.h"
 #include "CompareUtils.h"
+#include "HardwareCounters.h"
 #include "Logger.h"
+#include "MemoryUsage.h"
+#include "NodeStats.h"
+#include "ParallelSplitSearch.h"
+#include "Profiler.h"
+#include "StreamingPairTree.h"
+#include "WorkCounters.h"
 #include "ExtrasTreeNode.h"
 
 #include <cmath>
+#include <limits>
 
 
 std::shared_ptr<DecisionTreeNode> PairTree::createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) {
   ErrorUtils::enforce(ds.getTotClasses() == 2, "Error! Number of classes must be 2.");
   
   std::shared_ptr<ConfigPairTree> config = std::static_pointer_cast<ConfigPairTree>(c);
-  BoundType boundOption;
-  if (config->boundOption.compare("DIFF") == 0) {
-    boundOption = BoundType::DIFF_BOUND;
-  }
-  else if (config->boundOption.compare("T") == 0) {
-    boundOption = BoundType::T_BOUND;
-  }
-  else if (config->boundOption.compare("VAR") == 0) {
-    boundOption = BoundType::VAR_BOUND;
+  if (config->streaming) {
+    ErrorUtils::enforce(config->maxSeconds == 0, "Error! maxSeconds can't be used with streaming.");
+    StreamingPairTree tree(ds, config);
+    tree.add(ds);
+    return tree.getTree();
+  }
+  BoundType boundOption = getBoundType(config->boundOption);
+  threads_ = config->threads;
+  parallelRows_ = config->parallelRows;
+  nominalAttribs_.clear();
+  for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
+    if (config->useNominalOrdered && ds.getAttributeType(i) == AttributeType::STRING) {
+      nominalAttribs_.push_back(i);
+    }
   }
-  else {
-    Logger::log() << "Wrong boundOption for PairTree. Using default DIFF_BOUND value.";
-    boundOption = BoundType::DIFF_BOUND;
+  if (config->maxLeaves > 0 || config->maxSeconds > 0) {
+    return BestFirstTree(config->maxLeaves, config->maxSeconds).createTree(ds, config->height,
+      [&](DataSet& nodeDS, int64_t height) {
+        return createTreeRec(nodeDS, height, config->maxBound, config->minLeaf, config->useScore,
+                             config->useNominalBinary, config->useNominalOrdered, boundOption);
+      });
   }
   return createTreeRec(ds, config->height, config->maxBound, config->minLeaf,
-                       config->useScore, config->useNominalBinary, boundOption);
+                       config->useScore, config->useNominalBinary, config->useNominalOrdered, boundOption);
 }
 
 
 std::shared_ptr<DecisionTreeNode> PairTree::createTreeRec(DataSet& ds, int height,
                                                           double maxBound,
                                                           int64_t minLeaf, bool useScore,
-                                                          bool useNominalBinary,
+                                                          bool useNominalBinary, bool useNominalOrdered,
                                                           BoundType boundType) {
-  if (height == 0 || (minLeaf > 0 && ds.samples_.size() <= minLeaf)
-      || isAllSameClass(ds)) {
-    return createLeaf(ds);
+  if (height == 0 || (minLeaf > 0 && ds.getTotWeight() <= minLeaf)) {
+    return createLeaf(ds.getBestClass().first);
+  }
+  // The split search only needs the node's class benefits here, and the values
+  // of the nominal attributes to order them
+  NodeStats stats(ds, nominalAttribs_);
+  int64_t bestClass = stats.getBestClass().first;
+  if (stats.isAllSameClass()) {
+    return createLeaf(bestClass);
   }
 
   std::vector<SampleInfo> samplesInfo;
   initSampleInfo(ds, samplesInfo);
+  // Held until the whole subtree is built
+  MemoryUsage::ScopedBytes samplesInfoBytes(MemoryUsage::SAMPLE_INFO, samplesInfo.capacity() * sizeof(SampleInfo));
 
   int bestAttrib = -1;
   double bestBound = 1;
   int64_t bestSeparator = -1;
   long double bestScore = 0;
   for (int64_t i = 0; i < ds.getTotAttributes(); i++) {
-    auto attribResult = testAttribute(ds, i, samplesInfo, useNominalBinary, boundType);
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, i);
+    auto attribResult = testAttribute(ds, stats, i, samplesInfo, useNominalBinary, useNominalOrdered, boundType);
     // If bound satisfy maxBound then gets either greatest score or lowest bound
     if (CompareUtils::compare(attribResult.bound, maxBound) < 0
         && ((useScore && CompareUtils::compare(attribResult.score, bestScore) > 0)
@@ -66,7 +92,19 @@ std::shared_ptr<DecisionTreeNode> PairTree::createTreeRec(DataSet& ds, int heigh
   }
 
   if (bestAttrib == -1) {
-    return createLeaf(ds);
+    return createLeaf(bestClass);
+  }
+
+  // Values going to the first child of a nominal split in two
+  std::vector<int64_t> leftValues;
+  if (bestSeparator != -1 && ds.getAttributeType(bestAttrib) == AttributeType::STRING) {
+    if (useNominalOrdered) {
+      std::vector<int64_t> order = stats.getValueOrder(bestAttrib);
+      leftValues.assign(order.begin(), order.begin() + bestSeparator + 1);
+      std::sort(leftValues.begin(), leftValues.end());
+    } else {
+      leftValues.push_back(bestSeparator);
+    }
   }
 
   // Nominal k-valued attribute creating k children
@@ -76,43 +114,55 @@ std::shared_ptr<DecisionTreeNode> PairTree::createTreeRec(DataSet& ds, int heigh
     for (int64_t i = 0; i < bestAttribSize; i++) {
       allDS[i].initAllAttributes(ds);
     }
-    for (const auto& s : ds.samples_) {
-      allDS[s->inxValue_[bestAttrib]].addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        allDS[s->inxValue_[bestAttrib]].addSample(s);
+      }
     }
 
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, bestAttrib);
     node->setAlpha(bestBound);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(stats.getTotWeight());
+    node->setLeafValue(bestClass);
     for (int64_t j = 0; j < bestAttribSize; j++) {
-      node->addChild(createTreeRec(allDS[j], height - 1, maxBound, minLeaf, useScore, useNominalBinary, boundType), { j });
+      node->addChild(createTreeRec(allDS[j], height - 1, maxBound, minLeaf, useScore, useNominalBinary, useNominalOrdered, boundType), { j });
     }
     return node;
 
-  // Nominal attribute separating one value from the rest
+  // Nominal attribute separating leftValues from the rest
   } else if (bestSeparator != -1 && ds.getAttributeType(bestAttrib) == AttributeType::STRING) {
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, bestAttrib);
     node->setAlpha(bestBound);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(stats.getTotWeight());
+    node->setLeafValue(bestClass);
 
+    std::vector<bool> isLeft(ds.getAttributeSize(bestAttrib), false);
+    for (auto j : leftValues) {
+      isLeft[j] = true;
+    }
     DataSet leftDS, rightDS;
     leftDS.initAllAttributes(ds);
     rightDS.initAllAttributes(ds);
-    for (const auto& s : ds.samples_) {
-      if (s->inxValue_[bestAttrib] == bestSeparator) {
-        leftDS.addSample(s);
-      } else {
-        rightDS.addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        if (isLeft[s->inxValue_[bestAttrib]]) {
+          leftDS.addSample(s);
+        } else {
+          rightDS.addSample(s);
+        }
       }
     }
     
-    node->addChild(createTreeRec(leftDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, boundType), { bestSeparator });
+    node->addChild(createTreeRec(leftDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, useNominalOrdered, boundType), leftValues);
     std::vector<int64_t> rightInxs;
     for (int64_t i = 0; i < ds.getAttributeSize(bestAttrib); i++) {
-      if (i != bestSeparator) rightInxs.push_back(i);
+      if (!isLeft[i]) rightInxs.push_back(i);
     }
-    node->addChild(createTreeRec(rightDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, boundType), rightInxs);
+    node->addChild(createTreeRec(rightDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, useNominalOrdered, boundType), rightInxs);
 
     return node;
 
@@ -120,59 +170,64 @@ std::shared_ptr<DecisionTreeNode> PairTree::createTreeRec(DataSet& ds, int heigh
   } else {
     std::shared_ptr<ExtrasTreeNode> node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_ORDERED, bestAttrib, bestSeparator);
     node->setAlpha(bestBound);
-    node->setNumSamples(ds.samples_.size());
-    node->setLeafValue(ds.getBestClass().first);
+    node->setNumSamples(stats.getTotWeight());
+    node->setLeafValue(bestClass);
     DataSet leftDS, rightDS;
     leftDS.initAllAttributes(ds);
     rightDS.initAllAttributes(ds);
-    for (const auto& s : ds.samples_) {
-      if (s->inxValue_[bestAttrib] <= bestSeparator) {
-        leftDS.addSample(s);
-      } else {
-        rightDS.addSample(s);
+    {
+      Profiler::ScopedTimer timer(Profiler::PARTITIONING);
+      HardwareCounters::ScopedRegion region(HardwareCounters::PARTITIONING);
+      for (const auto& s : ds.samples_) {
+        if (s->inxValue_[bestAttrib] <= bestSeparator) {
+          leftDS.addSample(s);
+        } else {
+          rightDS.addSample(s);
+        }
       }
     }
-    node->addLeftChild(createTreeRec(leftDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, boundType));
-    node->addRightChild(createTreeRec(rightDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, boundType));
+    node->addLeftChild(createTreeRec(leftDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, useNominalOrdered, boundType));
+    node->addRightChild(createTreeRec(rightDS, height - 1, maxBound, minLeaf, useScore, useNominalBinary, useNominalOrdered, boundType));
     return node;
   }
 }
 
 
-std::shared_ptr<DecisionTreeNode> PairTree::createLeaf(DataSet& ds) {
-  auto best = ds.getBestClass();
+PairTree::BoundType PairTree::getBoundType(const std::string& boundOption) {
+  if (boundOption.compare("DIFF") == 0) {
+    return BoundType::DIFF_BOUND;
+  }
+  else if (boundOption.compare("T") == 0) {
+    return BoundType::T_BOUND;
+  }
+  else if (boundOption.compare("VAR") == 0) {
+    return BoundType::VAR_BOUND;
+  }
+  Logger::log() << "Wrong boundOption for PairTree. Using default DIFF_BOUND value.";
+  return BoundType::DIFF_BOUND;
+}
 
-  std::shared_ptr<ExtrasTreeNode> leaf = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::LEAF);
-  leaf->setName("LEAF " + std::to_string(best.first));
-  leaf->setLeafValue(best.first);
 
-  return leaf;
-}
+std::shared_ptr<DecisionTreeNode> PairTree::createLeaf(int64_t leafValue) {
+  Profiler::ScopedTimer timer(Profiler::LEAF_CREATION);
 
+  std::shared_ptr<ExtrasTreeNode> leaf = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::LEAF);
+  leaf->setName("LEAF " + std::to_string(leafValue));
+  leaf->setLeafValue(leafValue);
 
-bool PairTree::isAllSameClass(DataSet& ds) {
-  int64_t tot0 = 0;
-  int64_t tot1 = 0;
-  for (auto s : ds.samples_) {
-    if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) >= 0) {
-      tot0++;
-    }
-    else {
-      tot1++;
-    }
-    if (tot0 > 0 && tot1 > 0) return false;
-  }
-  return tot0 == 0 || tot1 == 0;
+  return leaf;
 }
 
 
-PairTree::AttribResult PairTree::testAttribute(DataSet& ds, int64_t attribInx,
+PairTree::AttribResult PairTree::testAttribute(DataSet& ds, NodeStats& stats, int64_t attribInx,
                                                std::vector<PairTree::SampleInfo>& samplesInfo,
-                                               bool useNominalBinary,
+                                               bool useNominalBinary, bool useNominalOrdered,
                                                BoundType boundType) {
   if (ds.getAttributeType(attribInx) == AttributeType::INTEGER
       || ds.getAttributeType(attribInx) == AttributeType::DOUBLE) {
     return testNumeric(ds, attribInx, samplesInfo, boundType);
+  } else if (useNominalOrdered) {
+    return testNominalOrdered(ds, stats, attribInx, samplesInfo, boundType);
   } else {
     return testNominal(ds, attribInx, samplesInfo, useNominalBinary, boundType);
   }
@@ -191,13 +246,14 @@ PairTree::AttribResult PairTree::testNominal(DataSet& ds, int64_t attribInx,
   // Else only needs to test boxZero = -1
   int64_t maxSplits = useNominalBinary ? attribSize : 0;
   int64_t startSplit = useNominalBinary ? 0 : -1;
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, maxSplits - startSplit);
   for (int64_t i = startSplit; i < maxSplits; i++) {
     int64_t boxZero = i;
     std::function<int64_t(int64_t)> valueBox = [boxZero](int64_t inxValue) {
       if (boxZero < 0) {
         return inxValue;
       }
-      return inxValue == boxZero ? 0ll : 1ll;
+      return inxValue == boxZero ? (int64_t)0 : (int64_t)1;
     };
 
     auto scoreResult = calcNominalScore(ds, attribInx, valueBox, boxZero == -1 ? attribSize : 2, samplesInfo);
@@ -215,16 +271,34 @@ PairTree::AttribResult PairTree::testNominal(DataSet& ds, int64_t attribInx,
 }
 
 
+// Ranks the values by NodeStats::getValueOrder and sweeps them as an ordered attribute
+PairTree::AttribResult PairTree::testNominalOrdered(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                                    std::vector<PairTree::SampleInfo>& samplesInfo,
+                                                    BoundType boundType) {
+  std::vector<int64_t> order = stats.getValueOrder(attribInx);
+  std::vector<int64_t> rank(order.size());
+  for (int64_t p = 0; p < order.size(); p++) {
+    rank[order[p]] = p;
+  }
+  std::function<int64_t(int64_t)> valueBox = [&rank](int64_t inxValue) { return rank[inxValue]; };
+  return testNumeric(ds, attribInx, samplesInfo, boundType, valueBox);
+}
+
+
 PairTree::AttribScoreResult PairTree::calcNominalScore(DataSet& ds, int64_t attribInx,
                                                        std::function<int64_t(int64_t)> valueBox,
                                                        int64_t attribSize,
                                                        std::vector<PairTree::SampleInfo>& samplesInfo) {
+  HardwareCounters::ScopedRegion region(HardwareCounters::NOMINAL_SCORE);
+  WorkCounters::addRows(attribInx, samplesInfo.size());
   std::vector<double> distrib(attribSize);
+  int64_t totWeight = 0;
   for (int64_t i = 0; i < samplesInfo.size(); i++) {
-    distrib[valueBox(samplesInfo[i].ptr->inxValue_[attribInx])]++;
+    distrib[valueBox(samplesInfo[i].ptr->inxValue_[attribInx])] += samplesInfo[i].weight;
+    totWeight += samplesInfo[i].weight;
   }
   for (int64_t j = 0; j < attribSize; j++) {
-    distrib[j] = distrib[j] / samplesInfo.size();
+    distrib[j] = distrib[j] / totWeight;
   }
 
   // totalClass[0] = number of samples whose best class is 0
@@ -233,17 +307,17 @@ PairTree::AttribScoreResult PairTree::calcNominalScore(DataSet& ds, int64_t attr
   std::vector<std::vector<int64_t>> totalValueClass(attribSize, std::vector<int64_t>(2, 0));
 
   for (auto s : samplesInfo) {
-    totalClass[s.bestClass]++;
-    totalValueClass[valueBox(s.ptr->inxValue_[attribInx])][s.bestClass]++;
+    totalClass[s.bestClass] += s.weight;
+    totalValueClass[valueBox(s.ptr->inxValue_[attribInx])][s.bestClass] += s.weight;
   }
   int64_t totPairs = totalClass[0] * totalClass[1];
 
   long double score = 0;
   for (auto s : samplesInfo) {
     int notBestClass = (s.bestClass + 1) % 2;
-    score += s.diff * (totalClass[notBestClass] - totalValueClass[valueBox(s.ptr->inxValue_[attribInx])][notBestClass]);
-    totalClass[s.bestClass]--;
-    totalValueClass[valueBox(s.ptr->inxValue_[attribInx])][s.bestClass]--;
+    score += s.diff * s.weight * (totalClass[notBestClass] - totalValueClass[valueBox(s.ptr->inxValue_[attribInx])][notBestClass]);
+    totalClass[s.bestClass] -= s.weight;
+    totalValueClass[valueBox(s.ptr->inxValue_[attribInx])][s.bestClass] -= s.weight;
   }
 
   AttribScoreResult ans;
@@ -257,9 +331,20 @@ PairTree::AttribScoreResult PairTree::calcNominalScore(DataSet& ds, int64_t attr
 PairTree::AttribResult PairTree::testNumeric(DataSet& ds, int64_t attribInx,
                                              std::vector<PairTree::SampleInfo>& samplesInfo,
                                              BoundType boundType) {
+  std::function<int64_t(int64_t)> valueBox = [](int64_t inxValue) { return inxValue; };
+  return testNumeric(ds, attribInx, samplesInfo, boundType, valueBox);
+}
+
+
+PairTree::AttribResult PairTree::testNumeric(DataSet& ds, int64_t attribInx,
+                                             std::vector<PairTree::SampleInfo>& samplesInfo,
+                                             BoundType boundType,
+                                             std::function<int64_t(int64_t)> valueBox) {
+  HardwareCounters::ScopedRegion region(HardwareCounters::NUMERIC_SPLIT);
   // Calculate the sum on formula E[Gain(A)] = 2*p(1-p) * \sum_{i=1...N}{D(s_i) * TC^i_{notC}}
   // The following variables will be used later to calculate the bound for a splitting parameter
-  auto randomScore = getRandomScore(samplesInfo, std::vector<double>{ 0.5, 0.5 });
+  std::vector<double> halfDistrib{ 0.5, 0.5 };
+  auto randomScore = getRandomScore(samplesInfo, halfDistrib);
   long double randomSum = 2 * randomScore.first;
   BoundConstants constants;
   BoundConstants extraConstants;
@@ -278,9 +363,63 @@ PairTree::AttribResult PairTree::testNumeric(DataSet& ds, int64_t attribInx,
 
   long double bestBound = 1;
   long double bestScore = 0;
-  int64_t bestLeftSize = 0;
   int64_t bestSeparator = 0;
   int64_t totSamples = ds.samples_.size();
+  int64_t totWeight = 0;
+  for (const auto& info : samplesInfo) {
+    totWeight += info.weight;
+  }
+  int64_t totCandidates = 0;
+  // Scores the split of the samples with a value up to separator
+  auto testSeparator = [&](long double score, int64_t leftWeight, int64_t separator) {
+    totCandidates++;
+    long double p = leftWeight / ((long double)totWeight);
+    long double expected = 2 * p * (1 - p) * randomSum;
+    long double bound;
+
+    if (boundType != BoundType::VAR_BOUND) {
+      bound = applyBound(score - expected, constants, boundType);
+    }
+    else {
+      long double splitProb = 2 * p * (1 - p);
+      constants.S = sumDSq * (splitProb - splitProb * splitProb);
+      constants.b = maxG * (1 - splitProb);
+
+      bound = applyBound(score - expected, constants, BoundType::VAR_BOUND);
+      long double diffBound = applyBound(score - expected, extraConstants, BoundType::DIFF_BOUND);
+      bound = std::min(bound, diffBound);
+    }
+    if (CompareUtils::compare(bound, bestBound) < 0) {
+      bestSeparator = separator;
+      bestBound = bound;
+      bestScore = score;
+    }
+  };
+
+  // Huge nodes sum per-value scores computed by rows on several threads
+  if (threads_ != 1 && totSamples >= parallelRows_) {
+    std::vector<long double> boxScore;
+    std::vector<int64_t> boxWeight;
+    ParallelSplitSearch(threads_).calcPairScores(samplesInfo, attribInx, valueBox,
+                                                 ds.getAttributeSize(attribInx), boxScore, boxWeight);
+    long double score = 0;
+    int64_t leftWeight = 0;
+    for (int64_t b = 0; b < boxScore.size(); b++) {
+      if (boxWeight[b] > 0) {
+        score += boxScore[b];
+        leftWeight += boxWeight[b];
+        testSeparator(score, leftWeight, b);
+      }
+    }
+    WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
+
+    AttribResult ans;
+    ans.score = bestScore;
+    ans.bound = bestBound;
+    ans.separator = bestSeparator;
+    return ans;
+  }
+  int64_t leftWeight = 0;
 
   // Sort all samples by attribute attribInx
   struct Order {
@@ -288,10 +427,12 @@ PairTree::AttribResult PairTree::testNumeric(DataSet& ds, int64_t attribInx,
     int64_t posDiff;
   };
   std::vector<Order> ordSamples(totSamples);
+  WorkCounters::addRows(attribInx, totSamples);
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, totSamples * sizeof(Order));
   for (int64_t i = 0; i < samplesInfo.size(); i++) {
     Order aux;
     aux.posDiff = i;
-    aux.attribValue = samplesInfo[i].ptr->inxValue_[attribInx];
+    aux.attribValue = valueBox(samplesInfo[i].ptr->inxValue_[attribInx]);
     ordSamples[i] = aux;
   }
   std::sort(ordSamples.begin(), ordSamples.end(), [](const Order& a, const Order& b) { return a.attribValue < b.attribValue; });
@@ -301,86 +442,69 @@ PairTree::AttribResult PairTree::testNumeric(DataSet& ds, int64_t attribInx,
   std::vector<std::vector<BIT>> sumRight(2, std::vector<BIT>(2, totSamples));
   std::vector<BIT> countRight(2, totSamples);
 
-  // Put all samples to the right
+  // Put all samples to the right. Counts are weights; a sample of weight w pairs
+  // with every other sample w times, so the benefit sums it reads are scaled by w.
   for (int64_t i = 0; i < ordSamples.size(); i++) {
     int64_t posDiff = ordSamples[i].posDiff;
     int64_t bestClass = samplesInfo[posDiff].bestClass;
-    countRight[bestClass].update(posDiff + 1, 1);
+    countRight[bestClass].update(posDiff + 1, samplesInfo[posDiff].weight);
     sumRight[bestClass][0].update(posDiff + 1, samplesInfo[posDiff].ptr->benefit_[0]);
     sumRight[bestClass][1].update(posDiff + 1, samplesInfo[posDiff].ptr->benefit_[1]);
   }
   
   long double score = 0;
-  int64_t i = 0;
   for (int64_t i = 0; i < totSamples; i++) {
     int64_t posDiff = ordSamples[i].posDiff;
     int bestClass = samplesInfo[posDiff].bestClass;
     int worstClass = (bestClass + 1) % 2;
+    double weight = samplesInfo[posDiff].weight;
 
     // First part max{B(x,0), B(x,1)} + max{B(y,0), B(y,1)}
     score -= (countLeft[worstClass].get(totSamples) * samplesInfo[posDiff].ptr->benefit_[bestClass]
-              + sumLeft[worstClass][worstClass].get(totSamples));
+              + weight * sumLeft[worstClass][worstClass].get(totSamples));
     score += (countRight[worstClass].get(totSamples) * samplesInfo[posDiff].ptr->benefit_[bestClass]
-              + sumRight[worstClass][worstClass].get(totSamples));
+              + weight * sumRight[worstClass][worstClass].get(totSamples));
 
     // Second part
     // C1 = {p | p in S_notC AND D(p) < D(s) AND Ai(p) < Ai(s)}
     //ans -= countLeft[notC].get(i - 1) * B(s, c)
     //ans -= sumLeft[notC][c].get(i - 1)
     score += countLeft[worstClass].get(posDiff) * samplesInfo[posDiff].ptr->benefit_[bestClass];
-    score += sumLeft[worstClass][bestClass].get(posDiff);
+    score += weight * sumLeft[worstClass][bestClass].get(posDiff);
 
     // C2 = {p | p in S_notC AND D(p) > D(s) AND Ai(p) < Ai(s)}
     //ans -= (countLeft[notC].get(N) - countLeft[notC].get(i)) * B(s, notC)
     //ans -= (sumLeft[notC][notC].get(N) - sumLeft[notC][notC].get(i))
     score += (countLeft[worstClass].get(totSamples) - countLeft[worstClass].get(posDiff+1)) * samplesInfo[posDiff].ptr->benefit_[worstClass];
-    score += (sumLeft[worstClass][worstClass].get(totSamples) - sumLeft[worstClass][worstClass].get(posDiff+1));
+    score += weight * (sumLeft[worstClass][worstClass].get(totSamples) - sumLeft[worstClass][worstClass].get(posDiff+1));
 
     // C3 = {p | p in S_notC AND D(p) < D(s) AND Ai(p) > Ai(s)}
     //ans += countRight[notC].get(i - 1) * B(s, c)
     //ans += sumRight[notC][c].get(i - 1)
     score -= countRight[worstClass].get(posDiff) * samplesInfo[posDiff].ptr->benefit_[bestClass];
-    score -= sumRight[worstClass][bestClass].get(posDiff);
+    score -= weight * sumRight[worstClass][bestClass].get(posDiff);
 
     // C4 = {p | p in S_notC AND D(p) > D(s) AND Ai(p) > Ai(s)}
     //ans += (countRight[notC].get(N) - countRight[notC].get(i)) * B(s, notC)
     //ans += (sumRight[notC][notC].get(N) - sumRight[notC][notC].get(i))
     score -= (countRight[worstClass].get(totSamples) - countRight[worstClass].get(posDiff+1)) * samplesInfo[posDiff].ptr->benefit_[worstClass];
-    score -= (sumRight[worstClass][worstClass].get(totSamples) - sumRight[worstClass][worstClass].get(posDiff+1));
+    score -= weight * (sumRight[worstClass][worstClass].get(totSamples) - sumRight[worstClass][worstClass].get(posDiff+1));
 
     sumLeft[bestClass][0].update(posDiff + 1, samplesInfo[posDiff].ptr->benefit_[0]);
     sumLeft[bestClass][1].update(posDiff + 1, samplesInfo[posDiff].ptr->benefit_[1]);
-    countLeft[bestClass].update(posDiff + 1, 1);
+    countLeft[bestClass].update(posDiff + 1, weight);
     sumRight[bestClass][0].update(posDiff + 1, -samplesInfo[posDiff].ptr->benefit_[0]);
     sumRight[bestClass][1].update(posDiff + 1, -samplesInfo[posDiff].ptr->benefit_[1]);
-    countRight[bestClass].update(posDiff + 1, -1);
+    countRight[bestClass].update(posDiff + 1, -weight);
+    leftWeight += samplesInfo[posDiff].weight;
 
     if (i == totSamples - 1 || (ordSamples[i].attribValue != ordSamples[i + 1].attribValue)) {
-      long double p = (i + 1) / ((long double)totSamples);
-      long double expected = 2 * p * (1 - p) * randomSum;
-      long double bound;
-
-      if (boundType != BoundType::VAR_BOUND) {
-        bound = applyBound(score - expected, constants, boundType);
-      }
-      else {
-        long double splitProb = 2 * p * (1 - p);
-        constants.S = sumDSq * (splitProb - splitProb * splitProb);
-        constants.b = maxG * (1 - splitProb);
-
-        bound = applyBound(score - expected, constants, BoundType::VAR_BOUND);
-        long double diffBound = applyBound(score - expected, extraConstants, BoundType::DIFF_BOUND);
-        bound = std::min(bound, diffBound);
-      }
-      if (CompareUtils::compare(bound, bestBound) < 0) {
-        bestSeparator = ordSamples[i].attribValue;
-        bestBound = bound;
-        bestScore = score;
-        bestLeftSize = i + 1;
-      }
+      testSeparator(score, leftWeight, ordSamples[i].attribValue);
     }
   }
 
+  WorkCounters::add(WorkCounters::SPLIT_CANDIDATES, totCandidates);
+
   AttribResult ans;
   ans.score = bestScore;
   ans.bound = bestBound;
@@ -395,7 +519,7 @@ std::pair<long double, long double> PairTree::getRandomScore(std::vector<PairTre
   int64_t attribSize = distrib.size();
   std::vector<int64_t> totalClass(2, 0); // totalClass[0] = number of samples whose best class is 0
   for (auto s : samplesInfo) {
-    totalClass[s.bestClass]++;
+    totalClass[s.bestClass] += s.weight;
   }
   int64_t totPairs = totalClass[0] * totalClass[1];
   std::vector<int64_t> totalClassCopy = totalClass;
@@ -405,9 +529,9 @@ std::pair<long double, long double> PairTree::getRandomScore(std::vector<PairTre
     int notBestClass = (s.bestClass + 1) % 2;
     for (int j = 0; j < attribSize; j++) {
       double p = distrib[j];
-      expected += s.diff * totalClass[notBestClass] * p * (1 - p);
+      expected += s.diff * s.weight * totalClass[notBestClass] * p * (1 - p);
     }
-    totalClass[s.bestClass]--;
+    totalClass[s.bestClass] -= s.weight;
   }
   expected = expected / totPairs;
 
@@ -417,9 +541,10 @@ std::pair<long double, long double> PairTree::getRandomScore(std::vector<PairTre
     int notBestClass = (s.bestClass + 1) % 2;
     for (int j = 0; j < attribSize; j++) {
       double p = distrib[j];
-      var += (((long double)s.diff) - expected) * (((long double)s.diff) - expected) * totalClass[notBestClass] * p * (1 - p);
+      var += (((long double)s.diff) - expected) * (((long double)s.diff) - expected) * s.weight
+             * totalClass[notBestClass] * p * (1 - p);
     }
-    totalClass[s.bestClass]--;
+    totalClass[s.bestClass] -= s.weight;
   }
   var = var / totPairs;
   long double std = sqrt(var);
@@ -443,6 +568,7 @@ long double PairTree::getAttribBound(DataSet& ds, AttribScoreResult& attribResul
 
 
 long double PairTree::applyBound(long double t, BoundConstants constants, BoundType boundType) {
+  WorkCounters::add(WorkCounters::BOUND_EVALUATIONS);
   // The bounds only work for t > 0
   if (CompareUtils::compare(t, 0) <= 0) {
     return 1;
@@ -498,10 +624,10 @@ long double PairTree::calcConstXstar(DataSet& ds) {
   int64_t best1 = 0;
   for (auto s : ds.samples_) {
     if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) > 0) {
-      best0++;
+      best0 += s->weight_;
     }
     else {
-      best1++;
+      best1 += s->weight_;
     }
   }
   return std::max(best0, best1);
@@ -513,14 +639,14 @@ long double PairTree::calcConstSumDSq(int64_t attribInx,
   std::vector<int64_t> totalClass(2, 0); // totalClass[0] = number of samples whose best class is 0
 
   for (auto s : samplesInfo) {
-    totalClass[s.bestClass]++;
+    totalClass[s.bestClass] += s.weight;
   }
 
   long double sumDSq = 0;
   for (auto s : samplesInfo) {
     int notBestClass = (s.bestClass + 1) % 2;
-    sumDSq += (s.diff * s.diff) * totalClass[notBestClass];
-    totalClass[s.bestClass]--;
+    sumDSq += (s.diff * s.diff) * s.weight * totalClass[notBestClass];
+    totalClass[s.bestClass] -= s.weight;
   }
 
   return sumDSq;
@@ -567,10 +693,10 @@ long double PairTree::calcMaxD(DataSet& ds) {
   long double maxBest1 = std::numeric_limits<long double>::min();
   for (auto s : ds.samples_) {
     if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) > 0) {
-      maxBest0 = std::max(maxBest0, (long double)s->benefit_[0] - s->benefit_[1]);
+      maxBest0 = std::max(maxBest0, ((long double)s->benefit_[0] - s->benefit_[1]) / s->weight_);
     }
     else {
-      maxBest1 = std::max(maxBest1, (long double)s->benefit_[1] - s->benefit_[0]);
+      maxBest1 = std::max(maxBest1, ((long double)s->benefit_[1] - s->benefit_[0]) / s->weight_);
     }
   }
   
@@ -591,23 +717,29 @@ long double PairTree::calcSplitProb(DataSet& ds, int64_t attribInx) {
 
 void PairTree::createTwoDiffs(DataSet& ds, std::vector<long double>& s0,
                               std::vector<long double>& s1) {
+  // A sample of weight w gives w rows with its mean benefits
   int64_t totS0 = 0;
+  int64_t totS1 = 0;
   for (auto& s : ds.samples_) {
     if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) > 0) {
-      totS0++;
+      totS0 += s->weight_;
+    } else {
+      totS1 += s->weight_;
     }
   }
-  int64_t totS1 = ds.samples_.size() - totS0;
   s0.resize(totS0);
   s1.resize(totS1);
   int64_t countS0 = 0;
   int64_t countS1 = 0;
   for (auto& s : ds.samples_) {
-    if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) > 0) {
-      s0[countS0++] = (s->benefit_[0] - s->benefit_[1])*(s->benefit_[0] - s->benefit_[1]);
-    }
-    else {
-      s1[countS1++] = (s->benefit_[1] - s->benefit_[0])*(s->benefit_[1] - s->benefit_[0]);
+    double diff = (s->benefit_[0] - s->benefit_[1]) / s->weight_;
+    for (int64_t w = 0; w < s->weight_; w++) {
+      if (CompareUtils::compare(s->benefit_[0], s->benefit_[1]) > 0) {
+        s0[countS0++] = diff * diff;
+      }
+      else {
+        s1[countS1++] = diff * diff;
+      }
     }
   }
 }
@@ -714,6 +846,7 @@ bool compareSampleInfo(const PairTree::SampleInfo& a, const PairTree::SampleInfo
 
 void PairTree::initSampleInfo(DataSet& ds, std::vector<PairTree::SampleInfo>& samplesInfo) {
   samplesInfo.resize(ds.samples_.size());
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, samplesInfo.size() * sizeof(SampleInfo));
   int64_t count = 0;
   for (auto s : ds.samples_) {
     SampleInfo info;
@@ -724,7 +857,8 @@ void PairTree::initSampleInfo(DataSet& ds, std::vector<PairTree::SampleInfo>& sa
     else {
       info.bestClass = 1;
     }
-    info.diff = std::abs(s->benefit_[0] - s->benefit_[1]);
+    info.diff = std::abs(s->benefit_[0] - s->benefit_[1]) / s->weight_;
+    info.weight = s->weight_;
 
     samplesInfo[count++] = info;
   }
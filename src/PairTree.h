@@ -2,6 +2,7 @@
 // License: BSD 3 clause
 
 #pragma once
+#include "NodeStats.h"
 #include "Tree.h"
 
 #include <functional>
@@ -14,7 +15,26 @@ public:
   int64_t minLeaf;
   bool useScore;
   bool useNominalBinary;
+  // Splits nominal attributes in two by the order of NodeStats::getValueOrder,
+  // instead of one value against the rest
+  bool useNominalOrdered = false;
+  // Grows the tree best first with BestFirstTree until it has maxLeaves leaves
+  // or maxSeconds have passed, 0 for no limit on either
+  int64_t maxLeaves = 0;
+  double maxSeconds = 0;
   std::string boundOption;
+  // Learns the tree in a single pass over the samples with StreamingPairTree,
+  // splitting a leaf once the bound of its best split drops below maxBound
+  bool streaming = false;
+  // Streaming only: rows a leaf takes between split checks, and most boxes of
+  // consecutive values an attribute keeps statistics for in each leaf
+  int64_t gracePeriod = 200;
+  int64_t valueBoxes = 32;
+  // Nodes of at least parallelRows samples sweep each ordered attribute on
+  // threads threads, each taking a range of the rows (ParallelSplitSearch).
+  // 0 threads uses every hardware thread.
+  int64_t threads = 1;
+  int64_t parallelRows = 1000000;
   std::vector<long double> alphas;
   std::vector<int64_t> minSamples;
 };
@@ -23,13 +43,20 @@ class PairTree : public Tree {
 public:
   std::shared_ptr<DecisionTreeNode> createTree(DataSet& ds, std::shared_ptr<ConfigTree> c) override;
 
+  // diff is the benefit difference of a single row, a collapsed sample stands
+  // for weight rows with its mean benefits
   struct SampleInfo {
     std::shared_ptr<Sample> ptr;
     int bestClass;
     double diff;
+    int64_t weight;
   };
 
 private:
+  friend class BenchmarkSuite;
+  // Bounds splits from histograms of the samples
+  friend class StreamingPairTree;
+
   enum BoundType { DIFF_BOUND, T_BOUND, VAR_BOUND };
   struct BoundConstants {
     long double xstar;
@@ -51,18 +78,26 @@ private:
   std::shared_ptr<DecisionTreeNode> createTreeRec(DataSet& ds, int height,
                                                   double maxBound,
                                                   int64_t minLeaf, bool useScore,
-                                                  bool useNominalBinary,
+                                                  bool useNominalBinary, bool useNominalOrdered,
                                                   BoundType boundType);
-  std::shared_ptr<DecisionTreeNode> createLeaf(DataSet& ds);
-  bool isAllSameClass(DataSet& ds);
+  static BoundType getBoundType(const std::string& boundOption);
+  std::shared_ptr<DecisionTreeNode> createLeaf(int64_t leafValue);
   void initSampleInfo(DataSet& ds, std::vector<PairTree::SampleInfo>& samplesInfo);
 
-  AttribResult testAttribute(DataSet& ds, int64_t attribInx,
+  AttribResult testAttribute(DataSet& ds, NodeStats& stats, int64_t attribInx,
                              std::vector<PairTree::SampleInfo>& samplesInfo,
-                             bool useNominalBinary, BoundType boundType);
+                             bool useNominalBinary, bool useNominalOrdered, BoundType boundType);
   AttribResult testNumeric(DataSet& ds, int64_t attribInx,
                            std::vector<PairTree::SampleInfo>& samplesInfo,
                            BoundType boundType);
+  // Sweeps the samples by valueBox of their value, the separator is a box
+  AttribResult testNumeric(DataSet& ds, int64_t attribInx,
+                           std::vector<PairTree::SampleInfo>& samplesInfo,
+                           BoundType boundType, std::function<int64_t(int64_t)> valueBox);
+  // The separator is the last position of the value order going to the left
+  AttribResult testNominalOrdered(DataSet& ds, NodeStats& stats, int64_t attribInx,
+                                  std::vector<PairTree::SampleInfo>& samplesInfo,
+                                  BoundType boundType);
   AttribResult testNominal(DataSet& ds, int64_t attribInx,
                            std::vector<PairTree::SampleInfo>& samplesInfo,
                            bool useNominalBinary, BoundType boundType);
@@ -95,6 +130,11 @@ private:
   void createTwoDiffs(DataSet& ds, std::vector<long double>& s0, std::vector<long double>& s1);
   long double calcMaxD(DataSet& ds);
   long double calcSplitProb(DataSet& ds, int64_t attribInx);
+
+  // Attributes whose values NodeStats orders, only with useNominalOrdered
+  std::vector<int64_t> nominalAttribs_;
+  int64_t threads_ = 1;
+  int64_t parallelRows_ = 0;
   
   
 };
@@ -0,0 +1,226 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "ParallelSplitSearch.h"
+
+#include "BIT.h"
+#include "WorkCounters.h"
+
+#include <algorithm>
+#include <thread>
+
+
+ParallelSplitSearch::ParallelSplitSearch(int64_t threads) : threads_(threads) {
+  if (threads_ <= 0) {
+    threads_ = std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+}
+
+
+std::unique_ptr<NodeStats> ParallelSplitSearch::createStats(DataSet& ds, const std::vector<int64_t>& attribs) {
+  return createStats(ds, attribs, [&attribs](DataSet& shape) { return new NodeStats(shape, attribs, false); });
+}
+
+
+std::unique_ptr<NodeStats> ParallelSplitSearch::createStats(DataSet& ds, const std::vector<int64_t>& attribs,
+                                                            long double minValue, long double maxValue) {
+  return createStats(ds, attribs,
+                     [&](DataSet& shape) { return new NodeStats(shape, attribs, minValue, maxValue, false); });
+}
+
+
+std::unique_ptr<NodeStats> ParallelSplitSearch::createStats(DataSet& ds, const std::vector<int64_t>& attribs,
+                                                            std::function<NodeStats*(DataSet&)> create) {
+  std::vector<Sample*> rows;
+  rows.reserve(ds.samples_.size());
+  for (const auto& s : ds.samples_) {
+    rows.push_back(s.get());
+  }
+  // Without samples, the attribute sizes are all the statistics need
+  DataSet shape;
+  shape.initAllAttributes(ds);
+  std::unique_ptr<NodeStats> stats(create(shape));
+  std::vector<std::unique_ptr<NodeStats>> partial(threads_);
+  run([&](int64_t t) {
+    partial[t].reset(create(shape));
+    int64_t first = getFirst(t, rows.size());
+    int64_t last = getFirst(t + 1, rows.size());
+    for (int64_t i = first; i < last; i++) {
+      partial[t]->add(rows[i]->inxValue_.data(), rows[i]->benefit_.data(), rows[i]->weight_);
+    }
+    for (auto a : attribs) {
+      WorkCounters::addRows(a, last - first);
+    }
+  });
+  for (const auto& p : partial) {
+    stats->add(*p);
+  }
+  return stats;
+}
+
+
+// The samples are cut into chunks of consecutive boxes, one per thread. A
+// pass over the samples in diff order, split into ranges, gives each sample
+// its score against all samples of the other class, and against the ones of
+// earlier chunks, from prefix sums by chunk of the ranges before. A sweep of
+// each chunk in box order adds the score against the earlier samples of the
+// chunk with Fenwick trees over the diff order, as PairTree::testNumeric does.
+void ParallelSplitSearch::calcPairScores(const std::vector<PairTree::SampleInfo>& samplesInfo, int64_t attribInx,
+                                         std::function<int64_t(int64_t)> valueBox, int64_t totBoxes,
+                                         std::vector<long double>& boxScore, std::vector<int64_t>& boxWeight) {
+  int64_t n = samplesInfo.size();
+  int64_t totChunks = threads_;
+  boxScore.assign(totBoxes, 0);
+  boxWeight.assign(totBoxes, 0);
+  std::vector<int64_t> box(n);
+  std::vector<int32_t> chunk(n);
+  std::vector<long double> pairScore(n);
+  std::vector<int64_t> chunkRows(n);
+  WorkCounters::addRows(attribInx, n);
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED,
+                    n * (2 * sizeof(int64_t) + sizeof(int32_t) + sizeof(long double)));
+  run([&](int64_t t) {
+    for (int64_t i = getFirst(t, n); i < getFirst(t + 1, n); i++) {
+      box[i] = valueBox(samplesInfo[i].ptr->inxValue_[attribInx]);
+    }
+  });
+
+  // Chunk c holds the boxes from firstBox[c], cut at quantiles of a sample
+  // of the boxes
+  std::vector<int64_t> sampled;
+  int64_t step = std::max<int64_t>(1, n / (64 * totChunks));
+  for (int64_t i = 0; i < n; i += step) {
+    sampled.push_back(box[i]);
+  }
+  std::sort(sampled.begin(), sampled.end());
+  std::vector<int64_t> firstBox(totChunks + 1, totBoxes);
+  firstBox[0] = 0;
+  for (int64_t c = 1; c < totChunks && !sampled.empty(); c++) {
+    firstBox[c] = sampled[c * sampled.size() / totChunks];
+  }
+
+  // Weights and weighted diffs by range, chunk and class
+  auto pos = [totChunks](int64_t r, int64_t c, int64_t k) { return (r * totChunks + c) * 2 + k; };
+  std::vector<int64_t> rangeRows(totChunks * totChunks, 0);
+  std::vector<long double> rangeWeight(totChunks * totChunks * 2, 0);
+  std::vector<long double> rangeDiff(totChunks * totChunks * 2, 0);
+  run([&](int64_t r) {
+    for (int64_t i = getFirst(r, n); i < getFirst(r + 1, n); i++) {
+      int64_t c = std::upper_bound(firstBox.begin() + 1, firstBox.begin() + totChunks, box[i])
+                  - (firstBox.begin() + 1);
+      chunk[i] = c;
+      const auto& info = samplesInfo[i];
+      rangeRows[r * totChunks + c]++;
+      rangeWeight[pos(r, c, info.bestClass)] += info.weight;
+      rangeDiff[pos(r, c, info.bestClass)] += info.weight * (long double)info.diff;
+    }
+  });
+
+  // Exclusive prefix sums over the ranges, and the row lists of the chunks
+  // in range order, that is in diff order
+  std::vector<int64_t> rowOffset(totChunks * totChunks);
+  std::vector<int64_t> chunkBegin(totChunks + 1, 0);
+  std::vector<long double> startWeight(rangeWeight.size(), 0);
+  std::vector<long double> startDiff(rangeDiff.size(), 0);
+  // Weight by class of the chunks before c, at position c * 2 + k
+  std::vector<long double> lowerWeight((totChunks + 1) * 2, 0);
+  long double classWeight[2] = { 0 };
+  int64_t offset = 0;
+  for (int64_t c = 0; c < totChunks; c++) {
+    chunkBegin[c] = offset;
+    long double sumWeight[2] = { 0 };
+    long double sumDiff[2] = { 0 };
+    for (int64_t r = 0; r < totChunks; r++) {
+      rowOffset[r * totChunks + c] = offset;
+      offset += rangeRows[r * totChunks + c];
+      for (int64_t k = 0; k < 2; k++) {
+        startWeight[pos(r, c, k)] = sumWeight[k];
+        startDiff[pos(r, c, k)] = sumDiff[k];
+        sumWeight[k] += rangeWeight[pos(r, c, k)];
+        sumDiff[k] += rangeDiff[pos(r, c, k)];
+      }
+    }
+    for (int64_t k = 0; k < 2; k++) {
+      lowerWeight[(c + 1) * 2 + k] = lowerWeight[c * 2 + k] + sumWeight[k];
+      classWeight[k] += sumWeight[k];
+    }
+  }
+  chunkBegin[totChunks] = offset;
+
+  run([&](int64_t r) {
+    // Over the samples before the current one in diff order: by class, in
+    // all chunks, and by chunk and class in Fenwick trees over the chunks
+    long double allWeight[2] = { 0 };
+    long double allDiff[2] = { 0 };
+    std::vector<BIT> weightBefore(2, BIT(totChunks));
+    std::vector<BIT> diffBefore(2, BIT(totChunks));
+    for (int64_t c = 0; c < totChunks; c++) {
+      for (int64_t k = 0; k < 2; k++) {
+        allWeight[k] += startWeight[pos(r, c, k)];
+        allDiff[k] += startDiff[pos(r, c, k)];
+        weightBefore[k].update(c + 1, startWeight[pos(r, c, k)]);
+        diffBefore[k].update(c + 1, startDiff[pos(r, c, k)]);
+      }
+    }
+    for (int64_t i = getFirst(r, n); i < getFirst(r + 1, n); i++) {
+      const auto& info = samplesInfo[i];
+      int64_t c = chunk[i];
+      int other = 1 - info.bestClass;
+      // Samples before in diff order count their diff, the ones after the
+      // sample's, the smaller of the two
+      long double all = allDiff[other] + info.diff * (classWeight[other] - allWeight[other]);
+      long double lower = diffBefore[other].get(c)
+                          + info.diff * (lowerWeight[c * 2 + other] - weightBefore[other].get(c));
+      pairScore[i] = info.weight * (all - 2 * lower);
+      chunkRows[rowOffset[r * totChunks + c]++] = i;
+
+      allWeight[info.bestClass] += info.weight;
+      allDiff[info.bestClass] += info.weight * (long double)info.diff;
+      weightBefore[info.bestClass].update(c + 1, info.weight);
+      diffBefore[info.bestClass].update(c + 1, info.weight * info.diff);
+    }
+  });
+
+  // The boxes of a chunk are only written by its thread
+  run([&](int64_t c) {
+    int64_t begin = chunkBegin[c];
+    int64_t size = chunkBegin[c + 1] - begin;
+    // By box, then by rank in diff order within the chunk
+    std::vector<std::pair<int64_t, int64_t>> order(size);
+    for (int64_t j = 0; j < size; j++) {
+      order[j] = std::make_pair(box[chunkRows[begin + j]], j);
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<BIT> weightLeft(2, BIT(size));
+    std::vector<BIT> diffLeft(2, BIT(size));
+    long double leftWeight[2] = { 0 };
+    for (const auto& o : order) {
+      int64_t rank = o.second;
+      const auto& info = samplesInfo[chunkRows[begin + rank]];
+      int other = 1 - info.bestClass;
+      long double earlier = diffLeft[other].get(rank)
+                            + info.diff * (leftWeight[other] - weightLeft[other].get(rank + 1));
+      boxScore[o.first] += pairScore[chunkRows[begin + rank]] - 2 * info.weight * earlier;
+      boxWeight[o.first] += info.weight;
+      weightLeft[info.bestClass].update(rank + 1, info.weight);
+      diffLeft[info.bestClass].update(rank + 1, info.weight * info.diff);
+      leftWeight[info.bestClass] += info.weight;
+    }
+  });
+}
+
+
+void ParallelSplitSearch::run(std::function<void(int64_t)> work) {
+  std::vector<std::thread> workers;
+  for (int64_t t = 0; t < threads_; t++) {
+    workers.emplace_back(work, t);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+
+int64_t ParallelSplitSearch::getFirst(int64_t t, int64_t n) {
+  return t * n / threads_;
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module spreads the split search of a single huge node over threads by
+// rows instead of by attributes, which doesn't help at the root of a narrow
+// data set. Each thread collects partial statistics of a range of the rows,
+// and the partial statistics are summed or prefix summed over the threads.
+// GreedyTree and AodhaTree sweep ordered attributes over the value histograms
+// of the summed NodeStats. PairTree gets the pair score of every separator as
+// a prefix sum over the values of per-value contributions: the score of the
+// rows up to a value against the rest is the sum over those rows of their
+// pair score against all rows of the other class, minus twice their score
+// against the rows of the other class before them in value order.
+//
+
+#pragma once
+#include "DataSet.h"
+#include "NodeStats.h"
+#include "PairTree.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ParallelSplitSearch {
+public:
+  // 0 uses every hardware thread
+  ParallelSplitSearch(int64_t threads);
+
+  // Same statistics as NodeStats(ds, attribs), or with the DiffSums of
+  // benefits normalized by minValue and maxValue, up to the rounding of the sums
+  std::unique_ptr<NodeStats> createStats(DataSet& ds, const std::vector<int64_t>& attribs);
+  std::unique_ptr<NodeStats> createStats(DataSet& ds, const std::vector<int64_t>& attribs,
+                                         long double minValue, long double maxValue);
+
+  // By box of attribInx given by valueBox, below totBoxes: the weight of the
+  // samples and their contribution to the pair score, so the score of the
+  // separator b is the sum of boxScore up to b. samplesInfo is sorted by diff,
+  // as PairTree::initSampleInfo leaves it.
+  void calcPairScores(const std::vector<PairTree::SampleInfo>& samplesInfo, int64_t attribInx,
+                      std::function<int64_t(int64_t)> valueBox, int64_t totBoxes,
+                      std::vector<long double>& boxScore, std::vector<int64_t>& boxWeight);
+
+private:
+  std::unique_ptr<NodeStats> createStats(DataSet& ds, const std::vector<int64_t>& attribs,
+                                         std::function<NodeStats*(DataSet&)> create);
+  // Runs work(t) for t in [0, threads_) on threads_ threads
+  void run(std::function<void(int64_t)> work);
+  // First of the n items of thread t
+  int64_t getFirst(int64_t t, int64_t n);
+
+  int64_t threads_;
+};
@@ -0,0 +1,115 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "PerfectHash.h"
+
+#include "ErrorUtils.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+PerfectHash::PerfectHash() {}
+
+
+PerfectHash::PerfectHash(const std::vector<std::string>& keys, const std::vector<int64_t>& values) {
+  ErrorUtils::enforce(keys.size() == values.size(), "PerfectHash: keys and values differ in size.");
+  int64_t n = keys.size();
+  if (n == 0) {
+    return;
+  }
+  std::vector<std::vector<int64_t>> buckets(n);
+  for (int64_t i = 0; i < n; i++) {
+    buckets[hash(keys[i].data(), keys[i].size(), 0) % n].push_back(i);
+  }
+  std::vector<int64_t> order(n);
+  for (int64_t b = 0; b < n; b++) {
+    order[b] = b;
+  }
+  std::stable_sort(order.begin(), order.end(), [&buckets](int64_t a, int64_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  const int64_t MAX_SEED = 1 << 24;
+  displace_.assign(n, 0);
+  keys_.resize(n);
+  values_.resize(n);
+  std::vector<bool> used(n, false);
+  std::vector<int64_t> slots;
+  int64_t freeSlot = 0;
+  // Largest buckets first, while most slots are still free
+  for (auto b : order) {
+    const auto& bucket = buckets[b];
+    if (bucket.size() == 0) {
+      break;
+    }
+    if (bucket.size() == 1) {
+      while (used[freeSlot]) {
+        freeSlot++;
+      }
+      slots.assign(1, freeSlot);
+      displace_[b] = -(freeSlot + 1);
+    } else {
+      int64_t seed = 1;
+      for (; seed < MAX_SEED; seed++) {
+        slots.clear();
+        for (auto i : bucket) {
+          int64_t slot = hash(keys[i].data(), keys[i].size(), seed) % n;
+          if (used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+            break;
+          }
+          slots.push_back(slot);
+        }
+        if (slots.size() == bucket.size()) {
+          break;
+        }
+      }
+      ErrorUtils::enforce(seed < MAX_SEED, "PerfectHash: can't place keys, are they distinct?");
+      displace_[b] = seed;
+    }
+    for (int64_t j = 0; j < bucket.size(); j++) {
+      used[slots[j]] = true;
+      keys_[slots[j]] = keys[bucket[j]];
+      values_[slots[j]] = values[bucket[j]];
+    }
+  }
+}
+
+
+int64_t PerfectHash::find(const char* key, int64_t length) {
+  if (keys_.empty()) {
+    return -1;
+  }
+  int64_t n = keys_.size();
+  int64_t seed = displace_[hash(key, length, 0) % n];
+  int64_t slot = seed < 0 ? -seed - 1 : hash(key, length, seed) % n;
+  const std::string& candidate = keys_[slot];
+  if (candidate.size() != length || std::memcmp(candidate.data(), key, length) != 0) {
+    return -1;
+  }
+  return values_[slot];
+}
+
+
+int64_t PerfectHash::find(const std::string& key) {
+  return find(key.data(), key.size());
+}
+
+
+int64_t PerfectHash::size() {
+  return keys_.size();
+}
+
+
+// FNV-1a followed by the SplitMix64 finalizer, so every seed gives an
+// independent looking hash
+uint64_t PerfectHash::hash(const char* key, int64_t length, uint64_t seed) {
+  uint64_t h = 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull);
+  for (int64_t i = 0; i < length; i++) {
+    h ^= static_cast<unsigned char>(key[i]);
+    h *= 0x100000001B3ull;
+  }
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+  return h ^ (h >> 31);
+}
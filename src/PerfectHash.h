@@ -0,0 +1,36 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements a minimal perfect hash over a fixed set of strings
+// (hash and displace). Each key is found with two hashes and one string
+// compare, and strings outside the set are rejected.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class PerfectHash {
+public:
+  PerfectHash();
+
+  // keys must be distinct. find(keys[i]) returns values[i].
+  PerfectHash(const std::vector<std::string>& keys, const std::vector<int64_t>& values);
+
+  // Returns -1 if key isn't in the set
+  int64_t find(const char* key, int64_t length);
+
+  int64_t find(const std::string& key);
+
+  int64_t size();
+
+  static uint64_t hash(const char* key, int64_t length, uint64_t seed);
+
+private:
+  // displace_[bucket] >= 0 is the seed of the second hash of that bucket,
+  // a negative value -(slot + 1) places its only key directly
+  std::vector<int64_t> displace_;
+  std::vector<std::string> keys_;
+  std::vector<int64_t> values_;
+};
@@ -0,0 +1,94 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "Profiler.h"
+
+#include "ThreadLocalStats.h"
+
+#include <chrono>
+
+typedef ThreadLocalStats<Profiler::Snapshot, Profiler::accumulate> Stats;
+
+bool Profiler::enabled_ = true;
+
+
+Profiler::ScopedTimer::ScopedTimer(Phase phase, int64_t attribInx)
+  : phase_(phase), attribInx_(attribInx), start_(enabled_ ? now() : 0) {}
+
+
+Profiler::ScopedTimer::~ScopedTimer() {
+  if (enabled_) {
+    add(phase_, now() - start_, attribInx_);
+  }
+}
+
+
+void Profiler::setEnabled(bool enabled) {
+  enabled_ = enabled;
+}
+
+
+bool Profiler::isEnabled() {
+  return enabled_;
+}
+
+
+void Profiler::add(Phase phase, int64_t nanoseconds, int64_t attribInx) {
+  Snapshot& stats = Stats::local();
+  stats.phases[phase].nanoseconds += nanoseconds;
+  stats.phases[phase].calls++;
+  if (attribInx >= 0) {
+    if (stats.splitSearch.size() <= attribInx) {
+      stats.splitSearch.resize(attribInx + 1);
+    }
+    stats.splitSearch[attribInx].nanoseconds += nanoseconds;
+    stats.splitSearch[attribInx].calls++;
+  }
+}
+
+
+Profiler::Snapshot Profiler::snapshot() {
+  return Stats::merged();
+}
+
+
+void Profiler::reset() {
+  Stats::reset();
+}
+
+
+void Profiler::accumulate(Snapshot& to, const Snapshot& from) {
+  for (int64_t i = 0; i < from.phases.size(); i++) {
+    to.phases[i].nanoseconds += from.phases[i].nanoseconds;
+    to.phases[i].calls += from.phases[i].calls;
+  }
+  if (to.splitSearch.size() < from.splitSearch.size()) {
+    to.splitSearch.resize(from.splitSearch.size());
+  }
+  for (int64_t i = 0; i < from.splitSearch.size(); i++) {
+    to.splitSearch[i].nanoseconds += from.splitSearch[i].nanoseconds;
+    to.splitSearch[i].calls += from.splitSearch[i].calls;
+  }
+}
+
+
+std::string Profiler::getPhaseName(Phase phase) {
+  switch (phase) {
+  case READ_CSV: return "readCSV";
+  case TYPE_INFERENCE: return "typeInference";
+  case DICTIONARY_BUILD: return "dictionaryBuild";
+  case SAMPLE_ENCODING: return "sampleEncoding";
+  case SPLIT_SEARCH: return "splitSearch";
+  case PARTITIONING: return "partitioning";
+  case LEAF_CREATION: return "leafCreation";
+  case PRUNING: return "pruning";
+  case TESTING: return "testing";
+  default: return "unknown";
+  }
+}
+
+
+int64_t Profiler::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
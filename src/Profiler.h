@@ -0,0 +1,67 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements low overhead per-phase timing. Scoped timers add
+// their steady_clock duration to thread local accumulators, which are merged
+// when a snapshot is taken.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Profiler {
+public:
+  enum Phase {
+    READ_CSV,
+    TYPE_INFERENCE,
+    DICTIONARY_BUILD,
+    SAMPLE_ENCODING,
+    SPLIT_SEARCH,
+    PARTITIONING,
+    LEAF_CREATION,
+    PRUNING,
+    TESTING,
+    TOT_PHASES
+  };
+
+  struct PhaseStats {
+    int64_t nanoseconds = 0;
+    int64_t calls = 0;
+  };
+
+  struct Snapshot {
+    Snapshot() : phases(TOT_PHASES) {}
+    std::vector<PhaseStats> phases;
+    // Split search time broken down by attribute index
+    std::vector<PhaseStats> splitSearch;
+  };
+
+  class ScopedTimer {
+  public:
+    ScopedTimer(Phase phase, int64_t attribInx = -1);
+    ~ScopedTimer();
+
+  private:
+    Phase phase_;
+    int64_t attribInx_;
+    int64_t start_;
+  };
+
+  static void setEnabled(bool enabled);
+  static bool isEnabled();
+
+  static void add(Phase phase, int64_t nanoseconds, int64_t attribInx = -1);
+
+  // Sums the accumulators of all threads
+  static Snapshot snapshot();
+  static void reset();
+  static void accumulate(Snapshot& to, const Snapshot& from);
+
+  static std::string getPhaseName(Phase phase);
+  static int64_t now();
+
+private:
+  static bool enabled_;
+};
@@ -0,0 +1,188 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "QuickScorer.h"
+
+#include "ErrorUtils.h"
+
+#include <algorithm>
+#include <map>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+const int64_t WORD_BITS = 64;
+}
+
+
+QuickScorer::QuickScorer(const std::vector<std::shared_ptr<DecisionTreeNode>>& trees) {
+  for (const auto& tree : trees) {
+    ErrorUtils::enforce(tree != nullptr, "QuickScorer: empty tree.");
+    // Every tree starts on a new word
+    leafValues_.resize((leafValues_.size() + WORD_BITS - 1) / WORD_BITS * WORD_BITS, -1);
+    leafPaths_.resize(leafValues_.size(), 0);
+    treeWords_.push_back(leafValues_.size() / WORD_BITS);
+    addNode(tree.get(), 1);
+  }
+  leafValues_.resize((leafValues_.size() + WORD_BITS - 1) / WORD_BITS * WORD_BITS, -1);
+  leafPaths_.resize(leafValues_.size(), 0);
+  bits_.resize(leafValues_.size() / WORD_BITS);
+
+  separators_.resize(ordered_.size());
+  masks_.resize(ordered_.size());
+  for (int64_t a = 0; a < ordered_.size(); a++) {
+    std::stable_sort(ordered_[a].begin(), ordered_[a].end(),
+      [](const Ordered& x, const Ordered& y) { return x.separator < y.separator; });
+    for (const auto& cond : ordered_[a]) {
+      separators_[a].push_back(cond.separator);
+      masks_[a].push_back(cond.mask);
+    }
+  }
+  ordered_.clear();
+}
+
+
+void QuickScorer::classify(const int64_t* row, int64_t* classes) {
+  std::fill(bits_.begin(), bits_.end(), ~0ULL);
+  for (int64_t a = 0; a < nominal_.size(); a++) {
+    int64_t value = row[a];
+    // Sorted by separator, the splits sending value right are a prefix
+    const int64_t* separators = separators_[a].data();
+    const Mask* masks = masks_[a].data();
+    int64_t totOrdered = separators_[a].size();
+    for (int64_t i = 0; i < totOrdered && value > separators[i]; i++) {
+      clear(masks[i]);
+    }
+    for (const auto& cond : nominal_[a]) {
+      const Exclude& exclude = excludes_[cond.firstExclude
+        + (value >= 0 && value < cond.totValues ? value : cond.totValues)];
+      clear(exclude.before);
+      clear(exclude.after);
+    }
+  }
+  for (int64_t t = 0; t < treeWords_.size(); t++) {
+    classes[t] = leafValues_[findFirst(treeWords_[t])];
+  }
+}
+
+
+void QuickScorer::classify(const int64_t* row, int64_t* classes, int64_t* pathLength) {
+  classify(row, classes);
+  for (int64_t t = 0; t < treeWords_.size(); t++) {
+    pathLength[t] += leafPaths_[findFirst(treeWords_[t])];
+  }
+}
+
+
+int64_t QuickScorer::getTotTrees() {
+  return treeWords_.size();
+}
+
+
+int64_t QuickScorer::getTotAttributes() {
+  return nominal_.size();
+}
+
+
+QuickScorer::Range QuickScorer::addNode(DecisionTreeNode* node, int64_t depth) {
+  if (node->isLeaf()) {
+    return addLeaf(node->getLeafValue(), depth);
+  }
+
+  int64_t attrib = node->getAttribCol();
+  ErrorUtils::enforce(attrib >= 0, "QuickScorer: node without an attribute.");
+  if (attrib >= ordered_.size()) {
+    ordered_.resize(attrib + 1);
+    nominal_.resize(attrib + 1);
+  }
+
+  // Missing children become leaves of class -1, as classify stops on this node
+  if (node->getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+    auto left = node->children_.find(0);
+    Range leftRange = left != node->children_.end() && left->second
+      ? addNode(left->second.get(), depth + 1) : addLeaf(-1, depth);
+    auto right = node->children_.find(1);
+    Range rightRange = right != node->children_.end() && right->second
+      ? addNode(right->second.get(), depth + 1) : addLeaf(-1, depth);
+    ordered_[attrib].push_back({node->getSeparator(), getMask(leftRange.first, leftRange.last)});
+    return {leftRange.first, rightRange.last};
+  }
+
+  Range missing = addLeaf(-1, depth);
+  // Values sharing a child share its leaves
+  std::map<DecisionTreeNode*, Range> childRange;
+  int64_t totValues = 0;
+  for (const auto& child : node->children_) {
+    ErrorUtils::enforce(child.first >= 0, "QuickScorer: negative nominal value.");
+    if (child.second && childRange.find(child.second.get()) == childRange.end()) {
+      childRange[child.second.get()] = addNode(child.second.get(), depth + 1);
+    }
+    totValues = child.first + 1;
+  }
+  Range range = {missing.first, (int64_t)leafValues_.size()};
+  std::vector<Range> keep(totValues + 1, missing);
+  for (const auto& child : node->children_) {
+    if (child.second) {
+      keep[child.first] = childRange[child.second.get()];
+    }
+  }
+  nominal_[attrib].push_back({(int64_t)excludes_.size(), totValues});
+  for (const auto& k : keep) {
+    excludes_.push_back({getMask(range.first, k.first), getMask(k.last, range.last)});
+  }
+  return range;
+}
+
+
+QuickScorer::Range QuickScorer::addLeaf(int64_t leafValue, int64_t pathLength) {
+  leafValues_.push_back(leafValue);
+  leafPaths_.push_back(pathLength);
+  return {(int64_t)leafValues_.size() - 1, (int64_t)leafValues_.size()};
+}
+
+
+// On a single word firstMask holds the whole range. An empty range clears nothing.
+QuickScorer::Mask QuickScorer::getMask(int64_t first, int64_t last) {
+  if (first >= last) {
+    return {0, 0, 0, 0};
+  }
+  Mask mask;
+  mask.firstWord = first / WORD_BITS;
+  mask.lastWord = (last - 1) / WORD_BITS;
+  mask.firstMask = ~0ULL << (first % WORD_BITS);
+  mask.lastMask = ~0ULL >> (WORD_BITS - 1 - (last - 1) % WORD_BITS);
+  if (mask.firstWord == mask.lastWord) {
+    mask.firstMask &= mask.lastMask;
+    mask.lastMask = mask.firstMask;
+  }
+  return mask;
+}
+
+
+void QuickScorer::clear(const Mask& mask) {
+  bits_[mask.firstWord] &= ~mask.firstMask;
+  if (mask.firstWord != mask.lastWord) {
+    for (int64_t w = mask.firstWord + 1; w < mask.lastWord; w++) {
+      bits_[w] = 0;
+    }
+    bits_[mask.lastWord] &= ~mask.lastMask;
+  }
+}
+
+
+// The leaf reached by the sample is never cleared, so a bit is always found
+int64_t QuickScorer::findFirst(int64_t firstWord) {
+  int64_t w = firstWord;
+  while (bits_[w] == 0) {
+    w++;
+  }
+#ifdef _MSC_VER
+  unsigned long bit;
+  _BitScanForward64(&bit, bits_[w]);
+  return w * WORD_BITS + bit;
+#else
+  return w * WORD_BITS + __builtin_ctzll(bits_[w]);
+#endif
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module scores a set of trees in a single pass over a sample
+// (QuickScorer). The leaves of every tree are bits of a bitvector; the splits
+// of all trees are grouped by attribute, ordered ones sorted by separator, and
+// every split the sample fails clears the leaves it can't reach. The leftmost
+// bit left in each tree is the leaf DecisionTreeNode::classify ends at.
+//
+
+#pragma once
+#include "DecisionTreeNode.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class QuickScorer {
+public:
+  // Accepts any trees over the same attributes, e.g. from ExtrasTreeNode::getTree
+  QuickScorer(const std::vector<std::shared_ptr<DecisionTreeNode>>& trees);
+
+  // classes[t] gets the class DecisionTreeNode::classify gives for tree t,
+  // -1 included. row holds the value index of each attribute.
+  // Uses a member buffer, so an instance scores one sample at a time.
+  void classify(const int64_t* row, int64_t* classes);
+
+  // Also adds to pathLength[t] the nodes visited by DecisionTreeNode::classify
+  void classify(const int64_t* row, int64_t* classes, int64_t* pathLength);
+
+  int64_t getTotTrees();
+
+  int64_t getTotAttributes();
+
+private:
+  struct Range {
+    int64_t first;
+    int64_t last;
+  };
+
+  // A range of leaves as word masks, most subtrees fit in a single word
+  struct Mask {
+    int64_t firstWord;
+    int64_t lastWord;
+    uint64_t firstMask;
+    uint64_t lastMask;
+  };
+
+  // The leaves cleared if row[attrib] > separator, i.e. the left subtree
+  struct Ordered {
+    int64_t separator;
+    Mask mask;
+  };
+
+  // The leaves of a nominal node before and after the child of a value
+  struct Exclude {
+    Mask before;
+    Mask after;
+  };
+
+  // excludes_[firstExclude + value] holds the leaves cleared for a value,
+  // excludes_[firstExclude + totValues] the ones for values without a child
+  struct Nominal {
+    int64_t firstExclude;
+    int64_t totValues;
+  };
+
+  // Returns the leaves of the subtree. depth counts the nodes down to node.
+  Range addNode(DecisionTreeNode* node, int64_t depth);
+  Range addLeaf(int64_t leafValue, int64_t pathLength);
+  Mask getMask(int64_t first, int64_t last);
+  void clear(const Mask& mask);
+  int64_t findFirst(int64_t firstWord);
+
+  // First word of the bits of each tree
+  std::vector<int64_t> treeWords_;
+  // By attribute, the separators and masks of the ordered splits sorted by separator
+  std::vector<std::vector<int64_t>> separators_;
+  std::vector<std::vector<Mask>> masks_;
+  // Filled while adding the trees, then split into separators_ and masks_
+  std::vector<std::vector<Ordered>> ordered_;
+  std::vector<std::vector<Nominal>> nominal_;
+  std::vector<Exclude> excludes_;
+  // By bit, -1 on the leaves added for missing children
+  std::vector<int64_t> leafValues_;
+  std::vector<int64_t> leafPaths_;
+  std::vector<uint64_t> bits_;
+};
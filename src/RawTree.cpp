@@ -0,0 +1,186 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "RawTree.h"
+
+#include "ErrorUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+// Same tolerance used to sort the DOUBLE dictionaries
+const double EPS = 1e-9;
+}
+
+
+RawTree::RawTree(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds) {
+  ErrorUtils::enforce(tree != nullptr, "RawTree: empty tree.");
+  for (int64_t a = 0; a < ds.getTotAttributes(); a++) {
+    types_.push_back(ds.getAttributeType(a));
+    if (types_[a] == AttributeType::STRING) {
+      std::vector<std::string> keys(ds.getAttributeSize(a));
+      std::vector<int64_t> values(keys.size());
+      for (int64_t v = 0; v < keys.size(); v++) {
+        keys[v] = ds.getValue<std::string>(a, v);
+        values[v] = v;
+      }
+      categories_.push_back(PerfectHash(keys, values));
+    } else {
+      categories_.push_back(PerfectHash());
+    }
+  }
+  std::map<DecisionTreeNode*, int64_t> nodeInx;
+  addNode(tree.get(), ds, nodeInx);
+}
+
+
+int64_t RawTree::classify(const double* numbers, const std::string* texts) {
+  const Node* node = &nodes_[0];
+  while (node->type != DecisionTreeNode::NodeType::LEAF) {
+    int64_t attrib = node->attribCol;
+    int64_t next = -1;
+    if (types_[attrib] == AttributeType::STRING) {
+      int64_t key = categories_[attrib].find(texts[attrib]);
+      if (key >= 0) {
+        if (node->type == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+          key = key <= node->separator ? 0 : 1;
+        }
+        next = findChild(*node, key, 0);
+      }
+    } else {
+      double value = numbers[attrib];
+      if (!std::isnan(value)) {
+        if (node->type == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+          next = findChild(*node, value <= node->threshold ? 0 : 1, 0);
+        } else {
+          next = findChild(*node, -1, value);
+        }
+      }
+    }
+    if (next < 0) {
+      return node->leafValue;
+    }
+    node = &nodes_[next];
+  }
+  return node->leafValue;
+}
+
+
+int64_t RawTree::classify(const std::vector<std::string>& rawValues) {
+  ErrorUtils::enforce(rawValues.size() == types_.size(), "RawTree: wrong number of attributes.");
+  std::vector<double> numbers;
+  parseNumbers(rawValues, numbers);
+  return classify(numbers.data(), rawValues.data());
+}
+
+
+void RawTree::parseNumbers(const std::vector<std::string>& rawValues, std::vector<double>& numbers) {
+  ErrorUtils::enforce(rawValues.size() >= types_.size(), "RawTree: wrong number of attributes.");
+  numbers.assign(types_.size(), std::numeric_limits<double>::quiet_NaN());
+  for (int64_t a = 0; a < types_.size(); a++) {
+    if (types_[a] != AttributeType::STRING && !rawValues[a].empty()) {
+      char* end;
+      double value = std::strtod(rawValues[a].c_str(), &end);
+      if (*end == '\0') {
+        numbers[a] = value;
+      }
+    }
+  }
+}
+
+
+int64_t RawTree::getTotAttributes() {
+  return types_.size();
+}
+
+
+AttributeType RawTree::getAttributeType(int64_t attribInx) {
+  ErrorUtils::enforce(attribInx >= 0 && attribInx < types_.size(), "Out of bounds");
+  return types_[attribInx];
+}
+
+
+int64_t RawTree::addNode(DecisionTreeNode* node, DataSet& ds,
+                         std::map<DecisionTreeNode*, int64_t>& nodeInx) {
+  auto it = nodeInx.find(node);
+  if (it != nodeInx.end()) {
+    return it->second;
+  }
+  int64_t inx = nodes_.size();
+  nodeInx[node] = inx;
+  nodes_.push_back(Node());
+
+  Node info;
+  info.type = node->getType();
+  info.attribCol = node->getAttribCol();
+  info.leafValue = node->getLeafValue();
+  info.separator = node->getSeparator();
+  info.threshold = 0;
+  std::vector<Child> children;
+  if (info.type != DecisionTreeNode::NodeType::LEAF) {
+    bool numeric = types_[info.attribCol] != AttributeType::STRING;
+    if (info.type == DecisionTreeNode::NodeType::REGULAR_ORDERED && numeric) {
+      info.threshold = getRawValue(ds, info.attribCol, info.separator);
+      if (types_[info.attribCol] == AttributeType::DOUBLE) {
+        info.threshold += EPS;
+      }
+    }
+    for (const auto& child : node->children_) {
+      if (!child.second) {
+        continue;
+      }
+      double value = 0;
+      if (info.type == DecisionTreeNode::NodeType::REGULAR_NOMINAL && numeric) {
+        value = getRawValue(ds, info.attribCol, child.first);
+      }
+      children.push_back({child.first, value, addNode(child.second.get(), ds, nodeInx)});
+    }
+  }
+  // Appended after the recursion so the children of a node stay contiguous
+  info.firstChild = children_.size();
+  info.totChildren = children.size();
+  children_.insert(children_.end(), children.begin(), children.end());
+  nodes_[inx] = info;
+  return inx;
+}
+
+
+// Indexes outside the dictionary give infinite thresholds, sending every
+// value to the same side
+double RawTree::getRawValue(DataSet& ds, int64_t attribInx, int64_t valueInx) {
+  if (valueInx < 0) {
+    return -std::numeric_limits<double>::infinity();
+  }
+  if (valueInx >= ds.getAttributeSize(attribInx)) {
+    return std::numeric_limits<double>::infinity();
+  }
+  if (ds.getAttributeType(attribInx) == AttributeType::INTEGER) {
+    return static_cast<double>(ds.getValue<int64_t>(attribInx, valueInx));
+  }
+  return ds.getValue<double>(attribInx, valueInx);
+}
+
+
+// Children of numeric nominal nodes are matched by raw value, the others by key
+int64_t RawTree::findChild(const Node& node, int64_t key, double value) {
+  const Child* first = &children_[0] + node.firstChild;
+  const Child* last = first + node.totChildren;
+  if (node.type == DecisionTreeNode::NodeType::REGULAR_NOMINAL
+      && types_[node.attribCol] != AttributeType::STRING) {
+    auto it = std::lower_bound(first, last, value - EPS,
+      [](const Child& c, double v) { return c.value < v; });
+    if (it == last || std::abs(it->value - value) > EPS) {
+      return -1;
+    }
+    return it->node;
+  }
+  auto it = std::lower_bound(first, last, key,
+    [](const Child& c, int64_t k) { return c.key < k; });
+  if (it == last || it->key != key) {
+    return -1;
+  }
+  return it->node;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements an inference copy of a tree that reads raw values.
+// Ordered splits keep the numeric threshold of their separator and nominal
+// splits find categories with a perfect hash, so a record is scored without
+// the Attribute dictionaries, including numbers not seen in training.
+//
+
+#pragma once
+#include "Attribute.h"
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+#include "PerfectHash.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class RawTree {
+public:
+  RawTree(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds);
+
+  // numbers[a] is read for INTEGER and DOUBLE attributes, NaN if missing, and
+  // texts[a] for STRING ones. A missing value or a category without a child
+  // stops at the current node and returns its leaf value.
+  int64_t classify(const double* numbers, const std::string* texts);
+
+  // Parses one row of raw values, in attribute order
+  int64_t classify(const std::vector<std::string>& rawValues);
+
+  // The numbers argument of classify for a row starting with the raw values
+  // of the attributes
+  void parseNumbers(const std::vector<std::string>& rawValues, std::vector<double>& numbers);
+
+  int64_t getTotAttributes();
+
+  AttributeType getAttributeType(int64_t attribInx);
+
+private:
+  struct Node {
+    DecisionTreeNode::NodeType type;
+    int64_t attribCol;
+    // Ordered numeric splits go left when value <= threshold, ordered
+    // STRING splits when the category index <= separator
+    double threshold;
+    int64_t separator;
+    int64_t leafValue;
+    int64_t firstChild;
+    int64_t totChildren;
+  };
+
+  // Sorted by key. For numeric attributes value holds the raw value.
+  struct Child {
+    int64_t key;
+    double value;
+    int64_t node;
+  };
+
+  int64_t addNode(DecisionTreeNode* node, DataSet& ds, std::map<DecisionTreeNode*, int64_t>& nodeInx);
+  double getRawValue(DataSet& ds, int64_t attribInx, int64_t valueInx);
+  int64_t findChild(const Node& node, int64_t key, double value);
+
+  std::vector<Node> nodes_;
+  std::vector<Child> children_;
+  std::vector<AttributeType> types_;
+  // Category index of each STRING attribute value, empty for numeric ones
+  std::vector<PerfectHash> categories_;
+};
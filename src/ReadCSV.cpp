@@ -3,12 +3,14 @@
 
 #include "ReadCSV.h"
 
+#include "ErrorUtils.h"
 #include "Logger.h"
+#include "Profiler.h"
 
-#include <fstream>
 #include <sstream>
 
 std::vector<std::vector<std::string>> ReadCSV::readFile(std::string fileName) {
+  Profiler::ScopedTimer timer(Profiler::READ_CSV);
   Logger::log() << "Started reading file " << fileName;
   std::vector<std::vector<std::string>> ans;
 
@@ -23,6 +25,25 @@ std::vector<std::vector<std::string>> ReadCSV::readFile(std::string fileName) {
   return ans;
 }
 
+void ReadCSV::open(std::string fileName) {
+  file_.close();
+  file_.clear();
+  file_.open(fileName);
+  ErrorUtils::enforce(file_.is_open(), "Can't open file " + fileName);
+}
+
+bool ReadCSV::readChunk(std::vector<std::vector<std::string>>& rows, int64_t maxRows) {
+  Profiler::ScopedTimer timer(Profiler::READ_CSV);
+  rows.clear();
+  while (file_ && rows.size() < maxRows) {
+    auto row = readRow(file_);
+    if (row.size() > 0) {
+      rows.push_back(std::move(row));
+    }
+  }
+  return rows.size() > 0;
+}
+
 std::vector<std::string> ReadCSV::readRow(std::istream& str) {
   std::vector<std::string> ans;
   std::string line;
@@ -5,6 +5,8 @@
 //
 
 #pragma once
+#include <cstdint>
+#include <fstream>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,13 @@ class ReadCSV {
 public:
   std::vector<std::vector<std::string>> readFile(std::string fileName);
 
+  // Streams the file instead, maxRows rows at a time. readChunk returns
+  // false once the file has no rows left.
+  void open(std::string fileName);
+  bool readChunk(std::vector<std::vector<std::string>>& rows, int64_t maxRows);
+
 private:
   std::vector<std::string> readRow(std::istream& str);
+
+  std::ifstream file_;
 };
@@ -3,7 +3,14 @@
 
 #include "Sample.h"
 
-Sample::Sample(int totAttributes, int totClasses) {
+Sample::Sample(int totAttributes, int totClasses) : weight_(1) {
   inxValue_.resize(totAttributes);
   benefit_.resize(totClasses);
 }
+
+int64_t Sample::getMemoryUsage() {
+  // Samples are created with make_shared, the control block holds two counters
+  return sizeof(Sample) + 2 * sizeof(int64_t)
+         + inxValue_.capacity() * sizeof(int64_t)
+         + benefit_.capacity() * sizeof(double);
+}
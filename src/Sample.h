@@ -5,11 +5,17 @@
 //
 
 #pragma once
+#include <cstdint>
 #include <vector>
 
 class Sample {
 public:
   Sample(int totAttributes, int totClasses);
+  // Estimated bytes of the sample and its shared_ptr control block
+  int64_t getMemoryUsage();
   std::vector<int64_t> inxValue_;
   std::vector<double> benefit_;
+  // Number of rows collapsed into the sample (DataSetBuilder::collapseDuplicates),
+  // benefit_ holds the sum of their benefits
+  int64_t weight_;
 };
\ No newline at end of file
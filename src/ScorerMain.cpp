@@ -0,0 +1,53 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// Batch scoring entry point.
+// Usage: PairTreeScorer -model model.bin -in data.csv -out predictions.csv
+//                       [-threads 0] [-chunk 65536] [-label column]
+// Input columns are matched to the model attributes by the header names. The
+// benefit of the predicted class is written when the input has a cost column
+// per class, as in training, or when a label column is given.
+//
+
+#include "BatchScorer.h"
+#include "ErrorUtils.h"
+
+#include <string>
+
+int main(int argc, char** argv) {
+  std::string modelFile = "";
+  std::string inputFile = "";
+  std::string outputFile = "";
+  std::string labelColumn = "";
+  int64_t threads = 0;
+  int64_t chunkRows = 65536;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    ErrorUtils::enforce(i + 1 < argc, "Missing value for " + arg);
+    std::string value = argv[++i];
+    if (arg == "-model") {
+      modelFile = value;
+    } else if (arg == "-in") {
+      inputFile = value;
+    } else if (arg == "-out") {
+      outputFile = value;
+    } else if (arg == "-threads") {
+      threads = std::stoll(value);
+    } else if (arg == "-chunk") {
+      chunkRows = std::stoll(value);
+    } else if (arg == "-label") {
+      labelColumn = value;
+    } else {
+      ErrorUtils::enforce(false, "Unknown option " + arg);
+    }
+  }
+  ErrorUtils::enforce(modelFile != "", "Missing model file (-model).");
+  ErrorUtils::enforce(inputFile != "", "Missing input file (-in).");
+  ErrorUtils::enforce(outputFile != "", "Missing output file (-out).");
+
+  BatchScorer scorer(modelFile, threads, chunkRows);
+  scorer.setLabelColumn(labelColumn);
+  scorer.score(inputFile, outputFile);
+  return 0;
+}
@@ -0,0 +1,389 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "ScoringServer.h"
+
+#include "ErrorUtils.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ostream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET SocketHandle;
+#define closeSocket closesocket
+#define SHUTDOWN_BOTH SD_BOTH
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int SocketHandle;
+#define closeSocket close
+#define SHUTDOWN_BOTH SHUT_RDWR
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+
+namespace {
+const int64_t MAX_CELLS = 1 << 24;
+const uint32_t MAX_TEXT = 1 << 16;
+
+SocketHandle handle(int64_t socket) {
+  return static_cast<SocketHandle>(socket);
+}
+
+bool readBytes(int64_t socket, void* data, int64_t bytes) {
+  char* out = static_cast<char*>(data);
+  while (bytes > 0) {
+    auto received = recv(handle(socket), out, static_cast<int>(std::min<int64_t>(bytes, 1 << 20)), 0);
+    if (received <= 0) {
+      return false;
+    }
+    out += received;
+    bytes -= received;
+  }
+  return true;
+}
+
+bool writeBytes(int64_t socket, const void* data, int64_t bytes) {
+  const char* in = static_cast<const char*>(data);
+  while (bytes > 0) {
+    auto sent = send(handle(socket), in, static_cast<int>(std::min<int64_t>(bytes, 1 << 20)), SEND_FLAGS);
+    if (sent <= 0) {
+      return false;
+    }
+    in += sent;
+    bytes -= sent;
+  }
+  return true;
+}
+
+template <typename T>
+bool readValue(int64_t socket, T& value) {
+  return readBytes(socket, &value, sizeof(T));
+}
+}
+
+
+ScoringServer::ScoringServer(std::shared_ptr<ConfigServer> config)
+  : config_(config), modelTime_(0), modelSize_(0), running_(false), listener_(-1),
+    acceptingJobs_(false) {
+  ErrorUtils::enforce(config_->maxBatchRows > 0, "ScoringServer: maxBatchRows must be positive.");
+#ifdef _WIN32
+  WSADATA wsaData;
+  ErrorUtils::enforce(WSAStartup(MAKEWORD(2, 2), &wsaData) == 0, "ScoringServer: can't start Winsock.");
+#endif
+}
+
+
+ScoringServer::~ScoringServer() {
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+
+
+void ScoringServer::run() {
+  ErrorUtils::enforce(reload(), "ScoringServer: can't load " + config_->modelFileName);
+
+  SocketHandle listener;
+  if (config_->socketPath != "") {
+#ifdef _WIN32
+    ErrorUtils::enforce(false, "ScoringServer: Unix sockets aren't supported, use a port.");
+#else
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    ErrorUtils::enforce(config_->socketPath.size() < sizeof(addr.sun_path),
+                        "ScoringServer: socket path too long.");
+    std::strcpy(addr.sun_path, config_->socketPath.c_str());
+    unlink(config_->socketPath.c_str());
+    ErrorUtils::enforce(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0,
+                        "ScoringServer: can't bind " + config_->socketPath);
+#endif
+  } else {
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_->port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ErrorUtils::enforce(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0,
+                        "ScoringServer: can't bind port " + std::to_string(config_->port));
+  }
+  ErrorUtils::enforce(listen(listener, SOMAXCONN) == 0, "ScoringServer: can't listen.");
+  listener_ = static_cast<int64_t>(listener);
+  running_ = true;
+  acceptingJobs_ = true;
+  Logger::log() << "Scoring server listening on "
+                << (config_->socketPath != "" ? config_->socketPath : "127.0.0.1:" + std::to_string(config_->port));
+
+  std::thread batcher(&ScoringServer::batchLoop, this);
+  std::thread watcher(&ScoringServer::watchLoop, this);
+  acceptLoop();
+
+  // Connections are closed first, their queued requests still get answers
+  {
+    std::unique_lock<std::mutex> lock(connectionsMutex_);
+    for (auto client : clients_) {
+      shutdown(handle(client), SHUTDOWN_BOTH);
+    }
+    connectionsClosed_.wait(lock, [this]() { return clients_.empty(); });
+  }
+  {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    acceptingJobs_ = false;
+  }
+  queueReady_.notify_all();
+  batcher.join();
+  watcher.join();
+  closeSocket(listener);
+  if (config_->socketPath != "") {
+#ifndef _WIN32
+    unlink(config_->socketPath.c_str());
+#endif
+  }
+  report();
+  Logger::log() << "Scoring server stopped";
+}
+
+
+void ScoringServer::stop() {
+  running_ = false;
+  if (listener_ >= 0) {
+    shutdown(handle(listener_), SHUTDOWN_BOTH);
+  }
+}
+
+
+void ScoringServer::acceptLoop() {
+  while (running_) {
+    SocketHandle client = accept(handle(listener_), nullptr, nullptr);
+    if (!running_) {
+      if (static_cast<int64_t>(client) >= 0) {
+        closeSocket(client);
+      }
+      break;
+    }
+    if (static_cast<int64_t>(client) < 0) {
+      continue;
+    }
+    if (config_->socketPath == "") {
+      int noDelay = 1;
+      setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    }
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    clients_.push_back(static_cast<int64_t>(client));
+    std::thread(&ScoringServer::serveConnection, this, static_cast<int64_t>(client)).detach();
+  }
+}
+
+
+void ScoringServer::serveConnection(int64_t client) {
+  while (true) {
+    auto job = std::make_shared<Job>();
+    job->status = OK;
+    if (!readJob(client, *job)) {
+      if (job->status == BAD_REQUEST) {
+        uint32_t header[2] = {BAD_REQUEST, 0};
+        writeBytes(client, header, sizeof(header));
+      }
+      break;
+    }
+    job->start = Profiler::now();
+    auto result = job->result.get_future();
+    {
+      std::lock_guard<std::mutex> lock(queueMutex_);
+      queue_.push_back(job);
+    }
+    queueReady_.notify_one();
+    std::vector<int32_t> classes = result.get();
+    {
+      std::lock_guard<std::mutex> lock(latencyMutex_);
+      latencies_.push_back(Profiler::now() - job->start);
+    }
+
+    uint32_t header[2] = {static_cast<uint32_t>(job->status), static_cast<uint32_t>(classes.size())};
+    if (!writeBytes(client, header, sizeof(header))
+        || !writeBytes(client, classes.data(), classes.size() * sizeof(int32_t))) {
+      break;
+    }
+  }
+
+  closeSocket(handle(client));
+  std::lock_guard<std::mutex> lock(connectionsMutex_);
+  clients_.erase(std::find(clients_.begin(), clients_.end(), client));
+  connectionsClosed_.notify_all();
+}
+
+
+bool ScoringServer::readJob(int64_t client, Job& job) {
+  uint32_t rows, attributes;
+  if (!readValue(client, rows) || !readValue(client, attributes)) {
+    return false;
+  }
+  if (attributes > 0 && rows > MAX_CELLS / attributes) {
+    job.status = BAD_REQUEST;
+    return false;
+  }
+  job.rows = rows;
+  job.attributes = attributes;
+  job.cells.resize(job.rows * job.attributes);
+  for (auto& cell : job.cells) {
+    if (!readValue(client, cell.kind)) {
+      return false;
+    }
+    if (cell.kind == NUMBER) {
+      if (!readValue(client, cell.number)) {
+        return false;
+      }
+    } else if (cell.kind == TEXT) {
+      uint32_t length;
+      if (!readValue(client, length)) {
+        return false;
+      }
+      if (length > MAX_TEXT) {
+        job.status = BAD_REQUEST;
+        return false;
+      }
+      cell.text.resize(length);
+      if (length > 0 && !readBytes(client, &cell.text[0], length)) {
+        return false;
+      }
+    } else if (cell.kind != MISSING) {
+      job.status = BAD_REQUEST;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void ScoringServer::batchLoop() {
+  while (true) {
+    std::vector<std::shared_ptr<Job>> batch;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex_);
+      queueReady_.wait(lock, [this]() { return !queue_.empty() || !acceptingJobs_; });
+      if (queue_.empty()) {
+        return;
+      }
+      int64_t rows = 0;
+      while (!queue_.empty()
+             && (batch.empty() || rows + queue_.front()->rows <= config_->maxBatchRows)) {
+        rows += queue_.front()->rows;
+        batch.push_back(queue_.front());
+        queue_.pop_front();
+      }
+    }
+    // The whole batch uses the same model even if a reload happens meanwhile
+    std::shared_ptr<MappedModel> model = std::atomic_load(&model_);
+    for (auto& job : batch) {
+      scoreJob(*model, *job);
+    }
+  }
+}
+
+
+void ScoringServer::scoreJob(MappedModel& model, Job& job) {
+  std::vector<int32_t> classes;
+  if (job.attributes != model.getTotAttributes()) {
+    job.status = WRONG_ATTRIBUTES;
+    job.result.set_value(classes);
+    return;
+  }
+  classes.resize(job.rows);
+  std::vector<int64_t> inxValues(job.attributes);
+  for (int64_t r = 0; r < job.rows; r++) {
+    for (int64_t a = 0; a < job.attributes; a++) {
+      const Cell& cell = job.cells[r * job.attributes + a];
+      if (cell.kind == NUMBER) {
+        inxValues[a] = model.encode(a, cell.number);
+      } else if (cell.kind == TEXT) {
+        inxValues[a] = model.encode(a, cell.text);
+      } else {
+        inxValues[a] = -1;
+      }
+    }
+    classes[r] = static_cast<int32_t>(model.classify(inxValues.data()));
+  }
+  job.result.set_value(std::move(classes));
+}
+
+
+void ScoringServer::watchLoop() {
+  int64_t lastReport = Profiler::now();
+  while (running_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(config_->pollMilliseconds));
+    reload();
+    if (Profiler::now() - lastReport >= config_->reportSeconds * 1000000000LL) {
+      report();
+      lastReport = Profiler::now();
+    }
+  }
+}
+
+
+// Maps the model file again if it changed. Files are expected to be replaced
+// with a rename, since the current mapping may still be in use. An invalid
+// file is logged once and the current model is kept.
+bool ScoringServer::reload() {
+  struct stat info;
+  if (stat(config_->modelFileName.c_str(), &info) != 0) {
+    return false;
+  }
+  if (modelTime_ != 0 && info.st_mtime == modelTime_ && info.st_size == modelSize_) {
+    return false;
+  }
+  if (!MappedModel::isComplete(config_->modelFileName)) {
+    return false;
+  }
+  modelTime_ = info.st_mtime;
+  modelSize_ = info.st_size;
+  std::string error;
+  std::shared_ptr<MappedModel> model = MappedModel::tryLoad(config_->modelFileName, error);
+  if (!model) {
+    Logger::log() << "Can't load " << config_->modelFileName << ", keeping the current model: " << error;
+    return false;
+  }
+  std::atomic_store(&model_, model);
+  Logger::log() << "Loaded model " << config_->modelFileName << " with "
+                << model->getTotNodes() << " nodes";
+  return true;
+}
+
+
+void ScoringServer::report() {
+  std::vector<int64_t> latencies;
+  {
+    std::lock_guard<std::mutex> lock(latencyMutex_);
+    latencies.swap(latencies_);
+  }
+  if (latencies.empty()) {
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  int64_t p50 = latencies[(latencies.size() - 1) * 50 / 100];
+  int64_t p99 = latencies[(latencies.size() - 1) * 99 / 100];
+  Logger::log() << "Served " << latencies.size() << " requests, latency p50 " << p50 / 1000
+                << " us, p99 " << p99 / 1000 << " us, max " << latencies.back() / 1000 << " us";
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements a local scoring daemon. Clients send rows of raw
+// values over a Unix domain socket or localhost TCP, requests arriving
+// together are scored as one batch, and the model file is mapped again when
+// it changes on disk. Latency percentiles are logged periodically.
+//
+// Protocol, all integers little endian:
+//   request:  uint32 rows, uint32 attributes, then rows * attributes cells of
+//             uint8 kind followed by nothing (MISSING), a double (NUMBER) or
+//             uint32 length and the bytes (TEXT), in model attribute order
+//   response: uint32 status, uint32 rows, then one int32 class index per row
+//             (-1 if the tree has no class for the row). Class names are
+//             read from the model file.
+//
+
+#pragma once
+#include "MappedModel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ConfigServer {
+public:
+  std::string modelFileName;
+  // Unix domain socket path. If empty, listens on 127.0.0.1:port instead.
+  std::string socketPath;
+  int port = 7070;
+  // Rows scored together at most, a request is never split
+  int64_t maxBatchRows = 4096;
+  int64_t pollMilliseconds = 500;
+  int64_t reportSeconds = 10;
+};
+
+class ScoringServer {
+public:
+  enum CellKind {
+    MISSING = 0,
+    NUMBER = 1,
+    TEXT = 2
+  };
+
+  enum Status {
+    OK = 0,
+    BAD_REQUEST = 1,
+    WRONG_ATTRIBUTES = 2
+  };
+
+  ScoringServer(std::shared_ptr<ConfigServer> config);
+  ~ScoringServer();
+
+  // Serves until stop() is called
+  void run();
+
+  // Safe to call from a signal handler
+  void stop();
+
+private:
+  struct Cell {
+    uint8_t kind;
+    double number;
+    std::string text;
+  };
+
+  struct Job {
+    int64_t rows;
+    int64_t attributes;
+    std::vector<Cell> cells;
+    int64_t start;
+    Status status;
+    std::promise<std::vector<int32_t>> result;
+  };
+
+  void acceptLoop();
+  void serveConnection(int64_t client);
+  bool readJob(int64_t client, Job& job);
+  void batchLoop();
+  void scoreJob(MappedModel& model, Job& job);
+  void watchLoop();
+  bool reload();
+  void report();
+
+  std::shared_ptr<ConfigServer> config_;
+  std::shared_ptr<MappedModel> model_;
+  int64_t modelTime_;
+  int64_t modelSize_;
+  std::atomic<bool> running_;
+  int64_t listener_;
+
+  std::mutex queueMutex_;
+  std::condition_variable queueReady_;
+  std::deque<std::shared_ptr<Job>> queue_;
+  // Cleared once every connection is closed, so the batcher can drain and stop
+  bool acceptingJobs_;
+
+  std::mutex connectionsMutex_;
+  // Connection threads are detached, each removes its client when it ends
+  std::condition_variable connectionsClosed_;
+  std::vector<int64_t> clients_;
+
+  std::mutex latencyMutex_;
+  // Nanoseconds from a request being read to its response being ready
+  std::vector<int64_t> latencies_;
+};
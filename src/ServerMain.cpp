@@ -0,0 +1,57 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// Scoring server entry point.
+// Usage: PairTreeServer -model model.bin [-socket /tmp/pairtree.sock | -port 7070]
+//                       [-batch 4096] [-poll 500] [-report 10]
+// The model is mapped again whenever the file changes, replace it with a
+// rename so requests in flight keep the previous version. Stops on Ctrl+C.
+//
+
+#include "ErrorUtils.h"
+#include "ScoringServer.h"
+
+#include <csignal>
+#include <string>
+
+ScoringServer* server = nullptr;
+
+void handleSignal(int) {
+  if (server != nullptr) {
+    server->stop();
+  }
+}
+
+int main(int argc, char** argv) {
+  std::shared_ptr<ConfigServer> config = std::make_shared<ConfigServer>();
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    ErrorUtils::enforce(i + 1 < argc, "Missing value for " + arg);
+    std::string value = argv[++i];
+    if (arg == "-model") {
+      config->modelFileName = value;
+    } else if (arg == "-socket") {
+      config->socketPath = value;
+    } else if (arg == "-port") {
+      config->port = std::stoi(value);
+    } else if (arg == "-batch") {
+      config->maxBatchRows = std::stoll(value);
+    } else if (arg == "-poll") {
+      config->pollMilliseconds = std::stoll(value);
+    } else if (arg == "-report") {
+      config->reportSeconds = std::stoll(value);
+    } else {
+      ErrorUtils::enforce(false, "Unknown option " + arg);
+    }
+  }
+  ErrorUtils::enforce(config->modelFileName != "", "Missing model file (-model).");
+
+  ScoringServer scoringServer(config);
+  server = &scoringServer;
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+  scoringServer.run();
+  server = nullptr;
+  return 0;
+}
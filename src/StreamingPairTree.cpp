@@ -0,0 +1,483 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "StreamingPairTree.h"
+
+#include "CompareUtils.h"
+#include "ErrorUtils.h"
+#include "Profiler.h"
+#include "WorkCounters.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Bin 0 holds the rows without a difference, bins 1 onwards an octave each,
+// the first positive difference falling in FIRST_BIN
+const int64_t TOT_BINS = 16;
+const int64_t FIRST_BIN = 8;
+}
+
+
+StreamingPairTree::StreamingPairTree(DataSet& ds, std::shared_ptr<ConfigPairTree> c)
+  : config_(c), hasScale_(false), lowLog2_(0), totRows_(0) {
+  ErrorUtils::enforce(ds.getTotClasses() == 2, "Error! Number of classes must be 2.");
+  boundType_ = PairTree::getBoundType(c->boundOption);
+  ErrorUtils::enforce(boundType_ != PairTree::BoundType::T_BOUND,
+                      "StreamingPairTree: the T bound can't be computed from the leaf statistics.");
+  ErrorUtils::enforce(c->valueBoxes > 0, "StreamingPairTree: valueBoxes must be positive.");
+
+  totAttributes_ = ds.getTotAttributes();
+  totBoxes_ = 0;
+  for (int64_t a = 0; a < totAttributes_; a++) {
+    attribType_.push_back(ds.getAttributeType(a));
+    attribSize_.push_back(ds.getAttributeSize(a));
+    attribBoxes_.push_back(std::max<int64_t>(1, std::min(attribSize_[a], c->valueBoxes)));
+    firstPos_.push_back(totBoxes_);
+    totBoxes_ += attribBoxes_[a];
+  }
+
+  auto root = createLeaf(nullptr, 0, 0);
+  root_ = root->node;
+  leaves_[root_.get()] = std::move(root);
+}
+
+
+void StreamingPairTree::add(const int64_t* inxValue, const double* benefit, int64_t weight) {
+  Leaf& leaf = findLeaf(inxValue);
+  int64_t bestClass = CompareUtils::compare(benefit[0], benefit[1]) >= 0 ? 0 : 1;
+  long double diff = std::abs((long double)benefit[0] - benefit[1]) / weight;
+  int64_t bin = getBin(diff);
+
+  int64_t pos = bestClass * TOT_BINS + bin;
+  leaf.weight[pos] += weight;
+  leaf.sumDiff[pos] += weight * diff;
+  leaf.sumDiffSq[pos] += weight * diff * diff;
+  for (int64_t a = 0; a < totAttributes_; a++) {
+    int64_t boxPos = ((firstPos_[a] + getBox(a, inxValue[a])) * 2 + bestClass) * TOT_BINS + bin;
+    leaf.boxWeight[boxPos] += weight;
+    leaf.boxSumDiff[boxPos] += weight * diff;
+  }
+  leaf.totWeight += weight;
+  leaf.weightSinceCheck += weight;
+  leaf.classBenefit[0] += benefit[0];
+  leaf.classBenefit[1] += benefit[1];
+  leaf.maxDiff[bestClass] = std::max(leaf.maxDiff[bestClass], diff);
+  leaf.node->setLeafValue(CompareUtils::compare(leaf.classBenefit[1], leaf.classBenefit[0]) > 0 ? 1 : 0);
+  totRows_ += weight;
+
+  if (leaf.weightSinceCheck >= config_->gracePeriod) {
+    leaf.weightSinceCheck = 0;
+    trySplit(leaf);
+  }
+}
+
+
+void StreamingPairTree::add(std::shared_ptr<Sample> s) {
+  add(s->inxValue_.data(), s->benefit_.data(), s->weight_);
+}
+
+
+void StreamingPairTree::add(DataSet& ds) {
+  for (const auto& s : ds.samples_) {
+    add(s);
+  }
+}
+
+
+void StreamingPairTree::add(ColumnFile& columns) {
+  ErrorUtils::enforce(columns.getTotAttributes() == totAttributes_ && columns.getTotClasses() == 2,
+                      "StreamingPairTree: the column file doesn't match the data set.");
+  std::vector<int64_t> inxValue(totAttributes_);
+  std::vector<const int32_t*> values(totAttributes_);
+  double benefit[2];
+  for (int64_t block = 0; block < columns.getTotBlocks(); block++) {
+    for (int64_t a = 0; a < totAttributes_; a++) {
+      values[a] = columns.getValues(block, a);
+    }
+    const double* benefit0 = columns.getBenefits(block, 0);
+    const double* benefit1 = columns.getBenefits(block, 1);
+    for (int64_t row = 0; row < columns.getBlockRows(block); row++) {
+      for (int64_t a = 0; a < totAttributes_; a++) {
+        inxValue[a] = values[a][row];
+      }
+      benefit[0] = benefit0[row];
+      benefit[1] = benefit1[row];
+      add(inxValue.data(), benefit, 1);
+    }
+  }
+}
+
+
+std::shared_ptr<DecisionTreeNode> StreamingPairTree::getTree() {
+  return root_;
+}
+
+
+int64_t StreamingPairTree::getTotRows() {
+  return totRows_;
+}
+
+
+int64_t StreamingPairTree::getTotLeaves() {
+  return leaves_.size();
+}
+
+
+int64_t StreamingPairTree::getMemoryUsage() {
+  return leaves_.size() * getLeafBytes();
+}
+
+
+std::unique_ptr<StreamingPairTree::Leaf> StreamingPairTree::createLeaf(std::shared_ptr<DecisionTreeNode> parent,
+                                                                       int64_t depth, int64_t leafValue) {
+  Profiler::ScopedTimer timer(Profiler::LEAF_CREATION);
+  std::unique_ptr<Leaf> leaf(new Leaf());
+  leaf->node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::LEAF);
+  leaf->node->setName("LEAF " + std::to_string(leafValue));
+  leaf->node->setLeafValue(leafValue);
+  leaf->parent = parent;
+  leaf->depth = depth;
+  leaf->totWeight = 0;
+  leaf->weightSinceCheck = 0;
+  leaf->classBenefit[0] = leaf->classBenefit[1] = 0;
+  leaf->maxDiff[0] = leaf->maxDiff[1] = 0;
+  leaf->weight.assign(2 * TOT_BINS, 0);
+  leaf->sumDiff.assign(2 * TOT_BINS, 0);
+  leaf->sumDiffSq.assign(2 * TOT_BINS, 0);
+  leaf->boxWeight.assign(totBoxes_ * 2 * TOT_BINS, 0);
+  leaf->boxSumDiff.assign(totBoxes_ * 2 * TOT_BINS, 0);
+  WorkCounters::add(WorkCounters::BYTES_ALLOCATED, getLeafBytes());
+  return leaf;
+}
+
+
+int64_t StreamingPairTree::getLeafBytes() {
+  return 2 * TOT_BINS * (sizeof(int64_t) + 2 * sizeof(long double))
+         + totBoxes_ * 2 * TOT_BINS * (sizeof(int64_t) + sizeof(double));
+}
+
+
+StreamingPairTree::Leaf& StreamingPairTree::findLeaf(const int64_t* inxValue) {
+  DecisionTreeNode* node = root_.get();
+  while (!node->isLeaf()) {
+    int64_t value = inxValue[node->getAttribCol()];
+    if (node->getType() == DecisionTreeNode::NodeType::REGULAR_ORDERED) {
+      node = (value <= node->getSeparator() ? node->getLeftChild() : node->getRightChild()).get();
+    } else {
+      node = node->children_.at(value).get();
+    }
+  }
+  return *leaves_.at(node);
+}
+
+
+int64_t StreamingPairTree::getBin(long double diff) {
+  if (CompareUtils::compare(diff, 0) <= 0) {
+    return 0;
+  }
+  if (!hasScale_) {
+    hasScale_ = true;
+    lowLog2_ = std::floor(std::log2(diff)) - (FIRST_BIN - 1);
+  }
+  int64_t bin = 1 + (int64_t)std::floor(std::log2(diff) - lowLog2_);
+  return std::max<int64_t>(1, std::min(TOT_BINS - 1, bin));
+}
+
+
+int64_t StreamingPairTree::getBox(int64_t attribInx, int64_t inxValue) {
+  return inxValue * attribBoxes_[attribInx] / attribSize_[attribInx];
+}
+
+
+int64_t StreamingPairTree::getBoxEnd(int64_t attribInx, int64_t box) {
+  int64_t boxes = attribBoxes_[attribInx];
+  return ((box + 1) * attribSize_[attribInx] + boxes - 1) / boxes - 1;
+}
+
+
+void StreamingPairTree::trySplit(Leaf& leaf) {
+  if (leaf.depth >= config_->height || (config_->minLeaf > 0 && leaf.totWeight <= config_->minLeaf)) {
+    return;
+  }
+  int64_t weight0 = 0;
+  int64_t weight1 = 0;
+  for (int64_t b = 0; b < TOT_BINS; b++) {
+    weight0 += leaf.weight[b];
+    weight1 += leaf.weight[TOT_BINS + b];
+  }
+  if (weight0 == 0 || weight1 == 0) {
+    return;
+  }
+
+  long double totScore = calcScore(leaf.weight, leaf.sumDiff);
+  Split best;
+  for (int64_t a = 0; a < totAttributes_; a++) {
+    Profiler::ScopedTimer timer(Profiler::SPLIT_SEARCH, a);
+    Split split = testAttribute(leaf, a, totScore);
+    // As PairTree: a bound under maxBound, then the greatest score or lowest bound
+    if (!split.children.empty() && CompareUtils::compare(split.bound, config_->maxBound) < 0
+        && ((config_->useScore && CompareUtils::compare(split.score, best.score) > 0)
+            || (!config_->useScore && CompareUtils::compare(split.bound, best.bound) < 0))) {
+      best = split;
+    }
+  }
+  if (best.attrib == -1) {
+    return;
+  }
+  if (config_->maxLeaves > 0 && getTotLeaves() - 1 + (int64_t)best.children.size() > config_->maxLeaves) {
+    return;
+  }
+  splitLeaf(leaf, best);
+}
+
+
+StreamingPairTree::Split StreamingPairTree::testAttribute(Leaf& leaf, int64_t attribInx, long double totScore) {
+  int64_t boxes = attribBoxes_[attribInx];
+  std::vector<Histogram> boxHist(boxes);
+  for (int64_t k = 0; k < boxes; k++) {
+    boxHist[k] = getBoxHistogram(leaf, attribInx, k);
+  }
+  long double totWeight = leaf.totWeight;
+
+  Split best;
+  best.attrib = attribInx;
+  auto consider = [&](long double score, const std::vector<long double>& distrib,
+                      std::vector<std::vector<int64_t>> children, bool ordered) {
+    long double bound = calcBound(leaf, score, totScore, distrib);
+    if (CompareUtils::compare(bound, best.bound) < 0) {
+      best.bound = bound;
+      best.score = score;
+      best.children = children;
+      best.ordered = ordered;
+    }
+  };
+
+  bool isNominal = attribType_[attribInx] == AttributeType::STRING;
+  if (!isNominal || config_->useNominalOrdered) {
+    // Cuts the boxes in value order, or nominal boxes by increasing mean benefit
+    // difference b0 - b1 per row with the empty ones last, as NodeStats::getValueOrder
+    std::vector<int64_t> order(boxes);
+    for (int64_t k = 0; k < boxes; k++) {
+      order[k] = k;
+    }
+    if (isNominal) {
+      std::vector<long double> meanDiff(boxes, 0);
+      for (int64_t k = 0; k < boxes; k++) {
+        if (boxHist[k].totWeight > 0) {
+          meanDiff[k] = getSignedDiff(boxHist[k]) / boxHist[k].totWeight;
+        }
+      }
+      std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+        if ((boxHist[a].totWeight > 0) != (boxHist[b].totWeight > 0)) {
+          return boxHist[a].totWeight > 0;
+        }
+        return meanDiff[a] < meanDiff[b];
+      });
+    }
+    Histogram left = createHistogram();
+    Histogram right = createHistogram();
+    for (int64_t k = 0; k + 1 < boxes; k++) {
+      addHistogram(left, boxHist[order[k]]);
+      if (left.totWeight == 0 || left.totWeight == leaf.totWeight
+          || boxHist[order[k + 1]].totWeight == 0) {
+        continue;
+      }
+      right.totWeight = leaf.totWeight - left.totWeight;
+      for (int64_t i = 0; i < 2 * TOT_BINS; i++) {
+        right.weight[i] = leaf.weight[i] - left.weight[i];
+        right.sumDiff[i] = leaf.sumDiff[i] - left.sumDiff[i];
+      }
+      WorkCounters::add(WorkCounters::SPLIT_CANDIDATES);
+      long double p = left.totWeight / totWeight;
+      long double score = totScore - calcScore(left.weight, left.sumDiff) - calcScore(right.weight, right.sumDiff);
+      consider(score, { p, 1 - p },
+               { std::vector<int64_t>(order.begin(), order.begin() + k + 1),
+                 std::vector<int64_t>(order.begin() + k + 1, order.end()) }, !isNominal);
+    }
+  } else if (config_->useNominalBinary) {
+    // A box against the rest
+    for (int64_t k = 0; k < boxes; k++) {
+      if (boxHist[k].totWeight == 0 || boxHist[k].totWeight == leaf.totWeight) {
+        continue;
+      }
+      Histogram rest = createHistogram();
+      rest.totWeight = leaf.totWeight - boxHist[k].totWeight;
+      for (int64_t i = 0; i < 2 * TOT_BINS; i++) {
+        rest.weight[i] = leaf.weight[i] - boxHist[k].weight[i];
+        rest.sumDiff[i] = leaf.sumDiff[i] - boxHist[k].sumDiff[i];
+      }
+      std::vector<int64_t> others;
+      for (int64_t j = 0; j < boxes; j++) {
+        if (j != k) others.push_back(j);
+      }
+      WorkCounters::add(WorkCounters::SPLIT_CANDIDATES);
+      long double p = boxHist[k].totWeight / totWeight;
+      long double score = totScore - calcScore(boxHist[k].weight, boxHist[k].sumDiff)
+                          - calcScore(rest.weight, rest.sumDiff);
+      consider(score, { p, 1 - p }, { { k }, others }, false);
+    }
+  } else {
+    // A child per box
+    std::vector<long double> distrib(boxes);
+    std::vector<std::vector<int64_t>> children(boxes);
+    long double score = totScore;
+    for (int64_t k = 0; k < boxes; k++) {
+      distrib[k] = boxHist[k].totWeight / totWeight;
+      children[k].push_back(k);
+      score -= calcScore(boxHist[k].weight, boxHist[k].sumDiff);
+    }
+    WorkCounters::add(WorkCounters::SPLIT_CANDIDATES);
+    if (boxes > 1) {
+      consider(score, distrib, children, false);
+    }
+  }
+  return best;
+}
+
+
+StreamingPairTree::Histogram StreamingPairTree::createHistogram() {
+  Histogram hist;
+  hist.weight.assign(2 * TOT_BINS, 0);
+  hist.sumDiff.assign(2 * TOT_BINS, 0);
+  return hist;
+}
+
+
+StreamingPairTree::Histogram StreamingPairTree::getBoxHistogram(Leaf& leaf, int64_t attribInx, int64_t box) {
+  Histogram hist = createHistogram();
+  int64_t first = (firstPos_[attribInx] + box) * 2 * TOT_BINS;
+  for (int64_t i = 0; i < 2 * TOT_BINS; i++) {
+    hist.weight[i] = leaf.boxWeight[first + i];
+    hist.sumDiff[i] = leaf.boxSumDiff[first + i];
+    hist.totWeight += hist.weight[i];
+  }
+  return hist;
+}
+
+
+void StreamingPairTree::addHistogram(Histogram& to, const Histogram& from) {
+  to.totWeight += from.totWeight;
+  for (int64_t i = 0; i < 2 * TOT_BINS; i++) {
+    to.weight[i] += from.weight[i];
+    to.sumDiff[i] += from.sumDiff[i];
+  }
+}
+
+
+long double StreamingPairTree::getSignedDiff(const Histogram& hist) {
+  long double ans = 0;
+  for (int64_t b = 0; b < TOT_BINS; b++) {
+    ans += hist.sumDiff[b] - hist.sumDiff[TOT_BINS + b];
+  }
+  return ans;
+}
+
+
+// Sum over the pairs of rows of different classes of the smaller of their
+// differences, what PairTree's score adds for the pairs a split separates.
+// Pairs in the same bin count the mean of the bin's two classes.
+long double StreamingPairTree::calcScore(const std::vector<int64_t>& weight,
+                                         const std::vector<long double>& sumDiff) {
+  long double ans = 0;
+  long double above0 = 0;
+  long double above1 = 0;
+  for (int64_t b = TOT_BINS - 1; b >= 0; b--) {
+    long double weight0 = weight[b];
+    long double weight1 = weight[TOT_BINS + b];
+    ans += sumDiff[b] * above1 + sumDiff[TOT_BINS + b] * above0;
+    ans += (sumDiff[b] * weight1 + sumDiff[TOT_BINS + b] * weight0) / 2;
+    above0 += weight0;
+    above1 += weight1;
+  }
+  return ans;
+}
+
+
+// The bound of PairTree::getAttribBound with the constants of the leaf's
+// histograms. As for nominal splits in PairTree, the DIFF bound caps the VAR one.
+long double StreamingPairTree::calcBound(Leaf& leaf, long double score, long double totScore,
+                                         const std::vector<long double>& distrib) {
+  long double splitProb = 0;
+  for (auto p : distrib) {
+    splitProb += p * (1 - p);
+  }
+  long double expected = totScore * splitProb;
+  if (CompareUtils::compare(score, expected, 1e-7) <= 0) {
+    return 1;
+  }
+
+  // Rows without a difference are all in bin 0 of class 0, PairTree counts
+  // them in class 1 for this constant
+  int64_t best0 = 0;
+  for (int64_t b = 1; b < TOT_BINS; b++) {
+    best0 += leaf.weight[b];
+  }
+  PairTree::BoundConstants constants;
+  constants.xstar = std::max(best0, leaf.totWeight - best0);
+  constants.sumDSq = calcScore(leaf.weight, leaf.sumDiffSq);
+  long double bound = pairTree_.applyBound(score - expected, constants, PairTree::BoundType::DIFF_BOUND);
+  if (boundType_ == PairTree::BoundType::VAR_BOUND) {
+    constants.S = constants.sumDSq * (splitProb - splitProb * splitProb);
+    constants.b = std::min(leaf.maxDiff[0], leaf.maxDiff[1]) * (1 - splitProb);
+    bound = std::min(bound, pairTree_.applyBound(score - expected, constants, PairTree::BoundType::VAR_BOUND));
+  }
+  return bound;
+}
+
+
+void StreamingPairTree::splitLeaf(Leaf& leaf, const Split& split) {
+  int64_t attribInx = split.attrib;
+  std::shared_ptr<ExtrasTreeNode> node;
+  if (split.ordered) {
+    int64_t separator = getBoxEnd(attribInx, split.children[0].back());
+    node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_ORDERED, attribInx, separator);
+  } else {
+    node = std::make_shared<ExtrasTreeNode>(DecisionTreeNode::NodeType::REGULAR_NOMINAL, attribInx);
+  }
+  node->setAlpha(split.bound);
+  node->setNumSamples(leaf.totWeight);
+  node->setLeafValue(leaf.node->getLeafValue());
+
+  std::vector<std::unique_ptr<Leaf>> children;
+  for (const auto& boxes : split.children) {
+    // A new leaf starts with the class of the rows its boxes had in the parent
+    Histogram hist = createHistogram();
+    for (auto k : boxes) {
+      addHistogram(hist, getBoxHistogram(leaf, attribInx, k));
+    }
+    auto child = createLeaf(node, leaf.depth + 1, CompareUtils::compare(getSignedDiff(hist), 0) < 0 ? 1 : 0);
+    if (split.ordered) {
+      if (children.empty()) {
+        node->addLeftChild(child->node);
+      } else {
+        node->addRightChild(child->node);
+      }
+    } else {
+      std::vector<int64_t> values;
+      for (int64_t v = 0; v < attribSize_[attribInx]; v++) {
+        if (std::find(boxes.begin(), boxes.end(), getBox(attribInx, v)) != boxes.end()) {
+          values.push_back(v);
+        }
+      }
+      node->addChild(child->node, values);
+    }
+    children.push_back(std::move(child));
+  }
+
+  if (!leaf.parent) {
+    root_ = node;
+  } else {
+    for (auto& child : leaf.parent->children_) {
+      if (child.second == leaf.node) {
+        child.second = node;
+      }
+    }
+  }
+  // Frees the statistics of the split leaf, leaf isn't valid afterwards
+  leaves_.erase(leaf.node.get());
+  for (auto& child : children) {
+    DecisionTreeNode* key = child->node.get();
+    leaves_[key] = std::move(child);
+  }
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module learns a PairTree from a stream of rows in a single pass, in the
+// manner of a Hoeffding tree. Rows are routed to a leaf of the current tree,
+// whose statistics summarize the benefit differences of its rows per class,
+// per box of consecutive values of every attribute and per log-scaled bin of
+// the difference. Every gracePeriod rows a leaf scores the splits of each
+// attribute from those histograms as PairTree does from the samples, and
+// splits on the best one once its bound drops below maxBound. The statistics
+// of a leaf take a fixed size, whatever the number of rows it sees, and are
+// freed when it splits. Pairs of rows in the same difference bin count the
+// bin's mean difference instead of the smaller one, so scores are approximate.
+//
+
+#pragma once
+#include "ColumnFile.h"
+#include "DataSet.h"
+#include "DecisionTreeNode.h"
+#include "ExtrasTreeNode.h"
+#include "PairTree.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class StreamingPairTree {
+public:
+  // ds gives the attributes and classes the rows are encoded with, its samples
+  // are ignored. Only the DIFF and VAR bounds can be computed from the
+  // statistics.
+  StreamingPairTree(DataSet& ds, std::shared_ptr<ConfigPairTree> c);
+
+  // Adds a row given by its value index per attribute, as in
+  // Sample::inxValue_, its benefit per class and its weight, and splits its
+  // leaf if due
+  void add(const int64_t* inxValue, const double* benefit, int64_t weight);
+  void add(std::shared_ptr<Sample> s);
+  // Adds the samples of ds, or every row of columns, in order
+  void add(DataSet& ds);
+  void add(ColumnFile& columns);
+
+  // The current tree, a valid tree after any number of rows. Later calls to
+  // add keep growing it in place.
+  std::shared_ptr<DecisionTreeNode> getTree();
+
+  int64_t getTotRows();
+  int64_t getTotLeaves();
+  // Bytes of the statistics of the current leaves
+  int64_t getMemoryUsage();
+
+private:
+  struct Leaf {
+    std::shared_ptr<ExtrasTreeNode> node;
+    // Null for the root
+    std::shared_ptr<DecisionTreeNode> parent;
+    int64_t depth;
+    int64_t totWeight;
+    int64_t weightSinceCheck;
+    double classBenefit[2];
+    long double maxDiff[2];
+    // By class and bin, for the whole leaf
+    std::vector<int64_t> weight;
+    std::vector<long double> sumDiff;
+    std::vector<long double> sumDiffSq;
+    // By box position, class and bin
+    std::vector<int64_t> boxWeight;
+    std::vector<double> boxSumDiff;
+  };
+
+  // Weights and difference sums of a group of boxes, by class and bin
+  struct Histogram {
+    int64_t totWeight = 0;
+    std::vector<int64_t> weight;
+    std::vector<long double> sumDiff;
+  };
+
+  struct Split {
+    int64_t attrib = -1;
+    long double bound = 1;
+    long double score = 0;
+    // Box positions going to each child, in child order. An ordered split has
+    // a left and a right child.
+    std::vector<std::vector<int64_t>> children;
+    bool ordered = false;
+  };
+
+  std::unique_ptr<Leaf> createLeaf(std::shared_ptr<DecisionTreeNode> parent, int64_t depth, int64_t leafValue);
+  Leaf& findLeaf(const int64_t* inxValue);
+  int64_t getBin(long double diff);
+  int64_t getBox(int64_t attribInx, int64_t inxValue);
+  // Last value index of box of attribInx
+  int64_t getBoxEnd(int64_t attribInx, int64_t box);
+
+  int64_t getLeafBytes();
+
+  void trySplit(Leaf& leaf);
+  // The split of attribInx with the lowest bound
+  Split testAttribute(Leaf& leaf, int64_t attribInx, long double totScore);
+  Histogram createHistogram();
+  Histogram getBoxHistogram(Leaf& leaf, int64_t attribInx, int64_t box);
+  void addHistogram(Histogram& to, const Histogram& from);
+  // Sum of the benefit differences b0 - b1 of the rows
+  long double getSignedDiff(const Histogram& hist);
+  long double calcScore(const std::vector<int64_t>& weight, const std::vector<long double>& sumDiff);
+  long double calcBound(Leaf& leaf, long double score, long double totScore,
+                        const std::vector<long double>& distrib);
+  void splitLeaf(Leaf& leaf, const Split& split);
+
+  std::shared_ptr<ConfigPairTree> config_;
+  PairTree::BoundType boundType_;
+  PairTree pairTree_;
+  int64_t totAttributes_;
+  std::vector<AttributeType> attribType_;
+  std::vector<int64_t> attribSize_;
+  std::vector<int64_t> attribBoxes_;
+  // The boxes of attribute a are positions firstPos_[a] onwards
+  std::vector<int64_t> firstPos_;
+  int64_t totBoxes_;
+  // Bins are relative to the first positive difference seen
+  bool hasScale_;
+  long double lowLog2_;
+
+  std::shared_ptr<DecisionTreeNode> root_;
+  std::unordered_map<DecisionTreeNode*, std::unique_ptr<Leaf>> leaves_;
+  int64_t totRows_;
+};
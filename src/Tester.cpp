@@ -4,7 +4,16 @@
 #include "Tester.h"
 
 #include "CompareUtils.h"
+#include "Converter.h"
+#include "ErrorUtils.h"
+#include "HardwareCounters.h"
+#include "Profiler.h"
+#include "QuickScorer.h"
+#include "RawTree.h"
+#include "ReadCSV.h"
+#include "WorkCounters.h"
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 #include <iomanip>
@@ -12,12 +21,22 @@
 
 
 Tester::TestResults Tester::test(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds) {
+  Profiler::ScopedTimer timer(Profiler::TESTING);
   TestResults result;
   result.score = 0;
-  for (const auto& s : ds.samples_) {
-    int64_t classInx = tree->classify(s);
-    result.score += s->benefit_[classInx];
+  // Counted per row, a collapsed sample stands for weight_ rows
+  int64_t pathLength = 0;
+  {
+    HardwareCounters::ScopedRegion region(HardwareCounters::CLASSIFY);
+    for (const auto& s : ds.samples_) {
+      int64_t samplePath = 0;
+      int64_t classInx = tree->classify(s, samplePath);
+      pathLength += samplePath * s->weight_;
+      result.score += s->benefit_[classInx];
+    }
   }
+  WorkCounters::add(WorkCounters::SAMPLES_CLASSIFIED, ds.getTotWeight());
+  WorkCounters::add(WorkCounters::PATH_LENGTH, pathLength);
 
   auto best = ds.getBestClass();
   result.savings = std::numeric_limits<long double>::quiet_NaN();
@@ -30,6 +49,143 @@ Tester::TestResults Tester::test(std::shared_ptr<DecisionTreeNode> tree, DataSet
 }
 
 
+std::vector<Tester::TestResults> Tester::testMany(
+    const std::vector<std::shared_ptr<DecisionTreeNode>>& trees, DataSet& ds) {
+  std::vector<TestResults> results(trees.size());
+  if (trees.empty()) {
+    return results;
+  }
+  Profiler::ScopedTimer timer(Profiler::TESTING);
+  QuickScorer scorer(trees);
+  std::vector<int64_t> classes(trees.size());
+  // Counted per row as in test
+  std::vector<int64_t> pathLength(trees.size(), 0);
+  std::vector<int64_t> samplePath(trees.size());
+  for (auto& result : results) {
+    result.score = 0;
+  }
+  {
+    HardwareCounters::ScopedRegion region(HardwareCounters::CLASSIFY);
+    for (const auto& s : ds.samples_) {
+      ErrorUtils::enforce(scorer.getTotAttributes() <= s->inxValue_.size(),
+                          "Sample doesn't have the required column");
+      std::fill(samplePath.begin(), samplePath.end(), 0);
+      scorer.classify(&s->inxValue_[0], &classes[0], &samplePath[0]);
+      for (int64_t t = 0; t < trees.size(); t++) {
+        results[t].score += s->benefit_[classes[t]];
+        pathLength[t] += samplePath[t] * s->weight_;
+      }
+    }
+  }
+  WorkCounters::add(WorkCounters::SAMPLES_CLASSIFIED, ds.getTotWeight() * trees.size());
+  for (auto length : pathLength) {
+    WorkCounters::add(WorkCounters::PATH_LENGTH, length);
+  }
+
+  auto best = ds.getBestClass();
+  for (int64_t t = 0; t < trees.size(); t++) {
+    results[t].savings = std::numeric_limits<long double>::quiet_NaN();
+    if (CompareUtils::compare(best.second, 0) != 0) {
+      results[t].savings = 1 - results[t].score / best.second;
+    }
+    results[t].size = trees[t]->getSize();
+  }
+
+  return results;
+}
+
+
+std::vector<Tester::TestResults> Tester::testStream(
+    const std::vector<std::shared_ptr<DecisionTreeNode>>& trees, DataSet& trainDS,
+    std::string testFileName, int64_t classColStart, int64_t chunkRows) {
+  std::vector<TestResults> results(trees.size());
+  if (trees.empty()) {
+    return results;
+  }
+  std::vector<RawTree> rawTrees;
+  for (const auto& tree : trees) {
+    rawTrees.push_back(RawTree(tree, trainDS));
+  }
+  int64_t totAttrib = trainDS.getTotAttributes();
+  int64_t totClasses = trainDS.getTotClasses();
+  int64_t totColumns = totAttrib + (classColStart <= 0 ? 1 : totClasses);
+
+  for (auto& result : results) {
+    result.score = 0;
+  }
+  // Benefit of giving every sample the same class, for the savings
+  std::vector<double> classBenefit(totClasses, 0);
+  // Per row of the chunk, its benefits and numeric values
+  std::vector<double> benefits;
+  std::vector<double> numbers;
+  std::vector<double> rowNumbers;
+
+  ReadCSV csvReader;
+  csvReader.open(testFileName);
+  std::vector<std::vector<std::string>> rows;
+  bool header = true;
+  while (csvReader.readChunk(rows, chunkRows)) {
+    // The values are parsed first, so only scoring is timed as testing
+    int64_t first = 0;
+    if (header && !rows.empty()) {
+      ErrorUtils::enforce(rows[0].size() == totColumns, "Train and test number of attributes don't match.");
+      header = false;
+      first = 1;
+    }
+    int64_t totRows = rows.size() - first;
+    {
+      Profiler::ScopedTimer timer(Profiler::SAMPLE_ENCODING);
+      benefits.assign(totRows * totClasses, 0);
+      numbers.resize(totRows * totAttrib);
+      for (int64_t r = 0; r < totRows; r++) {
+        const auto& row = rows[first + r];
+        ErrorUtils::enforce(row.size() == totColumns, "Train and test number of attributes don't match.");
+        double* benefit = &benefits[r * totClasses];
+        if (classColStart <= 0) {
+          int64_t classInx = trainDS.getClassInx(row[totAttrib]);
+          ErrorUtils::enforce(classInx >= 0, "Test class " + row[totAttrib] + " not found in training.");
+          benefit[classInx] = -1;
+        } else {
+          for (int64_t c = 0; c < totClasses; c++) {
+            benefit[c] = -Converter::fromString<double>(row[totAttrib + c]);
+          }
+        }
+        for (int64_t c = 0; c < totClasses; c++) {
+          classBenefit[c] += benefit[c];
+        }
+        rawTrees[0].parseNumbers(row, rowNumbers);
+        std::copy(rowNumbers.begin(), rowNumbers.end(), numbers.begin() + r * totAttrib);
+      }
+    }
+
+    Profiler::ScopedTimer timer(Profiler::TESTING);
+    HardwareCounters::ScopedRegion region(HardwareCounters::CLASSIFY);
+    for (int64_t r = 0; r < totRows; r++) {
+      const double* benefit = &benefits[r * totClasses];
+      for (int64_t t = 0; t < rawTrees.size(); t++) {
+        results[t].score += benefit[rawTrees[t].classify(&numbers[r * totAttrib], rows[first + r].data())];
+      }
+    }
+  }
+
+  int64_t bestInx = 0;
+  for (int64_t c = 1; c < totClasses; c++) {
+    if (CompareUtils::compare(classBenefit[c], classBenefit[bestInx]) > 0) {
+      bestInx = c;
+    }
+  }
+  for (int64_t t = 0; t < trees.size(); t++) {
+    results[t].savings = std::numeric_limits<long double>::quiet_NaN();
+    if (CompareUtils::compare(classBenefit[bestInx], 0) != 0) {
+      results[t].savings = 1 - results[t].score / classBenefit[bestInx];
+    }
+    results[t].size = trees[t]->getSize();
+  }
+
+  return results;
+}
+
+
 void Tester::saveResult(TestResults result, std::string outputFileName) {
   std::ofstream ofs(outputFileName, std::ofstream::app);
   ofs << "Score "
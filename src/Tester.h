@@ -6,6 +6,7 @@
 #include "DecisionTreeNode.h"
 
 #include <memory>
+#include <vector>
 
 class Tester {
 public:
@@ -16,5 +17,18 @@ public:
   };
   TestResults test(std::shared_ptr<DecisionTreeNode> tree, DataSet& ds);
 
+  // Same results as calling test on each tree, scoring all the trees in a
+  // single pass over the samples with QuickScorer
+  std::vector<TestResults> testMany(const std::vector<std::shared_ptr<DecisionTreeNode>>& trees,
+                                    DataSet& ds);
+
+  // Tests the trees on a CSV read chunkRows rows at a time, without building
+  // a test DataSet. Values are read with the dictionaries of trainDS through
+  // RawTree, so numbers not seen in training follow the split thresholds and
+  // unknown categories stop at the node they reach.
+  std::vector<TestResults> testStream(const std::vector<std::shared_ptr<DecisionTreeNode>>& trees,
+                                      DataSet& trainDS, std::string testFileName,
+                                      int64_t classColStart, int64_t chunkRows = 65536);
+
   void saveResult(TestResults result, std::string outputFileName);
 };
@@ -0,0 +1,67 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements per thread accumulators for the run reports. Each
+// thread writes to its own T without locking, and merged() combines the
+// values of all live threads plus the ones already finished.
+//
+
+#pragma once
+#include <mutex>
+#include <set>
+
+template <typename T, void (*Accumulate)(T&, const T&)>
+class ThreadLocalStats {
+public:
+  static T& local() {
+    thread_local Holder holder;
+    return holder.value;
+  }
+
+  // Should not run concurrently with reset()
+  static T merged() {
+    std::lock_guard<std::mutex> lock(mutex());
+    T ans = retired();
+    for (auto holder : registry()) {
+      Accumulate(ans, holder->value);
+    }
+    return ans;
+  }
+
+  static void reset() {
+    std::lock_guard<std::mutex> lock(mutex());
+    retired() = T();
+    for (auto holder : registry()) {
+      holder->value = T();
+    }
+  }
+
+private:
+  struct Holder {
+    Holder() {
+      std::lock_guard<std::mutex> lock(mutex());
+      registry().insert(this);
+    }
+    ~Holder() {
+      std::lock_guard<std::mutex> lock(mutex());
+      Accumulate(retired(), value);
+      registry().erase(this);
+    }
+    T value;
+  };
+
+  static std::mutex& mutex() {
+    static std::mutex m;
+    return m;
+  }
+
+  static std::set<Holder*>& registry() {
+    static std::set<Holder*> holders;
+    return holders;
+  }
+
+  static T& retired() {
+    static T value;
+    return value;
+  }
+};
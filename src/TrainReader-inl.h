@@ -8,6 +8,15 @@ T TrainReader::getVar(luabridge::lua_State* L, std::string name) {
   return ans.cast<T>();
 }
 
+template <typename T>
+T TrainReader::getVar(luabridge::lua_State* L, std::string name, T defaultValue) {
+  auto ans = luabridge::getGlobal(L, name.c_str());
+  if (ans.isNil()) {
+    return defaultValue;
+  }
+  return ans.cast<T>();
+}
+
 template <typename T>
 T TrainReader::getVar(luabridge::LuaRef& table, std::string name) {
   auto ans = table[name.c_str()];
@@ -15,6 +24,15 @@ T TrainReader::getVar(luabridge::LuaRef& table, std::string name) {
   return ans.cast<T>();
 }
 
+template <typename T>
+T TrainReader::getVar(luabridge::LuaRef& table, std::string name, T defaultValue) {
+  auto ans = table[name.c_str()];
+  if (ans.isNil()) {
+    return defaultValue;
+  }
+  return ans.cast<T>();
+}
+
 template <typename T>
 T TrainReader::getVar(luabridge::LuaRef& table, int index) {
   auto ans = table[index];
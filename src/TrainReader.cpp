@@ -21,11 +21,16 @@ std::shared_ptr<ConfigTrain> TrainReader::read(std::string fileName) {
   lua_pcall(L, 0, 0, 0);
   config->outputFolder = getVar<std::string>(L, "output");
   config->name = getVar<std::string>(L, "name");
+  config->hardwareCounters = getVar<bool>(L, "hardwareCounters", false);
+  config->saveModel = getVar<bool>(L, "saveModel", false);
+  config->generateCode = getVar<bool>(L, "generateCode", false);
 
   auto dataset = getTable(L, "dataset");
   if (!dataset.isNil()) {
     config->dataSetFile = getVar<std::string>(dataset, "filename");
     config->classColStart = getVar<int>(dataset, "classColStart");
+    config->collapseDuplicates = getVar<bool>(dataset, "collapseDuplicates", false);
+    config->outOfCore = getVar<bool>(dataset, "outOfCore", false);
   } else {
     std::cout << "Invalid dataset table." << std::endl;
     return nullptr;
@@ -46,6 +51,8 @@ std::shared_ptr<ConfigTrain> TrainReader::read(std::string fileName) {
       config->trainMode = std::make_shared<ConfigTrainMode>();
       config->trainMode->type = ConfigTrainMode::trainType::TEST_SET;
       config->trainMode->testFileName = getVar<std::string>(trainMode, "filename");
+      config->trainMode->stream = getVar<bool>(trainMode, "stream", false);
+      config->trainMode->chunkRows = getVar<int>(trainMode, "chunkRows", 65536);
     } else if (auxType.compare("trainingset") == 0) {
       config->trainMode = std::make_shared<ConfigTrainMode>();
       config->trainMode->type = ConfigTrainMode::trainType::TRAINING_SET;
@@ -72,6 +79,12 @@ std::shared_ptr<ConfigTrain> TrainReader::read(std::string fileName) {
       gtConfig->percentiles = getVar<int>(tree, "percentiles");
       gtConfig->minGain = getVar<double>(tree, "minGain");
       gtConfig->useNominalBinary = getVar<bool>(tree, "useNominalBinary");
+      gtConfig->useNominalOrdered = getVar<bool>(tree, "useNominalOrdered", false);
+      gtConfig->levelWise = getVar<bool>(tree, "levelWise", false);
+      gtConfig->threads = getVar<int>(tree, "threads", 1);
+      gtConfig->parallelRows = getVar<int>(tree, "parallelRows", 1000000);
+      gtConfig->maxLeaves = getVar<int>(tree, "maxLeaves", 0);
+      gtConfig->maxSeconds = getVar<double>(tree, "maxSeconds", 0);
       luabridge::LuaRef minSamples = tree["minSamples"];
       int i = 0;
       while (!minSamples[i].isNil()) {
@@ -121,7 +134,15 @@ std::shared_ptr<ConfigTrain> TrainReader::read(std::string fileName) {
       pairConfig->minLeaf = getVar<int>(tree, "minLeaf");
       pairConfig->useScore = getVar<bool>(tree, "useScore");
       pairConfig->useNominalBinary = getVar<bool>(tree, "useNominalBinary");
+      pairConfig->useNominalOrdered = getVar<bool>(tree, "useNominalOrdered", false);
       pairConfig->boundOption = getVar<std::string>(tree, "boundOption");
+      pairConfig->maxLeaves = getVar<int>(tree, "maxLeaves", 0);
+      pairConfig->maxSeconds = getVar<double>(tree, "maxSeconds", 0);
+      pairConfig->streaming = getVar<bool>(tree, "streaming", false);
+      pairConfig->gracePeriod = getVar<int>(tree, "gracePeriod", 200);
+      pairConfig->valueBoxes = getVar<int>(tree, "valueBoxes", 32);
+      pairConfig->threads = getVar<int>(tree, "threads", 1);
+      pairConfig->parallelRows = getVar<int>(tree, "parallelRows", 1000000);
       luabridge::LuaRef minSamples = tree["minSamples"];
       int i = 0;
       while (!minSamples[i].isNil()) {
@@ -147,6 +168,12 @@ std::shared_ptr<ConfigTrain> TrainReader::read(std::string fileName) {
       aodhaConfig->minLeaf = getVar<int>(tree, "minLeaf");
       aodhaConfig->minGain = getVar<double>(tree, "minGain");
       aodhaConfig->useNominalBinary = getVar<bool>(tree, "useNominalBinary");
+      aodhaConfig->useNominalOrdered = getVar<bool>(tree, "useNominalOrdered", false);
+      aodhaConfig->levelWise = getVar<bool>(tree, "levelWise", false);
+      aodhaConfig->threads = getVar<int>(tree, "threads", 1);
+      aodhaConfig->parallelRows = getVar<int>(tree, "parallelRows", 1000000);
+      aodhaConfig->maxLeaves = getVar<int>(tree, "maxLeaves", 0);
+      aodhaConfig->maxSeconds = getVar<double>(tree, "maxSeconds", 0);
       luabridge::LuaRef minSamples = tree["minSamples"];
       int i = 0;
       while (!minSamples[i].isNil()) {
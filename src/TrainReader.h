@@ -24,17 +24,28 @@ public:
   std::string testFileName;
   double ratio;
   int folds;
+  // TEST_SET only: tests on testFileName in chunks instead of loading it
+  bool stream = false;
+  int64_t chunkRows = 65536;
 };
 
 class ConfigTrain {
 public:
   std::string dataSetFile;
   int64_t classColStart;
+  // Trains and tests on weighted samples, see DataSetBuilder::collapseDuplicates
+  bool collapseDuplicates;
+  // Grows greedy and aodha trees level-wise over a column file of dataSetFile
+  // instead of loading it, see LevelWiseTree. Needs a TEST_SET stream trainMode.
+  bool outOfCore = false;
   std::string outputFolder;
   std::string name;
   std::vector<std::shared_ptr<ConfigTree>> configTrees;
   std::vector<std::shared_ptr<Tree>> trees;
   std::shared_ptr<ConfigTrainMode> trainMode;
+  bool hardwareCounters;
+  bool saveModel = false;
+  bool generateCode;
 };
 
 class TrainReader {
@@ -44,9 +55,14 @@ public:
 private:
   template <typename T>
   T getVar(luabridge::lua_State* L, std::string name);
+  // Returns defaultValue when the variable is not set
+  template <typename T>
+  T getVar(luabridge::lua_State* L, std::string name, T defaultValue);
   template <typename T>
   T getVar(luabridge::LuaRef& table, std::string name);
   template <typename T>
+  T getVar(luabridge::LuaRef& table, std::string name, T defaultValue);
+  template <typename T>
   T getVar(luabridge::LuaRef& table, int index);
   luabridge::LuaRef getTable(luabridge::lua_State* L, std::string name);
 };
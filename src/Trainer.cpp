@@ -4,12 +4,21 @@
 #include "Trainer.h"
 
 #include "AodhaTree.h"
+#include "CodeGenerator.h"
 #include "CompareUtils.h"
+#include "DagBuilder.h"
 #include "DataSet.h"
 #include "DataSetBuilder.h"
+#include "ErrorUtils.h"
 #include "GreedyTree.h"
+#include "HardwareCounters.h"
+#include "LevelWiseTree.h"
 #include "Logger.h"
+#include "MemoryUsage.h"
+#include "ModelWriter.h"
 #include "PairTree.h"
+#include "Profiler.h"
+#include "StreamingPairTree.h"
 #include "ExtrasTreeNode.h"
 #include "Tester.h"
 
@@ -46,10 +55,35 @@ void Trainer::train(std::string fileName) {
   summaryFile << "Summary file" << std::endl;
   summaryFile.close();
 
+  Profiler::reset();
+  WorkCounters::reset();
+  HardwareCounters::setEnabled(config->hardwareCounters);
+  runStats_.clear();
   DataSetBuilder builder;
   DataSet trainDS;
   DataSet testDS;
-  if (config->trainMode->type == ConfigTrainMode::trainType::TEST_SET) {
+  columns_.reset();
+  // Split files and ratios count the rows of the file, not merged samples
+  ErrorUtils::enforce(!config->collapseDuplicates
+                      || config->trainMode->type == ConfigTrainMode::trainType::TRAINING_SET
+                      || config->trainMode->type == ConfigTrainMode::trainType::TEST_SET,
+                      "collapseDuplicates needs a trainingset or testset trainMode.");
+  if (config->outOfCore) {
+    ErrorUtils::enforce(config->trainMode->type == ConfigTrainMode::trainType::TEST_SET
+                        && config->trainMode->stream && !config->collapseDuplicates,
+                        "outOfCore needs a testset trainMode with stream and no collapseDuplicates.");
+    trainDS = builder.buildDictionariesFromFile(config->dataSetFile, config->classColStart,
+                                                config->trainMode->chunkRows);
+    testDS.initAllAttributes(trainDS);
+    std::string columnsFileName = outputFolder_ + "train.col";
+    ColumnFile::write(columnsFileName, config->dataSetFile, config->classColStart, trainDS,
+                      config->trainMode->chunkRows);
+    columns_ = std::make_shared<ColumnFile>(columnsFileName);
+  } else if (config->trainMode->type == ConfigTrainMode::trainType::TEST_SET
+      && config->trainMode->stream) {
+    trainDS = builder.buildFromFile(config->dataSetFile, config->classColStart);
+    testDS.initAllAttributes(trainDS);
+  } else if (config->trainMode->type == ConfigTrainMode::trainType::TEST_SET) {
     builder.buildTrainTestFromFile(config->dataSetFile, config->trainMode->testFileName,
                                    config->classColStart, trainDS, testDS);
   }
@@ -63,6 +97,23 @@ void Trainer::train(std::string fileName) {
   } else if (config->trainMode->type == ConfigTrainMode::trainType::SPLIT) {
     trainDS = builder.buildFromFile(config->dataSetFile, config->classColStart);
   }
+  if (config->collapseDuplicates) {
+    // Greedy and GreedyBB trees only sum the benefits, the others need the
+    // rows of a merged sample to have the same benefits
+    bool sameBenefits = false;
+    for (const auto& configTree : config->configTrees) {
+      if (configTree->typeName != "greedy" && configTree->typeName != "greedyBB") {
+        sameBenefits = true;
+      }
+    }
+    // Kept samples are copied before changing, so a testDS sharing them is unaffected
+    builder.collapseDuplicates(trainDS, sameBenefits);
+    builder.collapseDuplicates(testDS, sameBenefits);
+  }
+  loadTiming_ = Profiler::snapshot();
+  loadCounters_ = WorkCounters::snapshot();
+  trainSamplesBytes_ = trainDS.getSamplesMemoryUsage();
+  testSamplesBytes_ = testDS.getSamplesMemoryUsage();
 
   for (int64_t i = 0; i < config->configTrees.size(); i++) {
     long double score = 0;
@@ -82,7 +133,7 @@ void Trainer::train(std::string fileName) {
       size = runResult.size;
       totSeconds += runResult.seconds;
     } else {
-      auto result = runTree(config, i, trainDS, testDS);
+      auto result = runTree(config, i, trainDS, testDS, 0);
       score = result.score;
       savings = result.savings;
       size = result.size;
@@ -98,6 +149,14 @@ void Trainer::train(std::string fileName) {
                 << savings << std::endl
                 << size << std::endl;
     summaryFile.close();
+
+    // Rewritten after every tree so an interrupted run keeps its reports
+    saveTiming(trainDS);
+    saveCounters(trainDS);
+    if (config->hardwareCounters) {
+      saveHardwareCounters();
+    }
+    saveMemory(trainDS);
   }
 
   Logger::closeOutput();
@@ -115,7 +174,7 @@ Trainer::TreeResult Trainer::execRandomSplit(std::shared_ptr<ConfigTrain> config
 
   for (int fold = 0; fold < config->trainMode->folds; fold++) {
     getRandomSplit(trainDS, testDS, config->trainMode->ratio);
-    auto result = runTree(config, treeInx, trainDS, testDS);
+    auto result = runTree(config, treeInx, trainDS, testDS, fold);
     runResult.score += result.score;
     runResult.savings += result.savings;
     runResult.size += result.size;
@@ -139,7 +198,7 @@ Trainer::TreeResult Trainer::execSplit(std::shared_ptr<ConfigTrain> config,
     currTrain.initAllAttributes(trainDS);
     currTest.initAllAttributes(trainDS);
     getSplit(trainDS, currTrain, currTest, config->dataSetFile, fold);
-    auto foldResult = runTree(config, treeInx, currTrain, currTest);
+    auto foldResult = runTree(config, treeInx, currTrain, currTest, fold);
 
     if (foldResult.alphaXsamples.size() > 0) {
       // Update sum of all alphaXsamples matrix
@@ -257,10 +316,31 @@ void Trainer::loadSplit(DataSet& originalDS, DataSet& current, std::string fileN
 }
 
 
+std::shared_ptr<DecisionTreeNode> Trainer::createTree(std::shared_ptr<ConfigTrain>& config, int treeInx,
+                                                      DataSet& trainDS) {
+  if (columns_ && config->configTrees[treeInx]->typeName == "pair") {
+    auto pairConfig = std::static_pointer_cast<ConfigPairTree>(config->configTrees[treeInx]);
+    ErrorUtils::enforce(pairConfig->streaming, "Error! outOfCore pair trees need streaming = true.");
+    StreamingPairTree tree(trainDS, pairConfig);
+    tree.add(*columns_);
+    return tree.getTree();
+  }
+  if (columns_) {
+    return LevelWiseTree().createTree(*columns_, trainDS, config->configTrees[treeInx]);
+  }
+  return config->trees[treeInx]->createTree(trainDS, config->configTrees[treeInx]);
+}
+
+
 Trainer::TreeResult Trainer::runTree(std::shared_ptr<ConfigTrain>& config, int treeInx,
-                                     DataSet& trainDS, DataSet& testDS) {
+                                     DataSet& trainDS, DataSet& testDS, int fold) {
   // Log starting test
   auto start = std::chrono::system_clock::now();
+  Profiler::reset();
+  WorkCounters::reset();
+  HardwareCounters::reset();
+  MemoryUsage::reset();
+  int64_t startNanoseconds = Profiler::now();
   Logger::log() << "Starting test " << config->configTrees[treeInx]->name;
 
   // Create model output file
@@ -276,18 +356,31 @@ Trainer::TreeResult Trainer::runTree(std::shared_ptr<ConfigTrain>& config, int t
   if (config->configTrees[treeInx]->typeName.compare("pair") == 0
       || config->configTrees[treeInx]->typeName.compare("greedy") == 0
       || config->configTrees[treeInx]->typeName.compare("aodha") == 0) {
-    treeResult = runAlphaSamplesTrees(config, treeInx, trainDS, testDS);
+    treeResult = runAlphaSamplesTrees(config, treeInx, trainDS, testDS, fold);
     testResult.savings = treeResult.savings;
     testResult.score = treeResult.score;
     testResult.size = treeResult.size;
   } else {
-    std::shared_ptr<DecisionTreeNode> tree = config->trees[treeInx]->createTree(trainDS,
-                                                config->configTrees[treeInx]);
+    std::shared_ptr<DecisionTreeNode> tree = createTree(config, treeInx, trainDS);
     trainDS.printTree(tree, outputFileName);
-    testResult = tester.test(tree, testDS);
+    auto dag = DagBuilder().share(tree);
+    if (config->saveModel) {
+      ModelWriter().save(getModelFileName(config, treeInx, fold), dag, trainDS);
+    }
+    treeResult.treeUniqueNodes = dag->getUniqueSize();
+    if (config->generateCode) {
+      saveCode(config, treeInx, fold, tree, trainDS, testDS);
+    }
+    if (config->trainMode->stream) {
+      testResult = streamTest(config, { tree }, trainDS)[0];
+    } else {
+      testResult = tester.test(tree, testDS);
+    }
     treeResult.savings = testResult.savings;
     treeResult.score = testResult.score;
     treeResult.size = testResult.size;
+    treeResult.treeNodes = tree->getSize();
+    treeResult.treeBytes = tree->getMemoryUsage();
   }
   tester.saveResult(testResult, outputFileName);
 
@@ -298,13 +391,28 @@ Trainer::TreeResult Trainer::runTree(std::shared_ptr<ConfigTrain>& config, int t
 
   treeResult.seconds = countSeconds;
 
+  RunStats stats;
+  stats.treeName = config->configTrees[treeInx]->name;
+  stats.fold = fold;
+  stats.nanoseconds = Profiler::now() - startNanoseconds;
+  stats.timing = Profiler::snapshot();
+  stats.counters = WorkCounters::snapshot();
+  stats.hardware = HardwareCounters::snapshot();
+  stats.temporaries = MemoryUsage::snapshot();
+  stats.treeNodes = treeResult.treeNodes;
+  stats.treeBytes = treeResult.treeBytes;
+  stats.treeUniqueNodes = treeResult.treeUniqueNodes;
+  stats.peakRSS = MemoryUsage::getPeakRSS();
+  runStats_.push_back(stats);
+
   return treeResult;
 }
 
 
 Trainer::TreeResult Trainer::runAlphaSamplesTrees(std::shared_ptr<ConfigTrain>& config,
                                                   int treeInx,
-                                                  DataSet& trainDS, DataSet& testDS) {
+                                                  DataSet& trainDS, DataSet& testDS,
+                                                  int fold) {
   std::vector<long double> alphas;
   std::vector<int64_t> minSamples;
   
@@ -323,6 +431,9 @@ Trainer::TreeResult Trainer::runAlphaSamplesTrees(std::shared_ptr<ConfigTrain>&
     ans.score = -1;
     ans.savings = -1;
     ans.size = -1;
+    ans.treeNodes = 0;
+    ans.treeBytes = 0;
+    ans.treeUniqueNodes = 0;
     return ans;
   }
 
@@ -335,16 +446,38 @@ Trainer::TreeResult Trainer::runAlphaSamplesTrees(std::shared_ptr<ConfigTrain>&
   Tester tester;
   auto start = std::chrono::system_clock::now();
   std::shared_ptr<ExtrasTreeNode> fullTree = std::static_pointer_cast<ExtrasTreeNode>(
-                                              config->trees[treeInx]->createTree(trainDS, config->configTrees[treeInx]));
+                                              createTree(config, treeInx, trainDS));
   int64_t countMilliSeconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start).count();
   Logger::log() << "Time to create tree " << countMilliSeconds << " ms";
+  treeResult.treeNodes = fullTree->getSize();
+  treeResult.treeBytes = fullTree->getMemoryUsage(sizeof(ExtrasTreeNode));
+  // Saved before pruning, MappedModel::toTree gives it back for getTree
+  auto dag = DagBuilder().share(fullTree);
+  if (config->saveModel) {
+    ModelWriter().save(getModelFileName(config, treeInx, fold), dag, trainDS);
+  }
+  treeResult.treeUniqueNodes = dag->getUniqueSize();
+  if (config->generateCode) {
+    saveCode(config, treeInx, fold, fullTree, trainDS, testDS);
+  }
+
+  // All the pruned trees are tested together in one pass over testDS
+  std::vector<std::shared_ptr<DecisionTreeNode>> alphaSampleTrees;
+  for (int i = 0; i < alphas.size(); i++) {
+    for (int j = 0; j < minSamples.size(); j++) {
+      Profiler::ScopedTimer timer(Profiler::PRUNING);
+      alphaSampleTrees.push_back(fullTree->getTree(alphas[i], minSamples[j]));
+    }
+  }
+  auto alphaSampleResults = config->trainMode->stream ? streamTest(config, alphaSampleTrees, trainDS)
+                                                      : tester.testMany(alphaSampleTrees, testDS);
 
   for (int i = 0; i < alphas.size(); i++) {
     auto alpha = alphas[i];
     for (int j = 0; j < minSamples.size(); j++) {
       auto samples = minSamples[j];
-      auto alphaSampleTree = fullTree->getTree(alpha, samples);
-      auto alphaSampleResult = tester.test(alphaSampleTree, testDS);
+      auto alphaSampleTree = alphaSampleTrees[i * minSamples.size() + j];
+      auto alphaSampleResult = alphaSampleResults[i * minSamples.size() + j];
 
       treeResult.score += alphaSampleResult.score;
       treeResult.savings += alphaSampleResult.savings;
@@ -365,3 +498,308 @@ Trainer::TreeResult Trainer::runAlphaSamplesTrees(std::shared_ptr<ConfigTrain>&
 
   return treeResult;
 }
+
+
+std::string Trainer::getModelFileName(std::shared_ptr<ConfigTrain>& config, int treeInx, int fold) {
+  return outputFolder_ + "model_" + config->configTrees[treeInx]->name
+    + "_fold" + std::to_string(fold) + ".bin";
+}
+
+
+// The harness checks the generated code on the test samples, which share
+// the dictionaries of the training set, or on the training samples when the
+// test set is streamed
+void Trainer::saveCode(std::shared_ptr<ConfigTrain>& config, int treeInx, int fold,
+                       std::shared_ptr<DecisionTreeNode> tree, DataSet& trainDS, DataSet& testDS) {
+  std::string baseName = outputFolder_ + "tree_" + config->configTrees[treeInx]->name
+    + "_fold" + std::to_string(fold);
+  CodeGenerator generator;
+  generator.writeSource(tree, trainDS, baseName + ".cpp");
+  generator.writeHarness(tree, testDS.samples_.empty() ? trainDS : testDS, baseName + "_check.cpp");
+}
+
+
+std::vector<Tester::TestResults> Trainer::streamTest(std::shared_ptr<ConfigTrain>& config,
+    const std::vector<std::shared_ptr<DecisionTreeNode>>& trees, DataSet& trainDS) {
+  Tester tester;
+  return tester.testStream(trees, trainDS, config->trainMode->testFileName,
+                           config->classColStart, config->trainMode->chunkRows);
+}
+
+
+void Trainer::saveTiming(DataSet& ds) {
+  std::string fileName = outputFolder_ + "timing.json";
+  std::ofstream ofs(fileName, std::ofstream::out);
+  if (!ofs.is_open()) {
+    Logger::log() << "Error: can't create " << fileName;
+    return;
+  }
+
+  JsonWriter json(ofs);
+  json.beginObject();
+  json.field("clock", "steady_clock");
+  json.field("unit", "ns");
+  json.key("load");
+  writePhases(json, loadTiming_, ds);
+  json.key("trees");
+  json.beginArray();
+  int64_t i = 0;
+  while (i < runStats_.size()) {
+    // Folds of the same tree are consecutive
+    int64_t j = i;
+    int64_t totNanoseconds = 0;
+    Profiler::Snapshot total;
+    while (j < runStats_.size() && runStats_[j].treeName == runStats_[i].treeName) {
+      totNanoseconds += runStats_[j].nanoseconds;
+      Profiler::accumulate(total, runStats_[j].timing);
+      j++;
+    }
+
+    json.beginObject();
+    json.field("name", runStats_[i].treeName);
+    json.field("total", totNanoseconds);
+    json.key("phases");
+    writePhases(json, total, ds);
+    json.key("folds");
+    json.beginArray();
+    for (int64_t k = i; k < j; k++) {
+      json.beginObject();
+      json.field("fold", runStats_[k].fold);
+      json.field("total", runStats_[k].nanoseconds);
+      json.key("phases");
+      writePhases(json, runStats_[k].timing, ds);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    i = j;
+  }
+  json.endArray();
+  json.endObject();
+  ofs.close();
+}
+
+
+void Trainer::writePhases(JsonWriter& json, const Profiler::Snapshot& snapshot, DataSet& ds) {
+  json.beginObject();
+  for (int64_t p = 0; p < Profiler::TOT_PHASES; p++) {
+    json.key(Profiler::getPhaseName((Profiler::Phase)p));
+    json.beginObject();
+    json.field("ns", snapshot.phases[p].nanoseconds);
+    json.field("calls", snapshot.phases[p].calls);
+    json.endObject();
+  }
+  json.key("splitSearchByAttribute");
+  json.beginArray();
+  for (int64_t a = 0; a < snapshot.splitSearch.size(); a++) {
+    if (snapshot.splitSearch[a].calls == 0) continue;
+    json.beginObject();
+    json.field("attribute", a < ds.getTotAttributes() ? ds.getAttributeName(a) : std::to_string(a));
+    json.field("ns", snapshot.splitSearch[a].nanoseconds);
+    json.field("calls", snapshot.splitSearch[a].calls);
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+}
+
+
+void Trainer::saveCounters(DataSet& ds) {
+  std::string fileName = outputFolder_ + "counters.json";
+  std::ofstream ofs(fileName, std::ofstream::out);
+  if (!ofs.is_open()) {
+    Logger::log() << "Error: can't create " << fileName;
+    return;
+  }
+
+  JsonWriter json(ofs);
+  json.beginObject();
+  json.key("load");
+  writeCounters(json, loadCounters_, ds);
+  json.key("trees");
+  json.beginArray();
+  int64_t i = 0;
+  while (i < runStats_.size()) {
+    int64_t j = i;
+    WorkCounters::Snapshot total;
+    while (j < runStats_.size() && runStats_[j].treeName == runStats_[i].treeName) {
+      WorkCounters::accumulate(total, runStats_[j].counters);
+      j++;
+    }
+
+    json.beginObject();
+    json.field("name", runStats_[i].treeName);
+    json.key("counters");
+    writeCounters(json, total, ds);
+    json.key("folds");
+    json.beginArray();
+    for (int64_t k = i; k < j; k++) {
+      json.beginObject();
+      json.field("fold", runStats_[k].fold);
+      json.key("counters");
+      writeCounters(json, runStats_[k].counters, ds);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    i = j;
+  }
+  json.endArray();
+  json.endObject();
+  ofs.close();
+}
+
+
+void Trainer::writeCounters(JsonWriter& json, const WorkCounters::Snapshot& snapshot, DataSet& ds) {
+  json.beginObject();
+  for (int64_t c = 0; c < WorkCounters::TOT_COUNTERS; c++) {
+    json.field(WorkCounters::getCounterName((WorkCounters::Counter)c), snapshot.counters[c]);
+  }
+  int64_t classified = snapshot.counters[WorkCounters::SAMPLES_CLASSIFIED];
+  json.field("averagePathLength",
+             classified > 0 ? snapshot.counters[WorkCounters::PATH_LENGTH] / (double)classified : 0.0);
+  json.key("rowsScannedByAttribute");
+  json.beginArray();
+  for (int64_t a = 0; a < snapshot.rowsScanned.size(); a++) {
+    if (snapshot.rowsScanned[a] == 0) continue;
+    json.beginObject();
+    json.field("attribute", a < ds.getTotAttributes() ? ds.getAttributeName(a) : std::to_string(a));
+    json.field("rows", snapshot.rowsScanned[a]);
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+}
+
+
+void Trainer::saveHardwareCounters() {
+  std::string fileName = outputFolder_ + "hwcounters.json";
+  std::ofstream ofs(fileName, std::ofstream::out);
+  if (!ofs.is_open()) {
+    Logger::log() << "Error: can't create " << fileName;
+    return;
+  }
+
+  JsonWriter json(ofs);
+  json.beginObject();
+  json.field("available", HardwareCounters::isAvailable());
+  json.key("trees");
+  json.beginArray();
+  int64_t i = 0;
+  while (i < runStats_.size()) {
+    int64_t j = i;
+    HardwareCounters::Snapshot total;
+    while (j < runStats_.size() && runStats_[j].treeName == runStats_[i].treeName) {
+      HardwareCounters::accumulate(total, runStats_[j].hardware);
+      j++;
+    }
+
+    json.beginObject();
+    json.field("name", runStats_[i].treeName);
+    json.key("regions");
+    writeHardwareCounters(json, total);
+    json.key("folds");
+    json.beginArray();
+    for (int64_t k = i; k < j; k++) {
+      json.beginObject();
+      json.field("fold", runStats_[k].fold);
+      json.key("regions");
+      writeHardwareCounters(json, runStats_[k].hardware);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    i = j;
+  }
+  json.endArray();
+  json.endObject();
+  ofs.close();
+}
+
+
+void Trainer::writeHardwareCounters(JsonWriter& json, const HardwareCounters::Snapshot& snapshot) {
+  json.beginObject();
+  for (int64_t r = 0; r < HardwareCounters::TOT_REGIONS; r++) {
+    json.key(HardwareCounters::getRegionName((HardwareCounters::Region)r));
+    json.beginObject();
+    json.field("calls", snapshot.calls[r]);
+    for (int64_t e = 0; e < HardwareCounters::TOT_EVENTS; e++) {
+      json.field(HardwareCounters::getEventName((HardwareCounters::Event)e), snapshot.values[r][e]);
+    }
+    int64_t cycles = snapshot.values[r][HardwareCounters::CYCLES];
+    json.field("instructionsPerCycle",
+               cycles > 0 ? snapshot.values[r][HardwareCounters::INSTRUCTIONS] / (double)cycles : 0.0);
+    json.endObject();
+  }
+  json.endObject();
+}
+
+
+void Trainer::saveMemory(DataSet& ds) {
+  std::string fileName = outputFolder_ + "memory.json";
+  std::ofstream ofs(fileName, std::ofstream::out);
+  if (!ofs.is_open()) {
+    Logger::log() << "Error: can't create " << fileName;
+    return;
+  }
+
+  JsonWriter json(ofs);
+  json.beginObject();
+  json.field("unit", "bytes");
+  json.field("peakRSS", MemoryUsage::getPeakRSS());
+  json.key("dataSet");
+  json.beginObject();
+  json.field("trainSamples", trainSamplesBytes_);
+  json.field("testSamples", testSamplesBytes_);
+  int64_t totAttributes = 0;
+  json.key("attributes");
+  json.beginArray();
+  for (int64_t a = 0; a < ds.getTotAttributes(); a++) {
+    int64_t bytes = ds.getAttributeMemoryUsage(a);
+    totAttributes += bytes;
+    json.beginObject();
+    json.field("attribute", ds.getAttributeName(a));
+    json.field("size", ds.getAttributeSize(a));
+    json.field("bytes", bytes);
+    json.endObject();
+  }
+  json.endArray();
+  json.field("totalAttributes", totAttributes);
+  json.endObject();
+
+  json.key("trees");
+  json.beginArray();
+  int64_t i = 0;
+  while (i < runStats_.size()) {
+    int64_t j = i;
+    while (j < runStats_.size() && runStats_[j].treeName == runStats_[i].treeName) {
+      j++;
+    }
+
+    json.beginObject();
+    json.field("name", runStats_[i].treeName);
+    json.key("folds");
+    json.beginArray();
+    for (int64_t k = i; k < j; k++) {
+      json.beginObject();
+      json.field("fold", runStats_[k].fold);
+      json.field("treeNodes", runStats_[k].treeNodes);
+      json.field("treeBytes", runStats_[k].treeBytes);
+      json.field("treeUniqueNodes", runStats_[k].treeUniqueNodes);
+      json.key("peakTemporaries");
+      json.beginObject();
+      for (int64_t t = 0; t < MemoryUsage::TOT_TEMPORARIES; t++) {
+        json.field(MemoryUsage::getTemporaryName((MemoryUsage::Temporary)t), runStats_[k].temporaries.peak[t]);
+      }
+      json.endObject();
+      json.field("peakRSS", runStats_[k].peakRSS);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    i = j;
+  }
+  json.endArray();
+  json.endObject();
+  ofs.close();
+}
@@ -4,9 +4,15 @@
 #pragma once
 #include <string>
 
+#include "ColumnFile.h"
+#include "HardwareCounters.h"
+#include "JsonWriter.h"
+#include "MemoryUsage.h"
 #include "PairTree.h"
+#include "Profiler.h"
 #include "TrainReader.h"
 #include "Tester.h"
+#include "WorkCounters.h"
 
 class Trainer {
 public:
@@ -19,6 +25,25 @@ private:
     int64_t size;
     int64_t seconds;
     std::vector<std::vector<long double>> alphaXsamples;
+    // Full tree before any pruning
+    int64_t treeNodes;
+    int64_t treeBytes;
+    // Nodes of the saved model, with identical subtrees shared
+    int64_t treeUniqueNodes;
+  };
+
+  struct RunStats {
+    std::string treeName;
+    int fold;
+    int64_t nanoseconds;
+    Profiler::Snapshot timing;
+    WorkCounters::Snapshot counters;
+    HardwareCounters::Snapshot hardware;
+    MemoryUsage::Snapshot temporaries;
+    int64_t treeNodes;
+    int64_t treeBytes;
+    int64_t treeUniqueNodes;
+    int64_t peakRSS;
   };
 
   TreeResult execRandomSplit(std::shared_ptr<ConfigTrain> config,
@@ -31,10 +56,33 @@ private:
                 DataSet& currTest, std::string fileName,
                 int fold);
   void loadSplit(DataSet& originalDS, DataSet& current, std::string fileName);
+  std::shared_ptr<DecisionTreeNode> createTree(std::shared_ptr<ConfigTrain>& config, int treeInx,
+                                               DataSet& trainDS);
   TreeResult runTree(std::shared_ptr<ConfigTrain>& config, int treeInx,
-                     DataSet& trainDS, DataSet& testDS);
+                     DataSet& trainDS, DataSet& testDS, int fold);
   TreeResult runAlphaSamplesTrees(std::shared_ptr<ConfigTrain>& config, int treeInx,
-                               DataSet& trainDS, DataSet& testDS);
+                               DataSet& trainDS, DataSet& testDS, int fold);
+  std::string getModelFileName(std::shared_ptr<ConfigTrain>& config, int treeInx, int fold);
+  void saveCode(std::shared_ptr<ConfigTrain>& config, int treeInx, int fold,
+                std::shared_ptr<DecisionTreeNode> tree, DataSet& trainDS, DataSet& testDS);
+  std::vector<Tester::TestResults> streamTest(std::shared_ptr<ConfigTrain>& config,
+                                              const std::vector<std::shared_ptr<DecisionTreeNode>>& trees,
+                                              DataSet& trainDS);
+  void saveTiming(DataSet& ds);
+  void writePhases(JsonWriter& json, const Profiler::Snapshot& snapshot, DataSet& ds);
+  void saveCounters(DataSet& ds);
+  void writeCounters(JsonWriter& json, const WorkCounters::Snapshot& snapshot, DataSet& ds);
+  void saveHardwareCounters();
+  void saveMemory(DataSet& ds);
+  void writeHardwareCounters(JsonWriter& json, const HardwareCounters::Snapshot& snapshot);
 
   std::string outputFolder_;
+  Profiler::Snapshot loadTiming_;
+  WorkCounters::Snapshot loadCounters_;
+  int64_t trainSamplesBytes_;
+  int64_t testSamplesBytes_;
+  // Training rows when config->outOfCore, trainDS then only has the dictionaries
+  std::shared_ptr<ColumnFile> columns_;
+  // One per tree and fold, folds of the same tree are consecutive
+  std::vector<RunStats> runStats_;
 };
@@ -0,0 +1,61 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+
+#include "WorkCounters.h"
+
+#include "ThreadLocalStats.h"
+
+typedef ThreadLocalStats<WorkCounters::Snapshot, WorkCounters::accumulate> Stats;
+
+
+void WorkCounters::add(Counter counter, int64_t value) {
+  Stats::local().counters[counter] += value;
+}
+
+
+void WorkCounters::addRows(int64_t attribInx, int64_t rows) {
+  Snapshot& stats = Stats::local();
+  stats.counters[ROWS_SCANNED] += rows;
+  if (stats.rowsScanned.size() <= attribInx) {
+    stats.rowsScanned.resize(attribInx + 1, 0);
+  }
+  stats.rowsScanned[attribInx] += rows;
+}
+
+
+WorkCounters::Snapshot WorkCounters::snapshot() {
+  return Stats::merged();
+}
+
+
+void WorkCounters::reset() {
+  Stats::reset();
+}
+
+
+void WorkCounters::accumulate(Snapshot& to, const Snapshot& from) {
+  for (int64_t i = 0; i < from.counters.size(); i++) {
+    to.counters[i] += from.counters[i];
+  }
+  if (to.rowsScanned.size() < from.rowsScanned.size()) {
+    to.rowsScanned.resize(from.rowsScanned.size(), 0);
+  }
+  for (int64_t i = 0; i < from.rowsScanned.size(); i++) {
+    to.rowsScanned[i] += from.rowsScanned[i];
+  }
+}
+
+
+std::string WorkCounters::getCounterName(Counter counter) {
+  switch (counter) {
+  case ROWS_SCANNED: return "rowsScanned";
+  case SPLIT_CANDIDATES: return "splitCandidates";
+  case BOUND_EVALUATIONS: return "boundEvaluations";
+  case BIT_OPERATIONS: return "bitOperations";
+  case NODES_CREATED: return "nodesCreated";
+  case BYTES_ALLOCATED: return "bytesAllocated";
+  case SAMPLES_CLASSIFIED: return "samplesClassified";
+  case PATH_LENGTH: return "pathLength";
+  default: return "unknown";
+  }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2018 Daniel dos Santos Marques <danielsmarques7@gmail.com>
+// License: BSD 3 clause
+//
+// This module implements thread local counters of the algorithmic work done
+// while training and testing, so it can be compared against the timings.
+//
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WorkCounters {
+public:
+  enum Counter {
+    ROWS_SCANNED,
+    SPLIT_CANDIDATES,
+    BOUND_EVALUATIONS,
+    BIT_OPERATIONS,
+    NODES_CREATED,
+    // Estimate of the main allocations: samples lists, sort buffers, BITs and nodes
+    BYTES_ALLOCATED,
+    SAMPLES_CLASSIFIED,
+    // Nodes visited while classifying
+    PATH_LENGTH,
+    TOT_COUNTERS
+  };
+
+  struct Snapshot {
+    Snapshot() : counters(TOT_COUNTERS, 0) {}
+    std::vector<int64_t> counters;
+    // Rows scanned broken down by attribute index
+    std::vector<int64_t> rowsScanned;
+  };
+
+  static void add(Counter counter, int64_t value = 1);
+  // Also adds to ROWS_SCANNED
+  static void addRows(int64_t attribInx, int64_t rows);
+
+  static Snapshot snapshot();
+  static void reset();
+  static void accumulate(Snapshot& to, const Snapshot& from);
+
+  static std::string getCounterName(Counter counter);
+};
@@ -3,10 +3,27 @@
 
 name = "trainName"
 output = ""
+-- Besides summary.txt, every run saves timing.json, counters.json and memory.json
+-- Linux only: samples CPU counters around the hot kernels into hwcounters.json
+-- hardwareCounters = true
+-- Saves each tree as model_<tree>_fold<fold>.bin (src/ModelFormat.h), before pruning,
+-- for PairTreeScorer and PairTreeServer
+-- saveModel = true
+-- Saves each tree as C++ source, tree_<tree>_fold<fold>.cpp, plus a _check.cpp
+-- main that returns 1 if the generated code disagrees with the tree on the test samples
+-- generateCode = true
 
 dataset = {
 	filename = "..\\..\\..\\..\\datasets\\xor_example.csv",
-	classColStart = -1
+	classColStart = -1,
+	-- Merges rows with the same attribute values into weighted samples, needs a
+	-- trainingset or testset trainMode. Unless every tree is greedy or greedyBB,
+	-- only rows with the same costs are merged
+	collapseDuplicates = false,
+	-- Grows greedy and aodha trees level-wise, and streaming pair trees, over a
+	-- mapped column file instead of loading the file, needs a testset trainMode with stream = true.
+	-- Pair trees need streaming = true
+	outOfCore = false
 }
 
 trainMode = {
@@ -15,7 +32,11 @@ trainMode = {
 --[[
 trainMode = {
 	trainType = "testset",
-	filename = "bla.csv"
+	filename = "bla.csv",
+	-- Scores bla.csv in chunks of chunkRows rows with the training dictionaries
+	-- instead of loading it
+	stream = false,
+	chunkRows = 65536
 }
 trainMode = {
 	trainType = "randomsplit",
@@ -28,6 +49,18 @@ trees[0] = {
 	name = "greedyname",
 	treeType = "greedy",
   useNominalBinary = false,
+  -- Splits nominal attributes in two at the best cut of their values sorted by mean cost difference
+  useNominalOrdered = false,
+  -- Grows the tree a level at a time, streaming each attribute once per level (greedy and aodha)
+  levelWise = false,
+  -- Threads streaming the attributes of a level, or sweeping the rows of a node of at
+  -- least parallelRows samples, 0 uses every hardware thread (greedy, pair and aodha)
+  threads = 1,
+  parallelRows = 1000000,
+  -- Grows the best split first until the tree has maxLeaves leaves or maxSeconds
+  -- have passed, 0 for no limit. Can't be combined with levelWise
+  maxLeaves = 0,
+  maxSeconds = 0,
   minSamples = {},
   alphas = {},
   percentiles = 100,
@@ -43,8 +76,22 @@ trees[1] = {
 	treeType = "pair",
   useScore = false,
   useNominalBinary = false,
+  -- Splits nominal attributes in two at the best cut of their values sorted by mean cost difference
+  useNominalOrdered = false,
   boundOption = 'DIFF',
   maxBound = 1,
+  -- Grows the best split first until the tree has maxLeaves leaves or maxSeconds
+  -- have passed, 0 for no limit (greedy, pair and aodha)
+  maxLeaves = 0,
+  maxSeconds = 0,
+  -- Learns the tree in one pass, splitting a leaf every gracePeriod rows once its
+  -- bound is under maxBound, with statistics for at most valueBoxes value ranges per attribute
+  streaming = false,
+  gracePeriod = 200,
+  valueBoxes = 32,
+  -- Nodes of at least parallelRows samples sweep each ordered attribute on threads threads
+  threads = 1,
+  parallelRows = 1000000,
   alphas = {},
   minSamples = {},
   minLeaf = 50,